@@ -30,6 +30,10 @@
     X(AUTO_SPLIT, "auto split I") \
     /* the background color of the fensterchef windows */ \
     X(BACKGROUND, "background I") \
+    /* whether to show a bar at the top of each monitor */ \
+    X(BAR, "bar I") \
+    /* add a command whose output is shown in the bar */ \
+    X(BAR_COMMAND, "bar command S") \
     /* the border color of "active" windows */ \
     X(BORDER_COLOR_ACTIVE, "border color active I") \
     /* set the border color of the current window */ \
@@ -64,6 +68,12 @@
     X(CURSOR_VERTICAL, "cursor vertical S") \
     /* write all fensterchef information to a file */ \
     X(DUMP_LAYOUT, "dump layout S") \
+    /* write the lines within the log ring to a file */ \
+    X(DUMP_LOG, "dump log S") \
+    /* write statistics about the used memory to a file */ \
+    X(DUMP_MEMORY, "dump memory S") \
+    /* write the event, action and round-trip statistics to a file */ \
+    X(DUMP_STATISTICS, "dump statistics S") \
     /* remove all within a frame but not the frame itself */ \
     X(EMPTY, "empty") \
     /* equalize the size of the child frames within the current frame */ \
@@ -190,6 +200,8 @@
     X(SET_TILING, "set tiling") \
     /* show an error message */ \
     X(SHOW_ERROR, "show error S") \
+    /* show the interactive application launcher */ \
+    X(SHOW_LAUNCHER, "show launcher") \
     /* show the interactive window list */ \
     X(SHOW_LIST, "show list") \
     /* show a notification with a string message */ \
@@ -224,6 +236,8 @@
     X(TOGGLE_FULLSCREEN, "toggle fullscreen") \
     /* changes a non tiling window to a tiling window and vise versa */ \
     X(TOGGLE_TILING, "toggle tiling") \
+    /* start tracing or stop it and write the trace to a file */ \
+    X(TOGGLE_TRACE, "toggle trace S") \
 \
     /* Separator action.  The parser has special handling for the below actions.
      * The problem is that big backtracking would be required as all actions
@@ -38,6 +38,14 @@ typedef int_fast32_t action_integer_t;
 /* the maximum depth a group can be called */
 #define MAX_BLOCK_CALL_DEPTH 1024
 
+/* the maximum number of instructions a compiled block may grow to by inlining
+ * called groups
+ */
+#define MAX_INLINED_INSTRUCTIONS 64
+
+/* the maximum depth of groups within groups that are inlined */
+#define MAX_INLINE_DEPTH 8
+
 /* action codes */
 typedef enum {
 #define X(identifier, string) \
@@ -71,10 +79,17 @@ struct action_data {
     } u;
 };
 
+/* A block of actions compiled into a flat list of instructions, see
+ * `run_action_block()`.
+ */
+struct action_program;
+
 /* A block of actions. */
 struct action_block {
     /* the number of references to this block */
     unsigned reference_count;
+    /* the compiled form of the block, made when the block is first run */
+    struct action_program *program;
     /* all items within the block */
     struct action_block_item {
         /* the type of this actions */
@@ -122,7 +137,17 @@ void dereference_action_block(_Nullable ActionBlock *block);
 ActionBlock *create_empty_action_block(size_t number_of_items,
         size_t number_of_data_points);
 
-/* Do all actions within @block. */
+/* Do all actions within @block.
+ *
+ * The first time a block is run, it is compiled into a flat list of
+ * instructions.  Calls to groups are resolved to the group's actions and
+ * small groups are copied right into the list, up to
+ * `MAX_INLINED_INSTRUCTIONS` and `MAX_INLINE_DEPTH`.  When the groups change,
+ * the block is compiled again the next time it runs.
+ *
+ * Inlined calls are still recorded, counted and traced like any other call
+ * and count towards `MAX_BLOCK_CALL_DEPTH`.
+ */
 void run_action_block(ActionBlock *block);
 
 /* Do the given action using given @data. */
@@ -0,0 +1,72 @@
+#ifndef BAR_H
+#define BAR_H
+
+/**
+ * The bar is a window at the top of each monitor showing the numbers of the
+ * windows on that monitor, the title of the focused window, the output of
+ * configured commands and a clock.
+ *
+ * The space for the bar is reserved by adding its height to the strut of each
+ * monitor (see `reconfigure_monitor_frames()`).
+ *
+ * The bar is made of segments.  On every cycle of the event loop, the text of
+ * each segment is built again but only segments whose text or position changed
+ * are drawn again.  Nothing is sent to the X server when nothing changed.
+ *
+ * Commands run in the background and are never waited for.  Each line a
+ * command writes replaces its text in the bar.  A command that should update
+ * regularly can loop, for example:
+ *     bar command "while true ; do date +%S ; sleep 1 ; done"
+ */
+
+#include <sys/select.h>
+
+#include <X11/Xlib.h>
+
+/* Get the height of the bar.
+ *
+ * @return 0 if the bar is disabled.
+ */
+unsigned get_bar_height(void);
+
+/* Add a command whose output should be shown in the bar.
+ *
+ * If the same command is still running from before `clear_bar_commands()`, it
+ * is kept running.
+ */
+void add_bar_command(const char *command);
+
+/* Mark all bar commands as removed.
+ *
+ * The commands that are not added again are stopped on the next
+ * `update_bars()`.
+ */
+void clear_bar_commands(void);
+
+/* Add the file descriptors of the running bar commands to @set.
+ *
+ * @return the highest file descriptor or -1 if none were added.
+ */
+int set_bar_file_descriptors(fd_set *set);
+
+/* Read the output of all bar commands whose file descriptor is in @set. */
+void handle_bar_file_descriptors(const fd_set *set);
+
+/* Get the number of seconds until the clock of the bar changes.
+ *
+ * @return -1 if the bar is not shown.
+ */
+int get_bar_timeout(void);
+
+/* Handle an incoming X event for the bar windows. */
+void handle_bar_event(XEvent *event);
+
+/* Create, move or destroy the bar windows to match the monitors and draw the
+ * segments that changed.
+ */
+void update_bars(void);
+
+/* Destroy all bar windows and stop all bar commands. */
+void free_bars(void);
+
+#endif
@@ -88,17 +88,25 @@ void set_button_binding(const struct button_binding *button_binding);
 void run_button_binding(Time event_time, bool is_release,
         unsigned modifiers, button_t button);
 
-/* Unset all configured button bindings. */
-void unset_button_bindings(void);
-
 /* Set the specified key binding. */
 void set_key_binding(const struct key_binding *key_binding);
 
 /* Run the specified key binding. */
 void run_key_binding(bool is_release, unsigned modifiers, KeyCode key_code);
 
-/* Unset all configured key bindings. */
-void unset_key_bindings(void);
+/* Mark all bindings as stale.
+ *
+ * Bindings stay grabbed while they are stale.  Setting a binding again makes
+ * it no longer stale without grabbing it again.
+ */
+void mark_bindings_stale(void);
+
+/* Remove all bindings that are still stale.
+ *
+ * Only the stale bindings are ungrabbed.  If the ignored modifiers changed,
+ * all bindings are grabbed again.
+ */
+void remove_stale_bindings(void);
 
 /* Resolve all key symbols in case the mapping changed. */
 void resolve_all_key_symbols(void);
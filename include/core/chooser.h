@@ -0,0 +1,127 @@
+#ifndef CHOOSER_H
+#define CHOOSER_H
+
+/**
+ * The chooser is a window showing a list of items the user can choose from.
+ *
+ * Where the items come from and what happens when one is chosen is decided by
+ * a chooser source.  The window list and the application launcher are such
+ * sources.
+ *
+ * The user can navigate the items with the arrow keys or the home row keys.
+ * Pressing / starts a search that narrows down the items (see
+ * `utility/search.h`).  Each typed character only checks the items that
+ * matched before.
+ *
+ * Only the items visible on screen are rendered so the number of items has
+ * almost no influence on the rendering time.  When windows change, only the
+ * items of these windows are checked against the search again.  All items are
+ * only reloaded when a window needs a new item.
+ */
+
+#include <X11/X.h>
+
+#include "font.h"
+#include "utility/list.h"
+#include "utility/search.h"
+#include "x11/synchronize.h"
+
+/* A source of items for the chooser. */
+typedef struct chooser_source {
+    /* the name of the chooser window */
+    const char *name;
+    /* if the items should be reloaded when windows change */
+    bool is_window_dependent;
+    /* Add all items to the chooser using `add_chooser_item()`.
+     *
+     * @return the index of the item to select initially.
+     */
+    unsigned (*fill)(void);
+    /* Get the search key of the item with given @data. */
+    const SearchKey *(*get_key)(void *data);
+    /* Get the text shown for the item with given @data. */
+    int (*get_text)(void *data, utf8_t *buffer, size_t buffer_size);
+    /* Get the text shown when there are no items at all. */
+    int (*get_empty_text)(utf8_t *buffer, size_t buffer_size);
+    /* Called when the item with given @data is chosen.
+     *
+     * @shift is true when the shift key was held.
+     */
+    void (*choose)(void *data, bool shift);
+    /* Release the item with given @data, this may be NULL. */
+    void (*release)(void *data);
+    /* Get the window the item with given @data is for.
+     *
+     * This is only used when the source is window dependent.
+     *
+     * @return None if the item should no longer be shown.
+     */
+    Window (*get_item_window)(void *data);
+    /* Check if the window with @id should have an item.
+     *
+     * This is only used when the source is window dependent.
+     */
+    bool (*is_window_shown)(Window id);
+} ChooserSource;
+
+/* an item within the chooser */
+typedef struct chooser_item {
+    /* the source specific data */
+    void *data;
+    /* the length of the longest search prefix this item matches */
+    size_t matched_length;
+} ChooserItem;
+
+/* the chooser window */
+extern struct chooser {
+    /* the X correspondence */
+    XReference reference;
+    /* Xft drawing context */
+    XftDraw *xft_draw;
+    /* the source the items come from */
+    const ChooserSource *source;
+    /* all items of the source */
+    LIST(ChooserItem, items);
+    /* the indexes of all items matching the search */
+    LIST(unsigned, matches);
+    /* the currently selected index within `matches` */
+    unsigned selected;
+    /* the first visible index within `matches` */
+    unsigned top;
+    /* if the user is currently typing a search */
+    bool is_searching;
+    /* the lower case search the user typed */
+    LIST(utf8_t, search);
+    /* the windows that changed since the items were last updated */
+    LIST(Window, changed_windows);
+    /* if the chooser needs to be rendered again */
+    bool is_dirty;
+} Chooser;
+
+/* Add an item to the chooser.
+ *
+ * This may only be called within the `fill()` function of a source.
+ */
+void add_chooser_item(void *data);
+
+/* Handle an incoming X event for the chooser. */
+void handle_chooser_event(XEvent *event);
+
+/* Reload and render the chooser if anything changed.
+ *
+ * This is called after all events of a cycle were handled.
+ */
+void update_chooser(void);
+
+/* Show the chooser with items from @source.
+ *
+ * When the chooser already shows @source, it is hidden instead.
+ *
+ * @return ERROR if the chooser can not be shown, OK otherwise.
+ */
+int show_chooser(const ChooserSource *source);
+
+/* Hide the chooser and release all items. */
+void hide_chooser(void);
+
+#endif
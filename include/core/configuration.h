@@ -37,6 +37,9 @@ extern struct configuration {
     /* padding of text within the notification window */
     unsigned text_padding;
 
+    /* whether to show a bar at the top of each monitor */
+    bool bar;
+
     /* width of the border */
     unsigned border_size;
     /* color of the border around the window */
@@ -70,14 +73,35 @@ void set_default_configuration(void);
  */
 const char *get_configuration_file(void);
 
-/* Clear everything that is currently loaded in the configuration. */
-void clear_configuration(void);
+/* Mark everything that is currently loaded in the configuration as stale.
+ *
+ * Bindings and cursors stay in effect until `remove_stale_configuration()` is
+ * called.  Whatever is set again in between is kept as is, so a reload only
+ * grabs and ungrabs the bindings that actually changed.  Window relations hold
+ * no server resources and are cleared right away.
+ */
+void mark_configuration_stale(void);
+
+/* Remove everything from the configuration that is still stale. */
+void remove_stale_configuration(void);
 
 /* Reload the fensterchef configuration.
  *
  * This either loads the configuration or the default configuration if that
  * failed.
+ *
+ * The configuration file and all files it sources are watched afterwards.
+ * When one of them is written, the configuration is reloaded automatically.
  */
 void reload_configuration(void);
 
+/* Get the file descriptor reporting changes of the configuration files.
+ *
+ * @return -1 if there is no such file descriptor.
+ */
+int get_configuration_file_descriptor(void);
+
+/* Handle the changes reported by the configuration file descriptor. */
+void handle_configuration_changes(void);
+
 #endif
@@ -35,7 +35,15 @@ typedef enum cursor {
  */
 Cursor load_cursor(cursor_id_t cursor_id, _Nullable const char *name);
 
-/* Clear all cursors within the cursor cache. */
-void clear_cursor_cache(void);
+/* Mark all cursors as stale.
+ *
+ * Loading a cursor with the name it already has makes it no longer stale
+ * without loading it again.
+ */
+void mark_cursors_stale(void);
+
+/* Free all cursors that are still stale so that their default is used again.
+ */
+void remove_stale_cursors(void);
 
 #endif
@@ -17,13 +17,15 @@
 #include "bits/window.h"
 #include "x11/ewmh.h"
 
-/* Create a signal handler for `SIGALRM`. */
+/* Create a signal handler for `SIGALRM` and handlers for `SIGSEGV` and
+ * `SIGABRT` that write a crash report (see `write_crash_report()`).
+ */
 void initialize_signal_handlers(void);
 
 /* Runs the next cycle of the event loop. This handles signals and all events
  * that are currently queued.
  *
- * It also delegates events to the window list if it is mapped.
+ * It also delegates events to the chooser if it is mapped.
  */
 int next_cycle(void);
 
@@ -2,6 +2,7 @@
 #define FENSTERCHEF_H
 
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "utility/attributes.h"
 
@@ -20,18 +21,58 @@ extern _Nullable char *Fensterchef_configuration;
 /* true while the window manager is running */
 extern bool Fensterchef_is_running;
 
-/* Spawn a window that has the `FENSTERCHEF_COMMAND` property.
+/* Get the path of the file @name within the fensterchef cache directory.
+ *
+ * The cache directory is $XDG_CACHE_HOME/fensterchef or
+ * ~/.cache/fensterchef when $XDG_CACHE_HOME is not set.  The directory is
+ * created if it does not exist yet.
+ *
+ * @return NULL if the directory can not be created, otherwise an allocated
+ *         path.
+ */
+char *get_cache_file(const char *name);
+
+/* Send @command to the running fensterchef and wait until it ran.
+ *
+ * The command is sent over the socket of the running fensterchef (see
+ * `ipc.h`).  If there is no socket, a window that has the
+ * `FENSTERCHEF_COMMAND` property is spawned instead.
  *
  * This will exit the program.
  */
 void run_external_command(const char *command);
 
+/* Write the frames and windows into @file as textual output. */
+void write_frames_and_windows(FILE *file);
+
 /* Output the frames and windows into a file as textual output.
  *
  * @return ERROR if the file could not be opened, OK otherwise.
  */
 int dump_frames_and_windows(const char *file_path);
 
+/* Output the lines within the log ring into a file.
+ *
+ * @return ERROR if the file could not be opened, OK otherwise.
+ */
+int dump_log_ring(const char *file_path);
+
+/* Output statistics about the used memory into a file as textual output.
+ *
+ * This lists the heap usage, the allocations made by each source file and the
+ * window and frame pools.
+ *
+ * @return ERROR if the file could not be opened, OK otherwise.
+ */
+int dump_memory(const char *file_path);
+
+/* Output the event, action and round-trip statistics into a file as textual
+ * output.
+ *
+ * @return ERROR if the file could not be opened, OK otherwise.
+ */
+int dump_statistics(const char *file_path);
+
 /* Close the display to xcb and exit the program with given exit code. */
 void quit_fensterchef(int exit_code);
 
@@ -0,0 +1,56 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+/**
+ * The flight recorder remembers the last X events and actions in a fixed ring
+ * of memory.  Nothing is formatted while recording, events are copied as they
+ * are and formatted through the log functions only when written out.
+ *
+ * When fensterchef crashes (segmentation fault, abort or a lost connection to
+ * the X server), a crash report is written with the recorded events and
+ * actions, the call sites of the lines in the log ring if it is used and a
+ * snapshot of all frames and windows.  This gives data after the fact without
+ * needing verbose logging.
+ *
+ * The report is written from a signal handler where the process might be in
+ * any state, for example within `malloc()` or holding the lock of a stream.
+ * Therefore only async-signal-safe functions are used: the file is opened
+ * ahead of time, the output is formatted by hand and written with `write()`.
+ * Events are written with their type and window only as formatting them fully
+ * could need requests to the X server.
+ */
+
+#include <X11/Xlib.h>
+
+#include "action.h"
+
+/* the number of events and actions the flight recorder remembers */
+#define FLIGHT_RECORDER_SIZE 256
+
+/* Remember that @event was received. */
+void record_event(const XEvent *event);
+
+/* Remember that the action @type was done with @data. */
+void record_action(action_type_t type, const struct action_data *data);
+
+/* Write all recorded events and actions into @file_descriptor, oldest
+ * first.
+ */
+void write_flight_recorder(int file_descriptor);
+
+/* Open the file the crash report goes into.
+ *
+ * The file is next to the log file with the ending `.crash` instead of `.log`.
+ * If there is no log file, the report is written to standard error output.
+ * The file is removed again when exiting without a crash.
+ */
+void prepare_crash_report(void);
+
+/* Write a crash report for given @reason.
+ *
+ * This is safe to call within a signal handler.  It is only done once,
+ * further calls do nothing.
+ */
+void write_crash_report(const char *reason);
+
+#endif
@@ -8,9 +8,6 @@
 /* the default font */
 #define DEFAULT_FONT "monospace"
 
-/* the maximum number of glyphs */
-#define MAX_GLYPH_COUNT 1024
-
 /* a glyph sequence */
 struct text_item {
     /* the font to use for rendering this item */
@@ -50,16 +47,40 @@ void free_xft_color(XftColor *color);
 /* Free the resources the font list occupies. */
 void free_font_list(void);
 
-/* Set the global font using given fontconfig pattern string. */
+/* Set the global font using given fontconfig pattern string.
+ *
+ * This only loads the primary font.  The fallback fonts for glyphs the font
+ * does not have are only looked up once such a glyph is encountered.  They are
+ * kept in the cache file $XDG_CACHE_HOME/fensterchef/fonts until the font
+ * configuration changes.
+ *
+ * Setting the same font again keeps the loaded fonts.
+ *
+ * @return ERROR if the font can not be loaded, the previous font is kept then.
+ */
 int set_font(const char *name);
 
+/* Go back to the default font.
+ *
+ * Unlike `set_font()`, this does not load the font right away but when text is
+ * created next.  That way the font is not loaded twice when the configuration
+ * is reloaded and sets the same font again.
+ */
+void reset_font(void);
+
+/* Get the primary font, this is the font set by `set_font()`.
+ *
+ * @return NULL if the font could not be loaded.
+ */
+XftFont *get_primary_font(void);
+
 /* Convert given @utf8 string with @length to a glyph array.
  *
  * @length may be -1, then the function uses strlen() on @utf8.
  *
  * @return a pointer to the first glyph.
  *         Do NOT free this pointer.
- *         It is limited to `MAX_GLYPH_COUNT` glyphs.
+ *         It is only valid until the next call.
  */
 FcChar32 *get_glyphs(const utf8_t *utf8, int length, int *glyph_count);
 
@@ -17,6 +17,7 @@
 #include "bits/frame.h"
 #include "bits/window.h"
 #include "utility/attributes.h"
+#include "utility/pool.h"
 #include "utility/types.h"
 
 /* The minimum resize width or height of a frame.  Frames are never clipped to
@@ -92,6 +93,11 @@ extern Frame *Frame_last_stashed;
 /* the currently selected/focused frame */
 extern Frame *Frame_focus;
 
+/* The pool all frames are allocated from.  Frames stay within it until their
+ * last reference is gone, not just until they are destroyed.
+ */
+extern ObjectPool Frame_pool;
+
 /* Increment the reference count of the frame. */
 void reference_frame(Frame *frame);
 
@@ -0,0 +1,79 @@
+#ifndef IPC_H
+#define IPC_H
+
+/**
+ * Fensterchef listens on a Unix domain socket for commands from other
+ * programs, for example `fensterchef -e`.  The socket is at
+ *     $XDG_RUNTIME_DIR/fensterchef-DISPLAY.socket
+ * or at `/tmp/fensterchef-UID-DISPLAY.socket` if `XDG_RUNTIME_DIR` is not set.
+ *
+ * Each command is in the syntax of the configuration and terminated by a null
+ * byte, so it may span many lines.  For each command, in the order they were
+ * sent, a line with `ok` or `error` is written back.  Replies still waiting
+ * when fensterchef quits are written out before the connection is closed.
+ *
+ * Connections stay open so a script can send many commands without waiting
+ * for each reply:
+ *     printf 'focus left\0focus right\0' | socat - UNIX-CONNECT:$socket
+ *
+ * The server is part of the main loop, commands are run between X events.
+ */
+
+#include <stdbool.h>
+#include <sys/select.h>
+
+#include "utility/attributes.h"
+
+/* the maximum length of a single command */
+#define IPC_MAXIMUM_COMMAND_LENGTH (64 << 10)
+
+/* no more commands are read from a client while this many reply bytes are
+ * waiting to be written to it
+ */
+#define IPC_MAXIMUM_REPLY_LENGTH (1 << 20)
+
+/* the seconds to wait for the reply to a sent command */
+#define IPC_REPLY_TIMEOUT 10
+
+/* the seconds to try writing the waiting replies when stopping the server */
+#define IPC_FLUSH_TIMEOUT 1
+
+/* Get the path of the socket for the current display.
+ *
+ * @return the allocated path or NULL if it is too long for a socket.
+ */
+char *get_ipc_socket_path(void);
+
+/* Create the socket and start listening.
+ *
+ * A socket left by a fensterchef that did not quit properly is replaced.
+ *
+ * @return ERROR if the socket could not be created.
+ */
+int start_ipc_server(void);
+
+/* Close all connections and remove the socket. */
+void stop_ipc_server(void);
+
+/* Add the file descriptors of the server and its connections to @read_set and
+ * @write_set.
+ *
+ * @return the highest file descriptor or -1 if none were added.
+ */
+int set_ipc_file_descriptors(fd_set *read_set, fd_set *write_set);
+
+/* Accept connections, run the received commands and write the replies for
+ * all file descriptors in @read_set and @write_set.
+ */
+void handle_ipc_file_descriptors(const fd_set *read_set,
+        const fd_set *write_set);
+
+/* Send @command to the running fensterchef and wait for the reply.
+ *
+ * @return ERROR if there is no running fensterchef to connect to, otherwise
+ *         OK.  @is_success is set to true if the command succeeded, it is
+ *         false if no reply came within `IPC_REPLY_TIMEOUT` seconds.
+ */
+int send_ipc_command(const char *command, _Out bool *is_success);
+
+#endif
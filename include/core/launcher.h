@@ -0,0 +1,37 @@
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+/**
+ * The application launcher is a chooser source (see `chooser.h`) listing all
+ * executables within the directories of $PATH and all applications described
+ * by .desktop files within the applications directories of $XDG_DATA_HOME and
+ * $XDG_DATA_DIRS.
+ *
+ * The applications are kept in memory and stored in the cache file
+ * $XDG_CACHE_HOME/fensterchef/applications.  When the launcher is opened for
+ * the first time, only the directories that were modified since the cache was
+ * written are scanned.
+ *
+ * Afterwards, inotify reports single files that changed and only these are
+ * looked at again.  While the launcher is shown, the changes are postponed
+ * until it is opened the next time.
+ */
+
+/* Get the file descriptor reporting changes of the application directories.
+ *
+ * @return -1 if there is no such file descriptor.
+ */
+int get_launcher_file_descriptor(void);
+
+/* Handle the changes reported by the launcher file descriptor. */
+void handle_launcher_changes(void);
+
+/* Show the application launcher on screen or hide it if it is already shown.
+ *
+ * The user can now select an application and it will be run.
+ *
+ * @return ERROR if the launcher can not be shown, OK otherwise.
+ */
+int show_launcher(void);
+
+#endif
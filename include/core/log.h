@@ -2,6 +2,7 @@
 #define LOG_H
 
 #include <stdio.h>
+#include <time.h>
 
 #include "utility/utility.h"
 
@@ -84,6 +85,12 @@ void _log_formatted(log_severity_t severity, const char *format, ...);
     _log_formatted(LOG_SEVERITY_ERROR, __VA_ARGS__)
 #endif
 
+/* Get the name of the X event @type.
+ *
+ * @return NULL if the type is not a core event.
+ */
+const char *event_to_string(int type);
+
 /* Print a formatted string to standard error output.
  *
  * The following format specifiers are supported on top of the regular
@@ -104,4 +111,35 @@ void _log_formatted(log_severity_t severity, const char *format, ...);
  */
 void log_formatted(const char *format, ...);
 
+/* Like `log_formatted()` but always format right away and into @file.
+ *
+ * This ignores the log ring and the log severity.
+ */
+void write_formatted(FILE *file, const char *format, ...);
+
+/* Keep log lines in an in-memory ring of @size bytes instead of writing them
+ * to the log file.
+ *
+ * Each line is stored as raw record: the time, the format string which tells
+ * the call site and the arguments.  Strings are copied up to 255 bytes.
+ * Formatting only happens when the ring is written with `write_log_ring()`.
+ * Once the ring is full, the oldest lines are overwritten.
+ *
+ * Errors are still written to the log file right away as well.
+ */
+void start_log_ring(size_t size);
+
+/* Check if log lines are kept in the log ring. */
+bool is_log_ring_used(void);
+
+/* Format all lines within the log ring into @file, oldest first. */
+void write_log_ring(FILE *file);
+
+/* Call @callback with the time and format of all lines within the log ring,
+ * oldest first.
+ *
+ * Nothing is formatted so this is safe to use within a signal handler.
+ */
+void walk_log_ring(void (*callback)(time_t time, const char *format));
+
 #endif
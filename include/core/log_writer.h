@@ -0,0 +1,62 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+/**
+ * The log writer moves writing the log file off the event loop.  Everything
+ * written to its stream is copied into a queue and a background thread takes
+ * it from there and writes it to the disk.  A slow disk (or a home directory
+ * on a hanging network file system) then stalls only the writer and never the
+ * window management.
+ *
+ * The queue is a ring of bytes with a single producer (the event loop) and a
+ * single consumer (the writer thread).  Both only ever move their own position
+ * forward so no lock is needed.  When the queue is full, the output is dropped
+ * instead of waiting and the writer notes how much was dropped.
+ *
+ * Log files are named after the time they were started:
+ *     $XDG_STATE_HOME/fensterchef/2025-01-31_12:00:00.log
+ * When a file grows beyond its maximum size, the writer continues in a new
+ * file.  Only the newest files are kept, older ones are removed.
+ */
+
+#include <stdio.h>
+
+#include "utility/attributes.h"
+
+/* the maximum size of a log file before the writer continues in a new one */
+#define LOG_FILE_MAXIMUM_SIZE (4 << 20)
+
+/* the number of log files kept within the log directory */
+#define LOG_FILE_RETENTION 8
+
+/* the size of the queue between the event loop and the writer thread */
+#define LOG_QUEUE_SIZE (256 << 10)
+
+/* Open the first log file in @directory and start the writer thread.
+ *
+ * @maximum_size is the size after which a new log file is started.
+ * @retention is the number of log files to keep in @directory.
+ * @path is set to the path of the first log file, it must be freed.
+ *
+ * There can only be one log writer at a time.  Closing the returned stream
+ * with `fclose()` writes out all queued output and stops the thread.
+ *
+ * @return NULL if the log file could not be opened.
+ */
+FILE *open_log_writer(const char *directory, size_t maximum_size,
+        unsigned retention, _Out char **path);
+
+/* Wait until the writer thread wrote out everything queued.
+ *
+ * This is for when the process is about to die (for example after a crash)
+ * and the queued output would be lost otherwise.  Only the writer thread
+ * touches the log file, this wakes it up and waits for it.  The wait is
+ * bounded to a second in case the writer thread is stuck or was the one that
+ * crashed.  The buffer of the stream is not flushed, only complete lines are
+ * guaranteed to be queued.
+ *
+ * This is safe to call within a signal handler.
+ */
+void flush_log_writer(void);
+
+#endif
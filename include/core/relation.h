@@ -4,6 +4,16 @@
 /**
  * Relations are actions that run when a window class/instance matches the
  * relation.
+ *
+ * To not match every relation against every new window, relations are kept in
+ * an index.  Literal patterns are looked up in a hash table and patterns that
+ * are a literal followed by '*' in a trie of prefixes.  Only relations where
+ * both patterns have no literal part are matched against every window.  The
+ * relations that may match run in the order they were set.
+ *
+ * The matching relations of each instance and class pair are remembered until
+ * the relations change, so another window of the same kind only needs a single
+ * hash lookup.
  */
 
 #include "bits/action_block.h"
@@ -11,6 +21,11 @@
 #include "utility/attributes.h"
 #include "utility/types.h"
 
+/* the maximum number of instance and class pairs whose matching relations are
+ * remembered
+ */
+#define MAX_RELATION_MEMO_SIZE 512
+
 /* relation between class/instance and actions */
 struct window_relation {
     /* the pattern the instance should match */
@@ -0,0 +1,74 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+/**
+ * Statistics count how often each X event type is handled and each action type
+ * is run along with a histogram of how long it took.  They also count the
+ * requests that block until the X server replied (round-trips) in total and
+ * per cycle of the event loop.
+ *
+ * The histograms have power of two buckets: the first bucket holds everything
+ * below 1 microsecond, the next below 2, then below 4 and so on.
+ *
+ * Everything is always counted, it costs two clock reads per event or action.
+ * The statistics are written with the `dump statistics` action.  A change that
+ * adds round-trips to a hot path shows up as a higher count per cycle.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "action.h"
+
+/* the number of buckets in a latency histogram */
+#define LATENCY_BUCKETS 24
+
+/* the kinds of requests that block until the X server replied */
+typedef enum round_trip {
+    /* `XGetWindowProperty()` and the functions reading a single property */
+    ROUND_TRIP_GET_WINDOW_PROPERTY,
+    /* `XGetWindowAttributes()` */
+    ROUND_TRIP_GET_WINDOW_ATTRIBUTES,
+    /* `XGetGeometry()` */
+    ROUND_TRIP_GET_GEOMETRY,
+    /* `XQueryPointer()` */
+    ROUND_TRIP_QUERY_POINTER,
+    /* `XQueryTree()` */
+    ROUND_TRIP_QUERY_TREE,
+    /* `XSync()` */
+    ROUND_TRIP_SYNC,
+    /* the number of round-trip kinds */
+    ROUND_TRIP_MAX
+} round_trip_t;
+
+/* a histogram of latencies */
+struct latency_histogram {
+    /* the number of measured calls */
+    size_t count;
+    /* the total and maximum time in nanoseconds */
+    uint64_t total, maximum;
+    /* the number of calls within each bucket */
+    size_t buckets[LATENCY_BUCKETS];
+};
+
+/* Get the current time in nanoseconds to measure a latency. */
+uint64_t get_statistics_time(void);
+
+/* Count the handling of an event of @type that started at @start. */
+void count_event(int type, uint64_t start);
+
+/* Count running an action of @type that started at @start. */
+void count_action(action_type_t type, uint64_t start);
+
+/* Count a request of kind @round_trip that waits for a reply. */
+void count_round_trip(round_trip_t round_trip);
+
+/* End the current cycle of the event loop, this counts the round-trips per
+ * cycle.
+ */
+void end_statistics_cycle(void);
+
+/* Write all statistics into @file. */
+void write_statistics(FILE *file);
+
+#endif
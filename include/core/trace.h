@@ -0,0 +1,48 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * Tracing measures where the time goes within the event loop.  While tracing,
+ * spans around event handling, synchronization with the X server, actions,
+ * parsing and text rendering are recorded in memory.  A span is only a name and
+ * two time stamps so recording it costs next to nothing.
+ *
+ * When tracing is stopped, all spans are written in the Chrome trace JSON
+ * format.  The file can be loaded into `chrome://tracing` or
+ * `https://ui.perfetto.dev` to see which handler is slow.
+ *
+ * Tracing is toggled by the `toggle trace` action.
+ */
+
+#include <stdbool.h>
+
+/* the maximum number of spans recorded, further spans are dropped */
+#define TRACE_MAXIMUM_SPANS (1 << 18)
+
+/* the maximum nesting of spans */
+#define TRACE_MAXIMUM_DEPTH 32
+
+/* Check if spans are recorded. */
+bool is_tracing(void);
+
+/* Start recording spans. */
+void start_trace(void);
+
+/* Stop recording spans and write them in the Chrome trace JSON format to the
+ * file at @path.
+ *
+ * @return ERROR if the file could not be written.
+ */
+int stop_trace(const char *path);
+
+/* Begin a span within the current span.
+ *
+ * @category and @name must be static strings, they are only written out when
+ *           tracing stops.
+ */
+void begin_trace_span(const char *category, const char *name);
+
+/* End the span last begun. */
+void end_trace_span(void);
+
+#endif
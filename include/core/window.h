@@ -19,6 +19,8 @@
 #include "monitor.h"
 #include "utility/attributes.h"
 #include "utility/linked_list.h"
+#include "utility/pool.h"
+#include "utility/search.h"
 #include "x11/ewmh.h"
 #include "x11/synchronize.h"
 
@@ -59,8 +61,12 @@ typedef struct window_properties {
     /* window name */
     utf8_t *name;
 
-    /* window instance (resource name), class (resource class) */
-    XClassHint class;
+    /* window instance (resource name) and class (resource class), both are
+     * interned (see `intern_string()`) so windows of the same kind share them
+     * and they can be compared by pointer
+     */
+    const utf8_t *instance;
+    const utf8_t *class;
 
     /* X size hints of the window */
     XSizeHints size_hints;
@@ -125,6 +131,9 @@ struct fensterchef_window {
     /* the window state */
     WindowState state;
 
+    /* the name, instance and class for searching */
+    SearchKey search;
+
     /* current window position and size */
     int x;
     int y;
@@ -198,6 +207,11 @@ extern FcWindow *Window_pressed;
 /* the selected window used for actions */
 extern FcWindow *Window_selected;
 
+/* The pool all windows are allocated from.  Windows stay within it until
+ * their last reference is gone, not just until they are destroyed.
+ */
+extern ObjectPool Window_pool;
+
 /* Add window states to the window's properties. */
 void add_window_states(FcWindow *window, Atom *states,
         unsigned number_of_states);
@@ -1,25 +1,10 @@
 #ifndef WINDOW_LIST_H
 #define WINDOW_LIST_H
 
-#include <X11/X.h>
-
-#include "font.h"
-#include "x11/synchronize.h"
-
-/* user window list window */
-extern struct window_list {
-    /* the X correspondence */
-    XReference reference;
-    /* Xft drawing context */
-    XftDraw *xft_draw;
-    /* the currently selected window index */
-    unsigned selected;
-    /* the currently scrolled amount in pixels */
-    int scrolling;
-} WindowList;
-
-/* Handle an incoming X event for the window list. */
-void handle_window_list_event(XEvent *event);
+/**
+ * The window list is a chooser source (see `chooser.h`) listing all windows
+ * that can be focused.
+ */
 
 /* Show the window list on screen or hide if it is already shown.
  *
@@ -16,6 +16,9 @@
 
 /* A list of actions with explicit count and capacity.  It also includes
  * additional parsing information.
+ *
+ * All lists live in the arena of the parser.  The data within `items` and
+ * `data` is allocated normally as it moves into the final `ActionBlock`.
  */
 struct parse_action_block {
     /* the number of open round brackets '(' */
@@ -58,10 +61,16 @@ int continue_parsing_actions_in_brackets(Parser *parser,
  */
 int continue_parsing_actions(Parser *parser, struct parse_action_block *block);
 
-/* Clear all memory within @block. */
+/* Clear the data within @block.
+ *
+ * The lists themselves are freed along with the parser.
+ */
 void clear_parse_action_block(struct parse_action_block *block);
 
-/* Make a real action list from a parser action list. */
+/* Make a real action list from a parser action list.
+ *
+ * The data of @block is moved into the returned block.
+ */
 ActionBlock *convert_parse_action_block(struct parse_action_block *block);
 
 #endif
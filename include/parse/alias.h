@@ -15,8 +15,30 @@
 
 #include "parse/parse.h"
 
-/* must be a power of two */
-#define PARSE_MAX_ALIASES 1024
+/* Set the alias @name to @value.
+ *
+ * Both strings are duplicated.
+ */
+void set_alias(const char *name, const char *value);
+
+/* Get the number of aliases. */
+unsigned get_alias_count(void);
+
+/* Get the alias at @index within the alias table.
+ *
+ * This is used to go through all aliases with @index going from 0 to
+ * `get_alias_count()` (exclusive).  The aliases are in the order they were
+ * created.
+ *
+ * @return the alias name.
+ */
+const char *get_alias_at(unsigned index, _Out const char **value);
+
+/* Get a hash of all aliases and their values.
+ *
+ * Parsing depends on the aliases, the hash tells if they are still the same.
+ */
+uint64_t get_alias_hash(void);
 
 /* Parse all after the `alias` keyword. */
 void continue_parsing_alias(Parser *parser);
@@ -24,12 +46,14 @@ void continue_parsing_alias(Parser *parser);
 /* Parse all after the `unalias` keyword. */
 void continue_parsing_unalias(Parser *parser);
 
-/* Check if given string is within the alias table.
+/* Check if given string of @length bytes is within the alias table.
+ *
+ * @string does not need to be null-terminated.
  *
  * @return NULL if the alias does not exist, otherwise a null-terminated string
  *              with the value of the alias.
  */
-const char *resolve_alias(const char *string);
+const char *resolve_alias(const char *string, size_t length);
 
 /* Clear all aliases the parser set. */
 void clear_all_aliases(void);
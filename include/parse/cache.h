@@ -0,0 +1,52 @@
+#ifndef PARSE__CACHE_H
+#define PARSE__CACHE_H
+
+/**
+ * The configuration cache holds the parsed configuration in a binary form so
+ * that an unchanged configuration does not need to be parsed again.
+ *
+ * It is stored in $XDG_CACHE_HOME/fensterchef/configuration and contains:
+ * - the path, modification time, size and content hash of the configuration
+ *   file and all files it sourced
+ * - all aliases and groups set while parsing
+ * - the parsed actions including bindings and relations
+ *
+ * The cache is only used when all files are unchanged.  A file whose
+ * modification time differs is read and hashed to check if its content really
+ * changed.
+ *
+ * The cache is rejected if it was written by a fensterchef with different
+ * actions or if its content does not match the hash stored along with it.
+ * Every action type and data type is checked again while loading.
+ */
+
+#include "bits/action_block.h"
+#include "parse/parse.h"
+#include "utility/attributes.h"
+
+/* Load the cached configuration for the configuration file at @path.
+ *
+ * The aliases and groups of the cache are set.
+ *
+ * @files is set to the configuration file followed by all files it sourced,
+ *        free them with `free_parse_files()`.
+ *
+ * @return NULL if there is no valid cache for @path, otherwise the actions to
+ *         run.
+ */
+ActionBlock *load_configuration_cache(const char *path,
+        _Out struct parse_file **files, _Out size_t *number_of_files);
+
+/* Write the configuration cache.
+ *
+ * @parser is the parser that parsed the configuration, it knows all files that
+ *         were read.
+ * @actions are the parsed actions.
+ *
+ * The current aliases and groups are written along with it so this must be
+ * called right after parsing.
+ */
+void save_configuration_cache(const Parser *parser,
+        const ActionBlock *actions);
+
+#endif
@@ -9,27 +9,43 @@
 #include "parse/action.h"
 #include "parse/parse.h"
 
-/* must be a power of two */
-#define PARSE_MAX_GROUPS 1024
+/* Find the group by given name.
+ *
+ * @return NULL if the group does not exist, otherwise the actions of the group.
+ */
+ActionBlock *find_group(const char *name);
+
+/* Set the group @name to @actions.
+ *
+ * The reference to @actions is taken over by the group.
+ */
+void set_group(const char *name, ActionBlock *actions);
 
-/* a parsed group */
-struct parse_group {
-    /* name of the group */
-    char *name;
-    /* the actions within the group */
-    ActionBlock *actions;
-};
+/* Get the number of times the groups changed.
+ *
+ * This counts every time a group is set and every time all groups are cleared.
+ * It is used to check if parsing a file set any group and if compiled action
+ * blocks are still up to date.
+ */
+unsigned get_group_change_count(void);
 
-/* Find the group by given name. */
-struct parse_group *find_group(const char *name);
+/* Get the number of groups. */
+unsigned get_group_count(void);
 
-/* Run a list of actions to undo all within the group.
+/* Get the group at @index within the group table.
+ *
+ * This is used to go through all groups with @index going from 0 to
+ * `get_group_count()` (exclusive).  The groups are in the order they were
+ * created.
  *
- * This includes:
- * - bindings
- * - relations
+ * @return the group name.
+ */
+const char *get_group_at(unsigned index, _Out ActionBlock **actions);
+
+/* Run a list of actions to undo all bindings and relations within the group
+ * with given @actions.
  */
-void undo_group(const struct parse_group *group);
+void undo_group(const ActionBlock *actions);
 
 /* Clear all groups the parser set. */
 void clear_all_groups(void);
@@ -27,8 +27,10 @@ int get_stream_character(Parser *parser);
 int peek_stream_character(Parser *parser);
 
 /**
- * NOTE: The below functions are not efficient and should only be used for error
- * output.
+ * The functions below use an index of all line starts that is built on their
+ * first use.  A position is then found with a binary search over the lines.
+ * Only columns in lines with tabs or non ascii characters need to go over the
+ * line.
  */
 
 /* Get the column and line of @index within @parser.
@@ -36,14 +38,16 @@ int peek_stream_character(Parser *parser);
  * If @index is out of bounds, @line and @column are set to the last position in
  * the parser.
  */
-void get_stream_position(const Parser *parser, size_t index,
-        unsigned *line, unsigned *column);
+void get_stream_position(Parser *parser, size_t index,
+        _Out unsigned *line, _Out unsigned *column);
 
 /* Get the line within @parser.
  *
- * @length will hold the length of the line.
+ * If @line is out of bounds, the last line is returned.
+ *
+ * @length will hold the length of the line without its line end.
  */
-const char *get_stream_line(const Parser *parser, unsigned line,
-        unsigned *length);
+const char *get_stream_line(Parser *parser, unsigned line,
+        _Out unsigned *length);
 
 #endif
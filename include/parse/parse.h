@@ -1,6 +1,8 @@
 #ifndef PARSE__PARSE_H
 #define PARSE__PARSE_H
 
+#include "bits/action_block.h"
+#include "utility/arena.h"
 #include "utility/attributes.h"
 #include "utility/list.h"
 #include "utility/types.h"
@@ -18,6 +20,28 @@
  */
 #define PARSE_MAX_ERROR_COUNT 30
 
+/* a file that was read by the parser */
+struct parse_file {
+    /* the path of the file */
+    utf8_t *path;
+    /* the time the file was last modified */
+    long long modification_time;
+    /* the size of the file in bytes */
+    size_t size;
+    /* a hash of the file content */
+    uint64_t hash;
+};
+
+/* a line within the input of a parser */
+struct parse_line {
+    /* the index of the first character of the line */
+    size_t start;
+    /* if the line only has printable ascii characters, then the column of an
+     * index is simply its distance to `start`
+     */
+    bool is_plain;
+};
+
 /* the parser object */
 typedef struct parser {
     /* the upper parser in the parsing process */
@@ -34,18 +58,38 @@ typedef struct parser {
 
     /* the path of the file, this is `NULL` if the source is a string */
     utf8_t *file_path;
-
-    /* last read string (word or quoted string) */
-    LIST(utf8_t, string);
+    /* the file of this parser followed by all files it sourced */
+    LIST(struct parse_file, files);
+
+    /* last read string (word or quoted string), this is NOT null-terminated
+     * and points into `input`, into `string_buffer` or to an alias value
+     */
+    const utf8_t *string;
+    /* the length of `string` */
+    size_t string_length;
     /* if this string has quotes */
     bool is_string_quoted;
+    /* storage for strings that can not be pointed to within `input` because
+     * escape sequences or joined lines make them differ from the input
+     */
+    LIST(utf8_t, string_buffer);
 
     /* the current index within the input stream */
     size_t index;
     /* the length of the the input stream */
     size_t length;
     /* the text input stream */
-    utf8_t input[];
+    const utf8_t *input;
+    /* all lines of the input, this is built on the first request of a
+     * position and lives in `arena`
+     */
+    LIST(struct parse_line, lines);
+
+    /* memory for state that is only needed while parsing, like the lists of
+     * `struct parse_action_block`, it is freed all at once by
+     * `destroy_parser()`
+     */
+    Arena arena;
 } Parser;
 
 /* Emit a parse error. */
@@ -63,6 +107,20 @@ Parser *create_file_parser(const utf8_t *path);
  */
 Parser *create_string_parser(const utf8_t *string);
 
+/* Check if the file recorded in @file is unchanged.
+ *
+ * @since is the time the record was made.  A file modified in that same second
+ *        might have changed without its modification time changing.
+ *
+ * When the modification time is not enough to tell, the file is read and its
+ * hash compared.
+ */
+bool is_parse_file_unchanged(const struct parse_file *file, long long since);
+
+/* Free the paths of @number_of_files files and @files itself. */
+void free_parse_files(_Nullable struct parse_file *files,
+        size_t number_of_files);
+
 /* Destroy a previously allocated input parse object. */
 void destroy_parser(_Nullable Parser *parser);
 
@@ -74,6 +132,15 @@ void destroy_parser(_Nullable Parser *parser);
  */
 int test_parser(Parser *parser);
 
+/* Parse using given parser object.
+ *
+ * @return NULL if a parsing error occured, otherwise the parsed actions.
+ */
+ActionBlock *parse_actions(Parser *parser);
+
+/* Run actions that were parsed by `parse_actions()`. */
+void run_parsed_actions(ActionBlock *actions);
+
 /* Parse using given parser object and rull all actions within it.
  *
  * @return ERROR if a parsing error occured, OK otherwise.
@@ -40,4 +40,26 @@ int read_string(Parser *parser);
 /* Read a string/word but do not resolve as an alias. */
 int read_string_no_alias(Parser *parser);
 
+/* Check if the last read string is equal to @string. */
+bool is_string_equal(const Parser *parser, const char *string);
+
+/* Duplicate the last read string into a null-terminated string.
+ *
+ * The string read by the parser is only valid until the next string is read
+ * and it is not null-terminated.  Use this for strings that need to outlive
+ * the parser.
+ *
+ * @return the allocated string.
+ */
+char *duplicate_string(const Parser *parser);
+
+/* Duplicate the last read string into the arena of @parser.
+ *
+ * Use this for strings that are only needed while parsing, they are freed
+ * along with the parser.
+ *
+ * @return the null-terminated string.
+ */
+char *duplicate_temporary_string(Parser *parser);
+
 #endif
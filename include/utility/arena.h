@@ -0,0 +1,113 @@
+#ifndef UTILITY__ARENA_H
+#define UTILITY__ARENA_H
+
+/**
+ * An arena hands out memory by bumping a pointer within large chunks.  Single
+ * allocations are never freed, all memory of an arena is released at once by
+ * `clear_arena()`.
+ *
+ * This suits memory that lives for a known, short time like the state while
+ * parsing.  Many small allocations become a few large ones and nothing is left
+ * behind to fragment the heap.
+ */
+
+#include <stddef.h>
+
+#include "utility/list.h"
+
+/* the size of the chunks an arena allocates, larger allocations get a chunk of
+ * their own
+ */
+#define ARENA_CHUNK_SIZE 16384
+
+/* an arena of memory, all 0 is an empty arena */
+typedef struct arena {
+    /* the chunk allocations are made from, it links to all previous chunks */
+    struct arena_chunk *chunk;
+    /* the last allocation, only this one can grow in place */
+    void *last_allocation;
+} Arena;
+
+/* Allocate @size bytes within @arena.
+ *
+ * The memory is aligned for any type and uninitialized.
+ */
+void *allocate_arena_memory(Arena *arena, size_t size);
+
+/* Grow a region of @old_size bytes at @pointer within @arena to @new_size
+ * bytes.
+ *
+ * @pointer may be NULL to allocate a new region.
+ *
+ * The last allocation grows in place if there is space, others are copied.
+ *
+ * @return the new start of the region.
+ */
+void *reallocate_arena_memory(Arena *arena, _Nullable void *pointer,
+        size_t old_size, size_t new_size);
+
+/* Copy @length bytes of @string into @arena and null-terminate it. */
+char *duplicate_arena_string(Arena *arena, const char *string, size_t length);
+
+/* Free all memory of @arena. */
+void clear_arena(Arena *arena);
+
+/* Make sure a list within an arena has space for @item_count more items.
+ *
+ * Arena lists are declared with `LIST()` like any other list.
+ *
+ * Arena* @arena is the arena the list lives in.
+ * T*     @name is the name of the list.
+ * size_t @item_count is the number of items to make space for.
+ *
+ * void @return
+ */
+#define ARENA_LIST_GROW(arena, name, item_count) do { \
+    const size_t _needed = name##_length + (item_count); \
+\
+    if (_needed > name##_capacity) { \
+        const size_t _capacity = MAX(MAX(name##_capacity * 2, _needed), 4); \
+\
+        name = reallocate_arena_memory((arena), name, \
+                name##_capacity * sizeof(*name), _capacity * sizeof(*name)); \
+        name##_capacity = _capacity; \
+    } \
+} while (0)
+
+/* Append items to a list within an arena.
+ *
+ * Arena* @arena is the arena the list lives in.
+ * T*     @name is the name of the list.
+ * T*     @items is the items to append, NULL to append zeroed items.
+ * size_t @item_count is the number of items.
+ *
+ * void @return
+ */
+#define ARENA_LIST_APPEND(arena, name, items, item_count) do { \
+    const void *_items = (items); \
+    const size_t _item_count = (item_count); \
+\
+    ARENA_LIST_GROW(arena, name, _item_count); \
+    if (_items == NULL) { \
+        ZERO(&name[name##_length], _item_count); \
+    } else { \
+        COPY(&name[name##_length], _items, _item_count); \
+    } \
+    name##_length += _item_count; \
+} while (0)
+
+/* Append a value to a list within an arena.
+ *
+ * Arena* @arena is the arena the list lives in.
+ * T*     @name is the name of the list.
+ * T      @value is the value to append.
+ *
+ * void @return
+ */
+#define ARENA_LIST_APPEND_VALUE(arena, name, value) do { \
+    ARENA_LIST_GROW(arena, name, 1); \
+    name[name##_length] = (value); \
+    name##_length++; \
+} while (0)
+
+#endif
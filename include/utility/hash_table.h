@@ -0,0 +1,80 @@
+#ifndef UTILITY__HASH_TABLE_H
+#define UTILITY__HASH_TABLE_H
+
+/**
+ * A hash table maps names to values.  It grows as entries are added so there is
+ * no limit to the number of entries.
+ *
+ * The entries are kept in one dense list, this makes going through all entries
+ * simple and deterministic.  Entries are appended in the order they are added
+ * but removing an entry moves the last entry into its place, so the order is
+ * only kept as long as nothing is removed.  A separate array of slots, whose
+ * size is a power of two, maps hashes to entries with linear probing.  Every
+ * entry stores the 64 bit hash of its name so probing only compares names when
+ * the hashes are equal and growing needs no hashing.
+ *
+ * Adding or removing an entry may move other entries, pointers to entries are
+ * only valid until the next change to the table.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utility/list.h"
+
+/* an entry within the hash table */
+struct hash_table_entry {
+    /* the hash of the name */
+    uint64_t hash;
+    /* the null-terminated name of the entry */
+    char *name;
+    /* the length of the name in bytes */
+    size_t length;
+    /* the value associated with the name */
+    void *value;
+};
+
+/* a table mapping names to values */
+typedef struct hash_table {
+    /* all entries, in the order they were added unless some were removed */
+    LIST(struct hash_table_entry, entries);
+    /* index plus one of the entry in each slot, 0 for an empty slot */
+    size_t *slots;
+    /* the number of slots, 0 or a power of two */
+    size_t number_of_slots;
+} HashTable;
+
+/* Find the entry with @name of @length bytes.
+ *
+ * @name does not need to be null-terminated.
+ *
+ * @return NULL if there is no entry with that name.
+ */
+struct hash_table_entry *find_hash_table_entry(const HashTable *table,
+        const char *name, size_t length);
+
+/* Add an entry with @name of @length bytes and @value.
+ *
+ * @name is duplicated and does not need to be null-terminated, it may even
+ * contain null bytes.  There must not already be an entry with the same name.
+ *
+ * @return the added entry.
+ */
+struct hash_table_entry *add_hash_table_entry(HashTable *table,
+        const char *name, size_t length, void *value);
+
+/* Remove @entry from the table.
+ *
+ * The name of the entry is freed, the value must be freed by the caller.  The
+ * last entry is moved into the place of @entry.
+ */
+void remove_hash_table_entry(HashTable *table,
+        struct hash_table_entry *entry);
+
+/* Remove all entries from the table and free its memory.
+ *
+ * The values of the entries must be freed by the caller.
+ */
+void clear_hash_table(HashTable *table);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef UTILITY__INTERN_H
+#define UTILITY__INTERN_H
+
+/**
+ * Interned strings are kept once in a global pool, equal strings share the
+ * same memory.  Two interned strings are equal exactly when their pointers are
+ * equal.
+ *
+ * Each interned string has a reference count and is freed when the last
+ * reference is released.
+ */
+
+#include <stddef.h>
+
+/* Get the interned version of @string of @length bytes.
+ *
+ * @string does not need to be null-terminated.
+ *
+ * This adds a reference to the interned string that must be released with
+ * `release_string()`.
+ *
+ * @return the null-terminated interned string.
+ */
+const char *intern_string(const char *string, size_t length);
+
+/* Add another reference to the interned @string.
+ *
+ * @string may be NULL.
+ *
+ * @return @string.
+ */
+const char *reference_string(const char *string);
+
+/* Release a reference to the interned @string.
+ *
+ * @string may be NULL.
+ */
+void release_string(const char *string);
+
+/* Get the number of distinct strings in the pool. */
+size_t get_interned_string_count(void);
+
+#endif
@@ -50,7 +50,7 @@
  * void @return
  */
 #define LIST_CLEAR(name) do { \
-    free(name); \
+    xfree(name); \
     name = NULL; \
     name##_length = 0; \
     name##_capacity = 0; \
@@ -0,0 +1,69 @@
+#ifndef UTILITY__POOL_H
+#define UTILITY__POOL_H
+
+/**
+ * A pool hands out objects of a single size from large slabs.  Freed objects go
+ * onto a free list and are handed out again before a new slab is allocated.
+ * Slabs are never returned to the system.
+ *
+ * This suits objects that are created and destroyed all the time like windows
+ * and frames.  An allocation is mostly just taking the head of the free list
+ * and objects of the same kind lie close together in memory.
+ *
+ * Pools also count their objects which makes objects that are kept alive for
+ * too long by a forgotten reference visible.
+ */
+
+#include <stdio.h>
+
+/* a pool of objects of the same size, create it with `OBJECT_POOL()` */
+typedef struct object_pool {
+    /* the name of the objects for statistics */
+    const char *name;
+    /* the size of each object */
+    size_t object_size;
+    /* the number of objects within a slab */
+    size_t objects_per_slab;
+    /* the last allocated slab, it links to all previous slabs */
+    struct pool_slab *slab;
+    /* the number of allocated slabs */
+    size_t number_of_slabs;
+    /* the first free object, each free object links to the next one */
+    void *free_object;
+    /* the number of objects that are in use */
+    size_t used_count;
+    /* the highest number of objects in use at once */
+    size_t peak_used_count;
+    /* the number of objects ever allocated */
+    size_t allocation_count;
+} ObjectPool;
+
+/* Initialize a pool for objects of given type.
+ *
+ * T        @type is the type of the objects.
+ * unsigned @per_slab is the number of objects within a slab.
+ *
+ * ObjectPool @return
+ */
+#define OBJECT_POOL(type, per_slab) { \
+    .name = #type, \
+    .object_size = sizeof(type), \
+    .objects_per_slab = (per_slab), \
+}
+
+/* Get a zeroed object from @pool. */
+void *allocate_pool_object(ObjectPool *pool);
+
+/* Put @object back into @pool so it can be handed out again. */
+void free_pool_object(ObjectPool *pool, void *object);
+
+/* Free all slabs of @pool.
+ *
+ * All objects of @pool must have been freed before.
+ */
+void clear_object_pool(ObjectPool *pool);
+
+/* Print the statistics of @pool as a single line into @file. */
+void print_object_pool(const ObjectPool *pool, FILE *file);
+
+#endif
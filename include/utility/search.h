@@ -0,0 +1,52 @@
+#ifndef UTILITY__SEARCH_H
+#define UTILITY__SEARCH_H
+
+/**
+ * A search is a string of space separated words.  A search key matches when
+ * every word of the search is contained in it.  Only ascii letters are compared
+ * without regard to case.
+ *
+ * To quickly rule out keys, every key stores a bit set of its hashed trigrams.
+ * When the search has a trigram the key does not have, the key can not match.
+ *
+ * Making the search longer can never make more keys match.  Users of a search
+ * exploit this to only check keys again that matched the shorter search.
+ */
+
+#include "utility/types.h"
+
+/* the searchable version of one or more strings */
+typedef struct search_key {
+    /* lower case strings separated by new lines */
+    utf8_t *string;
+    /* bit set of the hashed trigrams within `string` */
+    uint64_t trigrams;
+} SearchKey;
+
+/* Set @key to the lower case concatenation of given @strings.
+ *
+ * @strings may contain NULL entries which are skipped.
+ */
+void set_search_key(SearchKey *key, const char *const *strings,
+        unsigned number_of_strings);
+
+/* Free the resources occupied by @key. */
+void clear_search_key(SearchKey *key);
+
+/* Convert @character to the form it is compared with. */
+utf8_t get_search_character(utf8_t character);
+
+/* Get the bit set of all trigrams within the first @length bytes of @search.
+ *
+ * Trigrams spanning over multiple words are not included.
+ */
+uint64_t get_search_trigrams(const utf8_t *search, size_t length);
+
+/* Check if @key matches the first @length bytes of @search.
+ *
+ * @trigrams must be the result of `get_search_trigrams()` for the same search.
+ */
+bool does_search_match(const SearchKey *key, const utf8_t *search,
+        size_t length, uint64_t trigrams);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef UTILITY__UTF8_H
+#define UTILITY__UTF8_H
+
+/**
+ * Decoding of UTF-8 strings into unicode codepoints.
+ *
+ * Most strings the window manager renders (window titles, commands, file names)
+ * are mostly ascii.  Runs of ascii bytes are therefore checked and widened many
+ * bytes at a time.  This uses SSE2 or AVX2 when the compiler targets them and
+ * otherwise checks 8 bytes at a time using a 64 bit integer.
+ *
+ * All other bytes are validated: overlong encodings, surrogates, codepoints
+ * above U+10FFFF and truncated or stray bytes each turn into U+FFFD.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utility/types.h"
+
+/* the codepoint used in place of invalid byte sequences */
+#define UTF8_REPLACEMENT_CHARACTER 0xfffd
+
+/* Decode the UTF-8 string @utf8 of @length bytes into @codepoints.
+ *
+ * @codepoints must have space for at least @length values as each byte results
+ *             in at most one codepoint.
+ *
+ * @return the number of codepoints written.
+ */
+size_t decode_utf8(const utf8_t *utf8, size_t length, uint32_t *codepoints);
+
+#endif
@@ -6,8 +6,10 @@
  */
 
 #include <stdbool.h> /* bool */
+#include <stdint.h> /* uint64_t */
 #include <stdio.h> /* fprintf(), stderr */
 #include <string.h> /* memset() */
+#include <sys/types.h> /* pid_t */
 #include <wchar.h> /* wchar_t */
 
 #include "utility/xalloc.h"
@@ -128,12 +130,42 @@
 /* Get the absolute difference between two numbers. */
 #define ABSOLUTE_DIFFERENCE(a, b) ((a) < (b) ? (b) - (a) : (a) - (b))
 
+/* a union of the basic types with the strictest alignment, its size is a
+ * multiple of any alignment
+ */
+union maximum_alignment {
+    long double long_double;
+    long long long_long;
+    void *pointer;
+    void (*function)(void);
+};
+
+/* Round @size up to the next multiple of the maximum alignment. */
+#define ALIGN_SIZE(size) \
+    (((size) + sizeof(union maximum_alignment) - 1) / \
+        sizeof(union maximum_alignment) * sizeof(union maximum_alignment))
+
 /* Run @command within a shell in the background. */
 void run_shell(const char *command);
 
 /* Run @command as command within a shell and get the first line from it. */
 char *run_shell_and_get_output(const char *command);
 
+/* Run @command within a shell and get a file descriptor to read its output.
+ *
+ * The file descriptor is non blocking.  The shell and all processes it starts
+ * must be stopped using `stop_shell()` with the returned @process_id.
+ *
+ * @return -1 if the shell could not be started.
+ */
+int run_shell_with_output(const char *command, pid_t *process_id);
+
+/* Stop a shell started by `run_shell_with_output()`.
+ *
+ * This also waits for the shell so it does not linger as zombie process.
+ */
+void stop_shell(pid_t process_id);
+
 /* Check if a character is a line ending character.
  *
  * This includes \n, \v, \f and \r.
@@ -153,6 +185,13 @@ size_t strnlen(const char *string, size_t max_length);
  */
 int strcasecmp(const char *string1, const char *string2);
 
+/* Get a hash of @size bytes at @data.
+ *
+ * This is not suited for cryptographic purposes, it is only used to detect if
+ * data changed.
+ */
+uint64_t get_hash(const void *data, size_t size);
+
 /* Match a string against a pattern.
  *
  * Pattern metacharacters are ?, *, [.  They can be escaped using \ to match
@@ -6,11 +6,67 @@
  *
  * If at any point there is not enough heap space while using these functions,
  * the program is aborted.
+ *
+ * Memory from these functions must be freed with `xfree()`.
+ *
+ * When compiled with `ALLOCATION_ACCOUNTING`, each allocation is counted for
+ * the source file it is made in, see `get_allocation_sites()`.  The functions
+ * are macros that pass `__FILE__` along, the file is what the statistics are
+ * grouped by.  A small header in front of each allocation remembers its size
+ * and file so `xfree()` can take the bytes off again.
  */
 
 #include <stdlib.h> /* NULL, size_t, malloc(), calloc(), realloc(), free() */
 
-#include "utility/attributes.h" /* _Nullable */
+#include "utility/attributes.h" /* _Nullable, _Out */
+
+#ifdef ALLOCATION_ACCOUNTING
+
+/* the maximum number of source files allocations are counted for, this must
+ * be a power of two, further files are counted together
+ */
+#define MAX_ALLOCATION_SITES 128
+
+/* the allocations made within a source file */
+struct allocation_site {
+    /* the source file, NULL if the site is not used */
+    const char *file;
+    /* the number of allocations including reallocations */
+    size_t allocation_count;
+    /* the number of bytes allocated and not yet freed */
+    size_t live_bytes;
+    /* the highest number of live bytes there ever was */
+    size_t peak_bytes;
+};
+
+/* Get the allocation statistics of all source files.
+ *
+ * Sites without any allocations are unused and should be skipped.
+ *
+ * @number_of_sites is set to the number of sites.
+ *
+ * @return the sites in no particular order.
+ */
+const struct allocation_site *get_allocation_sites(
+        _Out size_t *number_of_sites);
+
+/* Get the number of allocations made so far by all source files. */
+size_t get_allocation_count(void);
+
+/* Free memory allocated by any of the functions below.
+ *
+ * Reallocated memory is counted for the file that reallocated it last, so the
+ * bytes are taken off that file.
+ *
+ * @pointer may be NULL, then nothing happens.
+ */
+void xfree(_Nullable void *pointer);
+
+#else
+
+#define xfree(pointer) free(pointer)
+
+#endif
 
 /* Allocate a minimum of @size bytes of memory.
  *
@@ -18,7 +74,8 @@
  *
  * @return the start of the allocated region or NULL when @size is 0.
  */
-void *xmalloc(size_t size);
+void *_xmalloc(const char *file, size_t size);
+#define xmalloc(size) _xmalloc(__FILE__, (size))
 
 /* Allocate @number_of_elements number of elements with each element being
  * @size_per_element large.
@@ -30,7 +87,10 @@ void *xmalloc(size_t size);
  *
  * @return the start of the allocated region or NULL when the byte count is 0.
  */
-void *xcalloc(size_t number_of_elements, size_t size_per_element);
+void *_xcalloc(const char *file, size_t number_of_elements,
+        size_t size_per_element);
+#define xcalloc(number_of_elements, size_per_element) \
+    _xcalloc(__FILE__, (number_of_elements), (size_per_element))
 
 /* Grow or shrink a previously allocated memory region.
  *
@@ -41,15 +101,19 @@ void *xcalloc(size_t number_of_elements, size_t size_per_element);
  *         @pointer but this is often not the case when growing.
  *         This is NULL if @size is 0.
  */
-void *xrealloc(_Nullable void *pointer, size_t size);
+void *_xrealloc(const char *file, _Nullable void *pointer, size_t size);
+#define xrealloc(pointer, size) _xrealloc(__FILE__, (pointer), (size))
 
 /* Same as `xrealloc()` but instead of using bytes as argument, use
  * @number_of_elements * @size_per_element.
  *
  * If this product overflows, the program is aborted.
  */
-void *xreallocarray(_Nullable void *pointer, size_t number_of_elements,
-        size_t size_per_element);
+void *_xreallocarray(const char *file, _Nullable void *pointer,
+        size_t number_of_elements, size_t size_per_element);
+#define xreallocarray(pointer, number_of_elements, size_per_element) \
+    _xreallocarray(__FILE__, (pointer), (number_of_elements), \
+            (size_per_element))
 
 /* Combination of `xmalloc()` and `memcpy()`.
  *
@@ -57,26 +121,30 @@ void *xreallocarray(_Nullable void *pointer, size_t number_of_elements,
  *
  * @return NULL when @size is 0.
  */
-void *xmemdup(const void *pointer, size_t size);
+void *_xmemdup(const char *file, const void *pointer, size_t size);
+#define xmemdup(pointer, size) _xmemdup(__FILE__, (pointer), (size))
 
 /* Duplicate the null-terminated @string pointer by creating a copy.
  *
  * @string may be NULL, then NULL is returned.
  */
-char *xstrdup(_Nullable const char *string);
+char *_xstrdup(const char *file, _Nullable const char *string);
+#define xstrdup(string) _xstrdup(__FILE__, (string))
 
 /* Like `xstrdup()` but stop at @length when the null-terminator is not yet
  * encountered.
  *
  * @string may be NULL but only if @length is 0.
  */
-char *xstrndup(const char *string, size_t length);
+char *_xstrndup(const char *file, const char *string, size_t length);
+#define xstrndup(string, length) _xstrndup(__FILE__, (string), (length))
 
 /* Combination of `xmalloc()` and `sprintf()`.
  *
  * This first figures out the needed amount of bytes for @format and given
  * variable arguments, then allocates memory to hold.
  */
-char *xasprintf(const char *format, ...);
+char *_xasprintf(const char *file, const char *format, ...);
+#define xasprintf(...) _xasprintf(__FILE__, __VA_ARGS__)
 
 #endif
@@ -3,16 +3,21 @@
 #include <string.h>
 
 #include "action.h"
+#include "bar.h"
 #include "binding.h"
 #include "cursor.h"
 #include "event.h"
 #include "fensterchef.h"
+#include "flight_recorder.h"
 #include "frame.h"
+#include "launcher.h"
 #include "log.h"
 #include "monitor.h"
 #include "notification.h"
 #include "parse/group.h"
 #include "parse/parse.h"
+#include "statistics.h"
+#include "trace.h"
 #include "window.h"
 #include "window_list.h"
 #include "x11/display.h"
@@ -21,6 +26,41 @@
 /* the current group call depth */
 static unsigned block_call_depth;
 
+/* A single step of a compiled action block. */
+struct action_instruction {
+    /* what running the instruction does */
+    enum {
+        /* do the action */
+        INSTRUCTION_ACTION,
+        /* run @group, it was not inlined */
+        INSTRUCTION_CALL,
+        /* the inlined actions of a called group follow */
+        INSTRUCTION_BEGIN_CALL,
+        /* the inlined actions of a called group end */
+        INSTRUCTION_END_CALL,
+    } kind;
+    /* the type of the action */
+    action_type_t type;
+    /* the data of the action */
+    const struct action_data *data;
+    /* the group to run for `INSTRUCTION_CALL` */
+    ActionBlock *group;
+};
+
+/* An action block compiled into a flat list of instructions. */
+struct action_program {
+    /* the number of references to this program */
+    unsigned reference_count;
+    /* the group change count at the time of compiling */
+    unsigned group_change_count;
+    /* the called groups the instructions point into, these are not referenced
+     * by the program because groups may call each other
+     */
+    LIST(ActionBlock*, groups);
+    /* the instructions to run */
+    LIST(struct action_instruction, instructions);
+};
+
 /* the corresponding string identifier for all actions */
 static const char *action_strings[ACTION_MAX] = {
 #define X(identifier, string) \
@@ -77,7 +117,7 @@ void clear_action_data(struct action_data *data)
         break;
 
     case ACTION_DATA_TYPE_STRING:
-        free(data->u.string);
+        xfree(data->u.string);
         break;
 
     case ACTION_DATA_TYPE_RELATION:
@@ -128,6 +168,22 @@ void duplicate_action_data(struct action_data *data)
     }
 }
 
+/* Decrement the reference counter of @program and free it when it reaches 0. */
+static void release_action_program(struct action_program *program)
+{
+    if (program == NULL) {
+        return;
+    }
+
+    if (program->reference_count <= 1) {
+        LIST_CLEAR(program->groups);
+        LIST_CLEAR(program->instructions);
+        xfree(program);
+    } else {
+        program->reference_count--;
+    }
+}
+
 /* Increment the reference counter of an action block. */
 void reference_action_block(ActionBlock *block)
 {
@@ -156,8 +212,9 @@ void dereference_action_block(ActionBlock *block)
                 data++;
             }
         }
-        free(block->items);
-        free(block);
+        release_action_program(block->program);
+        xfree(block->items);
+        xfree(block);
     } else {
         block->reference_count--;
     }
@@ -181,6 +238,78 @@ ActionBlock *create_empty_action_block(size_t number_of_items,
     return block;
 }
 
+/* Append the instructions for all actions within @block to @program.
+ *
+ * @depth is the number of groups @block is inlined into.
+ */
+static void compile_action_block(struct action_program *program,
+        const ActionBlock *block, unsigned depth)
+{
+    const struct action_data *data;
+    struct action_instruction instruction;
+    ActionBlock *group;
+
+    data = block->data;
+    for (size_t i = 0; i < block->number_of_items; i++) {
+        instruction.kind = INSTRUCTION_ACTION;
+        instruction.type = block->items[i].type;
+        instruction.data = data;
+        instruction.group = NULL;
+
+        group = NULL;
+        if (instruction.type == ACTION_CALL) {
+            /* a group that does not exist is reported when running */
+            group = find_group(data->u.string);
+        }
+
+        if (group != NULL) {
+            LIST_APPEND_VALUE(program->groups, group);
+            /* +2 for the instructions around the inlined actions */
+            if (depth < MAX_INLINE_DEPTH &&
+                    program->instructions_length + group->number_of_items +
+                        2 <= MAX_INLINED_INSTRUCTIONS) {
+                instruction.kind = INSTRUCTION_BEGIN_CALL;
+                LIST_APPEND_VALUE(program->instructions, instruction);
+                compile_action_block(program, group, depth + 1);
+                instruction.kind = INSTRUCTION_END_CALL;
+                LIST_APPEND_VALUE(program->instructions, instruction);
+            } else {
+                instruction.kind = INSTRUCTION_CALL;
+                instruction.group = group;
+                LIST_APPEND_VALUE(program->instructions, instruction);
+            }
+        } else {
+            LIST_APPEND_VALUE(program->instructions, instruction);
+        }
+
+        data += block->items[i].data_count;
+    }
+}
+
+/* Get the compiled form of @block, compile it if it is out of date.
+ *
+ * @return a new reference to the program.
+ */
+static struct action_program *get_action_program(ActionBlock *block)
+{
+    struct action_program *program;
+
+    program = block->program;
+    if (program == NULL ||
+            program->group_change_count != get_group_change_count()) {
+        release_action_program(program);
+
+        ALLOCATE_ZERO(program, 1);
+        program->reference_count = 1;
+        program->group_change_count = get_group_change_count();
+        compile_action_block(program, block, 0);
+        block->program = program;
+    }
+
+    program->reference_count++;
+    return program;
+}
+
 /* Do all actions within @block. */
 void run_action_block(ActionBlock *block)
 {
@@ -189,19 +318,68 @@ void run_action_block(ActionBlock *block)
     if (block_call_depth > MAX_BLOCK_CALL_DEPTH) {
         LOG_ERROR("interrupted action: calling is too deep or nested\n");
     } else {
-        const struct action_data *data;
+        struct action_program *program;
+        const struct action_instruction *instruction;
+        uint64_t start;
+        /* the start times of the inlined calls */
+        uint64_t call_starts[MAX_INLINE_DEPTH];
+        unsigned inlined_depth = 0;
 
         reference_action_block(block);
+        program = get_action_program(block);
 
-        data = block->data;
-        for (size_t i = 0; i < block->number_of_items; i++) {
-            struct action_block_item *item;
+        /* the groups might be cleared while running, for example by a reload
+         * of the configuration
+         */
+        for (size_t i = 0; i < program->groups_length; i++) {
+            reference_action_block(program->groups[i]);
+        }
+
+        for (size_t i = 0; i < program->instructions_length; i++) {
+            instruction = &program->instructions[i];
+            switch (instruction->kind) {
+            case INSTRUCTION_ACTION:
+                begin_trace_span("action",
+                        get_action_string(instruction->type));
+                start = get_statistics_time();
+                do_action(instruction->type, instruction->data);
+                count_action(instruction->type, start);
+                end_trace_span();
+                break;
 
-            item = &block->items[i];
-            do_action(item->type, data);
-            data += item->data_count;
+            /* record the call like `do_action()` would */
+            case INSTRUCTION_CALL:
+                begin_trace_span("action", get_action_string(ACTION_CALL));
+                start = get_statistics_time();
+                record_action(ACTION_CALL, instruction->data);
+                run_action_block(instruction->group);
+                count_action(ACTION_CALL, start);
+                end_trace_span();
+                break;
+
+            /* the inlined call is nested like a real call */
+            case INSTRUCTION_BEGIN_CALL:
+                begin_trace_span("action", get_action_string(ACTION_CALL));
+                call_starts[inlined_depth] = get_statistics_time();
+                inlined_depth++;
+                record_action(ACTION_CALL, instruction->data);
+                block_call_depth++;
+                break;
+
+            case INSTRUCTION_END_CALL:
+                block_call_depth--;
+                inlined_depth--;
+                count_action(ACTION_CALL, call_starts[inlined_depth]);
+                end_trace_span();
+                break;
+            }
         }
 
+        for (size_t i = 0; i < program->groups_length; i++) {
+            dereference_action_block(program->groups[i]);
+        }
+
+        release_action_program(program);
         dereference_action_block(block);
     }
 
@@ -525,6 +703,8 @@ void do_action(action_type_t type, const struct action_data *data)
     window = Window_selected;
     frame = Frame_focus;
 
+    record_action(type, data);
+
     switch (type) {
     /* assign a number to a frame */
     case ACTION_ASSIGN:
@@ -589,6 +769,16 @@ void do_action(action_type_t type, const struct action_data *data)
         configuration.background = data->u.integer;
         break;
 
+    /* whether to show a bar at the top of each monitor */
+    case ACTION_BAR:
+        configuration.bar = data->u.integer;
+        break;
+
+    /* add a command whose output is shown in the bar */
+    case ACTION_BAR_COMMAND:
+        add_bar_command(data->u.string);
+        break;
+
     /* the border color of all windows */
     case ACTION_BORDER_COLOR:
         configuration.border_color = data->u.integer;
@@ -645,14 +835,14 @@ void do_action(action_type_t type, const struct action_data *data)
 
     /* call a group by name */
     case ACTION_CALL: {
-        struct parse_group *group;
+        ActionBlock *actions;
 
-        group = find_group(data->u.string);
-        if (group == NULL) {
+        actions = find_group(data->u.string);
+        if (actions == NULL) {
             LOG_ERROR("group %s does not exist\n",
                     data->u.string);
         } else {
-            run_action_block(group->actions);
+            run_action_block(actions);
         }
         break;
     }
@@ -757,6 +947,35 @@ void do_action(action_type_t type, const struct action_data *data)
         }
         break;
 
+    /* write the lines within the log ring to a file */
+    case ACTION_DUMP_LOG:
+        if (!is_log_ring_used()) {
+            LOG_ERROR("there is no log ring, "
+                    "start fensterchef with --log-ring\n");
+            break;
+        }
+        if (dump_log_ring(data->u.string) == ERROR) {
+            LOG_ERROR("can not write dump to %s: %s\n",
+                    data->u.string, strerror(errno));
+        }
+        break;
+
+    /* write statistics about the used memory to a file */
+    case ACTION_DUMP_MEMORY:
+        if (dump_memory(data->u.string) == ERROR) {
+            LOG_ERROR("can not write dump to %s: %s\n",
+                    data->u.string, strerror(errno));
+        }
+        break;
+
+    /* write the event, action and round-trip statistics to a file */
+    case ACTION_DUMP_STATISTICS:
+        if (dump_statistics(data->u.string) == ERROR) {
+            LOG_ERROR("can not write dump to %s: %s\n",
+                    data->u.string, strerror(errno));
+        }
+        break;
+
     /* make a frame empty */
     case ACTION_EMPTY:
         (void) stash_frame(Frame_focus);
@@ -969,7 +1188,7 @@ void do_action(action_type_t type, const struct action_data *data)
 
     /* the font used for rendering */
     case ACTION_FONT:
-        set_font(data->u.string);
+        (void) set_font(data->u.string);
         break;
 
     /* the foreground color of the fensterchef windows */
@@ -1291,6 +1510,11 @@ void do_action(action_type_t type, const struct action_data *data)
         set_error_notification(data->u.string);
         break;
 
+    /* toggle visibility of the interactive application launcher */
+    case ACTION_SHOW_LAUNCHER:
+        (void) show_launcher();
+        break;
+
     /* toggle visibility of the interactive window list */
     case ACTION_SHOW_LIST:
         if (show_window_list() == ERROR) {
@@ -1337,6 +1561,7 @@ void do_action(action_type_t type, const struct action_data *data)
         set_system_notification(shell,
                 Frame_focus->x + Frame_focus->width / 2,
                 Frame_focus->y + Frame_focus->height / 2);
+        /* the output is not allocated by xalloc */
         free(shell);
         break;
 
@@ -1406,6 +1631,17 @@ void do_action(action_type_t type, const struct action_data *data)
                 WINDOW_MODE_FLOATING : WINDOW_MODE_TILING);
         break;
 
+    /* start tracing or stop it and write the trace to a file */
+    case ACTION_TOGGLE_TRACE:
+        if (!is_tracing()) {
+            LOG("starting to trace\n");
+            start_trace();
+        } else if (stop_trace(data->u.string) == ERROR) {
+            LOG_ERROR("can not write trace to %s: %s\n",
+                    data->u.string, strerror(errno));
+        }
+        break;
+
     /* remove the currently running relation */
     case ACTION_UNRELATE:
         remove_current_window_relation();
@@ -1429,14 +1665,14 @@ void do_action(action_type_t type, const struct action_data *data)
 
     /* undo a group */
     case ACTION_UNGROUP: {
-        struct parse_group *group;
+        ActionBlock *actions;
 
-        group = find_group(data->u.string);
-        if (group == NULL) {
+        actions = find_group(data->u.string);
+        if (actions == NULL) {
             LOG_ERROR("group %s cannot be unbound as it does not exist\n",
                     data->u.string);
         } else {
-            undo_group(group);
+            undo_group(actions);
         }
         break;
     }
@@ -0,0 +1,767 @@
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bar.h"
+#include "configuration.h"
+#include "font.h"
+#include "log.h"
+#include "monitor.h"
+#include "window.h"
+#include "utility/list.h"
+#include "x11/display.h"
+#include "x11/synchronize.h"
+
+/* the format of the clock, it is only updated every minute */
+#define BAR_CLOCK_FORMAT "%a %d %b %H:%M"
+
+/* the indexes of the segments within a bar, the command segments follow */
+enum {
+    /* the numbers of the windows on the monitor */
+    BAR_SEGMENT_NUMBERS,
+    /* the title of the focused window */
+    BAR_SEGMENT_TITLE,
+    /* the current time */
+    BAR_SEGMENT_CLOCK,
+    /* the output of the first command */
+    BAR_SEGMENT_COMMANDS,
+};
+
+/* a command whose output is shown in the bar */
+struct bar_command {
+    /* the shell command */
+    char *command;
+    /* the process running the command or 0 if it is not running */
+    pid_t process_id;
+    /* the file descriptor to read the output from or -1 */
+    int file_descriptor;
+    /* if the command was started, it is only started once */
+    bool has_started;
+    /* if the command was removed by `clear_bar_commands()` */
+    bool is_removed;
+    /* the last complete line the command wrote */
+    char *line;
+    /* the incomplete line read so far */
+    char buffer[256];
+    /* the length of the incomplete line */
+    size_t buffer_length;
+};
+
+/* a section within a bar */
+struct bar_segment {
+    /* the text of the segment, NULL if it needs to be measured again */
+    utf8_t *text;
+    /* the width of the text */
+    unsigned text_width;
+    /* if the text changed since the last drawing */
+    bool is_changed;
+    /* the position and width the segment should have */
+    int x;
+    unsigned width;
+    /* the position and width the segment has on screen */
+    int drawn_x;
+    unsigned drawn_width;
+    /* the text object, it only exists while drawing */
+    Text *rendered;
+};
+
+/* the bar window on a monitor */
+struct bar {
+    /* the name of the monitor the bar is on */
+    char *monitor_name;
+    /* the X correspondence */
+    XReference reference;
+    /* Xft drawing context */
+    XftDraw *xft_draw;
+    /* if the bar needs to be drawn entirely */
+    bool is_exposed;
+    /* the colors and font the bar was drawn with */
+    uint32_t foreground;
+    uint32_t background;
+    XftFont *font;
+    /* if the monitor still exists, used while matching the monitors */
+    bool is_used;
+    /* the segments of the bar */
+    LIST(struct bar_segment, segments);
+};
+
+/* all bars and bar commands */
+static struct {
+    /* the bars of all monitors */
+    LIST(struct bar, bars);
+    /* the commands whose output is shown */
+    LIST(struct bar_command, commands);
+    /* the colors all bars are drawn with, they are only allocated again when
+     * the configured colors change
+     */
+    XftColor foreground;
+    XftColor background;
+    /* the configured colors `foreground` and `background` are for */
+    uint32_t foreground_rgb;
+    uint32_t background_rgb;
+    /* if `foreground` and `background` are allocated */
+    bool has_colors;
+} Bar;
+
+/* Get the height of the bar. */
+unsigned get_bar_height(void)
+{
+    XftFont *font;
+
+    if (!configuration.bar) {
+        return 0;
+    }
+
+    font = get_primary_font();
+    if (font == NULL) {
+        return 0;
+    }
+    return font->ascent + font->descent + configuration.text_padding;
+}
+
+/****************
+ * Bar commands *
+ ****************/
+
+/* Add a command whose output should be shown in the bar. */
+void add_bar_command(const char *command)
+{
+    struct bar_command *bar_command;
+
+    /* keep the command running if it is still there from before */
+    for (size_t i = 0; i < Bar.commands_length; i++) {
+        bar_command = &Bar.commands[i];
+        if (bar_command->is_removed &&
+                strcmp(bar_command->command, command) == 0) {
+            bar_command->is_removed = false;
+            /* move it to the end to keep the order of the configuration */
+            const struct bar_command saved = *bar_command;
+            MOVE(&Bar.commands[i], &Bar.commands[i + 1],
+                    Bar.commands_length - i - 1);
+            Bar.commands[Bar.commands_length - 1] = saved;
+            return;
+        }
+    }
+
+    LIST_GROW(Bar.commands, Bar.commands_length + 1);
+    bar_command = &Bar.commands[Bar.commands_length++];
+    ZERO(bar_command, 1);
+    bar_command->command = xstrdup(command);
+    bar_command->file_descriptor = -1;
+    bar_command->line = xstrdup("");
+}
+
+/* Mark all bar commands as removed. */
+void clear_bar_commands(void)
+{
+    for (size_t i = 0; i < Bar.commands_length; i++) {
+        Bar.commands[i].is_removed = true;
+    }
+}
+
+/* Stop the process of @command if it is running. */
+static void stop_bar_command(struct bar_command *command)
+{
+    if (command->process_id == 0) {
+        return;
+    }
+
+    LOG("stopping bar command: %s\n",
+            command->command);
+
+    stop_shell(command->process_id);
+    close(command->file_descriptor);
+    command->process_id = 0;
+    command->file_descriptor = -1;
+}
+
+/* Start the process of @command if it was not started yet. */
+static void start_bar_command(struct bar_command *command)
+{
+    if (command->has_started) {
+        return;
+    }
+    command->has_started = true;
+
+    command->file_descriptor = run_shell_with_output(command->command,
+            &command->process_id);
+    if (command->file_descriptor < 0) {
+        LOG_ERROR("could not start bar command %s: %s\n",
+                command->command, strerror(errno));
+        command->process_id = 0;
+        return;
+    }
+
+    LOG("started bar command: %s\n",
+            command->command);
+}
+
+/* Stop all removed commands and start all new commands. */
+static void update_bar_commands(void)
+{
+    size_t index = 0;
+
+    for (size_t i = 0; i < Bar.commands_length; i++) {
+        struct bar_command *const command = &Bar.commands[i];
+
+        if (command->is_removed) {
+            stop_bar_command(command);
+            xfree(command->command);
+            xfree(command->line);
+            continue;
+        }
+
+        if (configuration.bar) {
+            start_bar_command(command);
+        } else {
+            stop_bar_command(command);
+            /* start again when the bar is enabled again */
+            command->has_started = false;
+        }
+
+        Bar.commands[index++] = *command;
+    }
+    Bar.commands_length = index;
+}
+
+/* Add the file descriptors of the running bar commands to @set. */
+int set_bar_file_descriptors(fd_set *set)
+{
+    int maximum = -1;
+
+    for (size_t i = 0; i < Bar.commands_length; i++) {
+        const int file_descriptor = Bar.commands[i].file_descriptor;
+        if (file_descriptor >= 0) {
+            FD_SET(file_descriptor, set);
+            maximum = MAX(maximum, file_descriptor);
+        }
+    }
+    return maximum;
+}
+
+/* Take the incomplete line of @command as its new line. */
+static void complete_bar_command_line(struct bar_command *command)
+{
+    xfree(command->line);
+    command->line = xstrndup(command->buffer, command->buffer_length);
+    command->buffer_length = 0;
+}
+
+/* Read all output @command has available. */
+static void read_bar_command(struct bar_command *command)
+{
+    char buffer[1024];
+    ssize_t count;
+
+    while (count = read(command->file_descriptor, buffer, sizeof(buffer)),
+            count > 0) {
+        for (ssize_t i = 0; i < count; i++) {
+            if (buffer[i] == '\n') {
+                complete_bar_command_line(command);
+                continue;
+            }
+
+            command->buffer[command->buffer_length++] = buffer[i];
+            /* cut off lines that are too long */
+            if (command->buffer_length == sizeof(command->buffer)) {
+                complete_bar_command_line(command);
+            }
+        }
+    }
+
+    /* the command exited or closed its output */
+    if (count == 0 || (errno != EAGAIN && errno != EINTR)) {
+        stop_bar_command(command);
+    }
+}
+
+/* Read the output of all bar commands whose file descriptor is in @set. */
+void handle_bar_file_descriptors(const fd_set *set)
+{
+    for (size_t i = 0; i < Bar.commands_length; i++) {
+        struct bar_command *const command = &Bar.commands[i];
+        if (command->file_descriptor >= 0 &&
+                FD_ISSET(command->file_descriptor, set)) {
+            read_bar_command(command);
+        }
+    }
+}
+
+/* Get the number of seconds until the clock of the bar changes. */
+int get_bar_timeout(void)
+{
+    if (!configuration.bar) {
+        return -1;
+    }
+    return 60 - time(NULL) % 60;
+}
+
+/***************
+ * Bar windows *
+ ***************/
+
+/* Create the window of @bar. */
+static int initialize_bar(struct bar *bar)
+{
+    XSetWindowAttributes attributes;
+
+    bar->reference.x = -1;
+    bar->reference.y = -1;
+    bar->reference.width = 1;
+    bar->reference.height = 1;
+    attributes.background_pixel = configuration.background;
+    /* indicate to not manage the window */
+    attributes.override_redirect = True;
+    attributes.event_mask = ExposureMask;
+    bar->reference.id = XCreateWindow(display, DefaultRootWindow(display),
+            bar->reference.x, bar->reference.y,
+            bar->reference.width, bar->reference.height, 0,
+            CopyFromParent, InputOutput, (Visual*) CopyFromParent,
+            CWBackPixel | CWOverrideRedirect | CWEventMask, &attributes);
+
+    if (bar->reference.id == None) {
+        LOG_ERROR("failed creating bar window\n");
+        return ERROR;
+    }
+
+    XStoreName(display, bar->reference.id, "[fensterchef] bar");
+
+    bar->xft_draw = XftDrawCreate(display, bar->reference.id,
+            DefaultVisual(display, DefaultScreen(display)),
+            DefaultColormap(display, DefaultScreen(display)));
+    if (bar->xft_draw == NULL) {
+        LOG_ERROR("could not create XftDraw for the bar window\n");
+        XDestroyWindow(display, bar->reference.id);
+        return ERROR;
+    }
+    return OK;
+}
+
+/* Destroy the window of @bar and free all its resources. */
+static void destroy_bar(struct bar *bar)
+{
+    XftDrawDestroy(bar->xft_draw);
+    XDestroyWindow(display, bar->reference.id);
+    for (size_t i = 0; i < bar->segments_length; i++) {
+        xfree(bar->segments[i].text);
+    }
+    LIST_CLEAR(bar->segments);
+    xfree(bar->monitor_name);
+}
+
+/* Destroy the windows of all bars. */
+static void destroy_all_bars(void)
+{
+    for (size_t i = 0; i < Bar.bars_length; i++) {
+        destroy_bar(&Bar.bars[i]);
+    }
+    LIST_CLEAR(Bar.bars);
+}
+
+/* Handle an incoming X event for the bar windows. */
+void handle_bar_event(XEvent *event)
+{
+    if (event->type != Expose || event->xexpose.count != 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < Bar.bars_length; i++) {
+        if (Bar.bars[i].reference.id == event->xexpose.window) {
+            Bar.bars[i].is_exposed = true;
+            break;
+        }
+    }
+}
+
+/* Create a text object for @string. */
+static Text *create_segment_text(const utf8_t *string)
+{
+    FcChar32 *glyphs;
+    int glyph_count;
+
+    glyphs = get_glyphs(string, -1, &glyph_count);
+    return create_text(glyphs, glyph_count);
+}
+
+/* Set the text of @segment and measure it if it changed. */
+static void set_segment_text(struct bar_segment *segment, const utf8_t *text)
+{
+    if (segment->text != NULL && strcmp(segment->text, text) == 0) {
+        return;
+    }
+
+    xfree(segment->text);
+    segment->text = xstrdup(text);
+    segment->is_changed = true;
+
+    if (text[0] == '\0') {
+        segment->text_width = 0;
+    } else {
+        segment->rendered = create_segment_text(text);
+        segment->text_width = segment->rendered->width;
+    }
+}
+
+/* Build the text with the window numbers on @monitor. */
+static void get_numbers_text(Monitor *monitor, utf8_t *buffer,
+        size_t buffer_size)
+{
+    size_t length = 0;
+    int count;
+
+    buffer[0] = '\0';
+    for (FcWindow *window = Window_first;
+            window != NULL;
+            window = window->next) {
+        if (!window->state.is_visible ||
+                window->state.mode == WINDOW_MODE_DOCK ||
+                window->state.mode == WINDOW_MODE_DESKTOP ||
+                get_monitor_containing_window(window) != monitor) {
+            continue;
+        }
+
+        count = snprintf(&buffer[length], buffer_size - length, "%s%u%s",
+                length == 0 ? "" : " ", window->number,
+                window == Window_focus ? "*" : "");
+        if (count < 0 || (size_t) count >= buffer_size - length) {
+            break;
+        }
+        length += count;
+    }
+}
+
+/* Put the segments of @bar next to each other.
+ *
+ * The numbers and title are on the left, the commands and clock on the right.
+ * The title is cut off if there is not enough space.
+ */
+static void layout_bar(struct bar *bar)
+{
+    const int padding = configuration.text_padding;
+    struct bar_segment *segment;
+    int left = 0, right = bar->reference.width;
+
+    segment = &bar->segments[BAR_SEGMENT_NUMBERS];
+    if (segment->text_width > 0) {
+        left += padding;
+        segment->x = left;
+        segment->width = segment->text_width;
+        left += segment->width;
+    } else {
+        segment->x = left;
+        segment->width = 0;
+    }
+
+    for (size_t i = bar->segments_length; i > BAR_SEGMENT_CLOCK; i--) {
+        /* the clock is the last one */
+        segment = &bar->segments[i == bar->segments_length ?
+            BAR_SEGMENT_CLOCK : i];
+        if (segment->text_width > 0) {
+            right -= padding + segment->text_width;
+            segment->x = right;
+            segment->width = segment->text_width;
+        } else {
+            segment->x = right;
+            segment->width = 0;
+        }
+    }
+
+    segment = &bar->segments[BAR_SEGMENT_TITLE];
+    left += padding;
+    segment->x = left;
+    segment->width = right - padding > left ?
+        MIN(segment->text_width, (unsigned) (right - padding - left)) : 0;
+}
+
+/* Free the colors of the bars. */
+static void free_bar_colors(void)
+{
+    if (Bar.has_colors) {
+        free_xft_color(&Bar.foreground);
+        free_xft_color(&Bar.background);
+        Bar.has_colors = false;
+    }
+}
+
+/* Allocate the colors of the bars if the configured colors changed. */
+static void update_bar_colors(void)
+{
+    if (Bar.has_colors && Bar.foreground_rgb == configuration.foreground &&
+            Bar.background_rgb == configuration.background) {
+        return;
+    }
+
+    free_bar_colors();
+    if (allocate_xft_color(configuration.foreground, &Bar.foreground) ==
+            ERROR) {
+        return;
+    }
+    if (allocate_xft_color(configuration.background, &Bar.background) ==
+            ERROR) {
+        free_xft_color(&Bar.foreground);
+        return;
+    }
+    Bar.foreground_rgb = configuration.foreground;
+    Bar.background_rgb = configuration.background;
+    Bar.has_colors = true;
+}
+
+/* Check if anything within @bar needs to be drawn. */
+static bool is_bar_dirty(const struct bar *bar)
+{
+    if (bar->is_exposed) {
+        return true;
+    }
+    for (size_t i = 0; i < bar->segments_length; i++) {
+        if (bar->segments[i].is_changed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Draw all segments of @bar that changed. */
+static void draw_bar(struct bar *bar, XftFont *font)
+{
+    XftColor *const foreground = &Bar.foreground;
+    XftColor *const background = &Bar.background;
+    XRectangle rectangle;
+
+    if (!Bar.has_colors || !is_bar_dirty(bar)) {
+        return;
+    }
+
+    if (bar->is_exposed) {
+        XftDrawRect(bar->xft_draw, background, 0, 0,
+                bar->reference.width, bar->reference.height);
+    } else {
+        /* first clear where the changed segments were */
+        for (size_t i = 0; i < bar->segments_length; i++) {
+            struct bar_segment *const segment = &bar->segments[i];
+            if (!segment->is_changed) {
+                continue;
+            }
+            XftDrawRect(bar->xft_draw, background,
+                    segment->drawn_x, 0,
+                    segment->drawn_width, bar->reference.height);
+        }
+    }
+
+    for (size_t i = 0; i < bar->segments_length; i++) {
+        struct bar_segment *const segment = &bar->segments[i];
+
+        if (!segment->is_changed && !bar->is_exposed) {
+            continue;
+        }
+
+        segment->drawn_x = segment->x;
+        segment->drawn_width = segment->width;
+        segment->is_changed = false;
+
+        if (segment->width == 0) {
+            continue;
+        }
+
+        if (!bar->is_exposed) {
+            XftDrawRect(bar->xft_draw, background,
+                    segment->x, 0, segment->width, bar->reference.height);
+        }
+
+        if (segment->rendered == NULL) {
+            segment->rendered = create_segment_text(segment->text);
+        }
+
+        /* the title might need to be cut off */
+        rectangle.x = segment->x;
+        rectangle.y = 0;
+        rectangle.width = segment->width;
+        rectangle.height = bar->reference.height;
+        XftDrawSetClipRectangles(bar->xft_draw, 0, 0, &rectangle, 1);
+        draw_text(bar->xft_draw, foreground,
+                segment->x + segment->rendered->x,
+                configuration.text_padding / 2 + font->ascent,
+                segment->rendered);
+        XftDrawSetClip(bar->xft_draw, NULL);
+    }
+
+    bar->is_exposed = false;
+}
+
+/* Update the segments of @bar on @monitor and draw the ones that changed. */
+static void update_bar(struct bar *bar, Monitor *monitor, unsigned height,
+        XftFont *font, const utf8_t *clock)
+{
+    utf8_t buffer[256];
+    const utf8_t *title = "";
+
+    /* move the bar to the top of the monitor */
+    if (bar->reference.x != monitor->x || bar->reference.y != monitor->y ||
+            bar->reference.width != monitor->width ||
+            bar->reference.height != height) {
+        configure_client(&bar->reference, monitor->x, monitor->y,
+                monitor->width, height, 0);
+        bar->is_exposed = true;
+    }
+
+    if (!bar->reference.is_mapped) {
+        map_client_raised(&bar->reference);
+    }
+
+    /* everything needs to be drawn again if the appearance changed */
+    if (bar->foreground != configuration.foreground ||
+            bar->background != configuration.background) {
+        bar->foreground = configuration.foreground;
+        bar->background = configuration.background;
+        bar->is_exposed = true;
+    }
+
+    /* the widths are all different with a different font */
+    if (bar->font != font) {
+        bar->font = font;
+        bar->is_exposed = true;
+        for (size_t i = 0; i < bar->segments_length; i++) {
+            xfree(bar->segments[i].text);
+            bar->segments[i].text = NULL;
+        }
+    }
+
+    /* make space for all segments */
+    for (size_t i = BAR_SEGMENT_COMMANDS + Bar.commands_length;
+            i < bar->segments_length;
+            i++) {
+        xfree(bar->segments[i].text);
+        /* make sure the space it occupied is cleared */
+        bar->is_exposed = true;
+    }
+    if (bar->segments_length < BAR_SEGMENT_COMMANDS + Bar.commands_length) {
+        LIST_APPEND(bar->segments, NULL,
+                BAR_SEGMENT_COMMANDS + Bar.commands_length -
+                    bar->segments_length);
+    }
+    bar->segments_length = BAR_SEGMENT_COMMANDS + Bar.commands_length;
+
+    get_numbers_text(monitor, buffer, sizeof(buffer));
+    set_segment_text(&bar->segments[BAR_SEGMENT_NUMBERS], buffer);
+
+    if (Window_focus != NULL && Window_focus->properties.name != NULL &&
+            get_monitor_containing_window(Window_focus) == monitor) {
+        title = Window_focus->properties.name;
+    }
+    set_segment_text(&bar->segments[BAR_SEGMENT_TITLE], title);
+
+    set_segment_text(&bar->segments[BAR_SEGMENT_CLOCK], clock);
+
+    for (size_t i = 0; i < Bar.commands_length; i++) {
+        set_segment_text(&bar->segments[BAR_SEGMENT_COMMANDS + i],
+                Bar.commands[i].line);
+    }
+
+    layout_bar(bar);
+
+    for (size_t i = 0; i < bar->segments_length; i++) {
+        struct bar_segment *const segment = &bar->segments[i];
+        if (segment->x != segment->drawn_x ||
+                segment->width != segment->drawn_width) {
+            segment->is_changed = true;
+        }
+    }
+
+    draw_bar(bar, font);
+
+    for (size_t i = 0; i < bar->segments_length; i++) {
+        if (bar->segments[i].rendered != NULL) {
+            destroy_text(bar->segments[i].rendered);
+            bar->segments[i].rendered = NULL;
+        }
+    }
+}
+
+/* Create, move or destroy the bar windows to match the monitors and draw the
+ * segments that changed.
+ */
+void update_bars(void)
+{
+    XftFont *font;
+    unsigned height;
+    utf8_t clock[64];
+    time_t now;
+    size_t index;
+
+    update_bar_commands();
+
+    height = get_bar_height();
+    font = get_primary_font();
+
+    if (height == 0) {
+        destroy_all_bars();
+        return;
+    }
+
+    update_bar_colors();
+
+    now = time(NULL);
+    if (strftime(clock, sizeof(clock), BAR_CLOCK_FORMAT,
+                localtime(&now)) == 0) {
+        clock[0] = '\0';
+    }
+
+    for (index = 0; index < Bar.bars_length; index++) {
+        Bar.bars[index].is_used = false;
+    }
+
+    for (Monitor *monitor = Monitor_first;
+            monitor != NULL;
+            monitor = monitor->next) {
+        struct bar *bar = NULL;
+
+        for (index = 0; index < Bar.bars_length; index++) {
+            if (strcmp(Bar.bars[index].monitor_name, monitor->name) == 0) {
+                bar = &Bar.bars[index];
+                break;
+            }
+        }
+
+        if (bar == NULL) {
+            LIST_APPEND(Bar.bars, NULL, 1);
+            bar = &Bar.bars[Bar.bars_length - 1];
+            if (initialize_bar(bar) == ERROR) {
+                Bar.bars_length--;
+                continue;
+            }
+            bar->monitor_name = xstrdup(monitor->name);
+            LOG("created bar for monitor %s\n",
+                    monitor->name);
+        }
+
+        bar->is_used = true;
+        update_bar(bar, monitor, height, font, clock);
+    }
+
+    /* remove the bars of monitors that are gone */
+    index = 0;
+    for (size_t i = 0; i < Bar.bars_length; i++) {
+        if (!Bar.bars[i].is_used) {
+            LOG("removing bar of monitor %s\n",
+                    Bar.bars[i].monitor_name);
+            destroy_bar(&Bar.bars[i]);
+            continue;
+        }
+        Bar.bars[index++] = Bar.bars[i];
+    }
+    Bar.bars_length = index;
+}
+
+/* Destroy all bar windows and stop all bar commands. */
+void free_bars(void)
+{
+    destroy_all_bars();
+    free_bar_colors();
+
+    for (size_t i = 0; i < Bar.commands_length; i++) {
+        stop_bar_command(&Bar.commands[i]);
+        xfree(Bar.commands[i].command);
+        xfree(Bar.commands[i].line);
+    }
+    LIST_CLEAR(Bar.commands);
+}
@@ -7,6 +7,9 @@
 /* the modifiers to ignore */
 static unsigned modifiers_ignore = DEFAULT_IGNORE_MODIFIERS;
 
+/* the modifiers to ignore when the bindings were marked as stale */
+static unsigned stale_modifiers_ignore;
+
 /* The mouse bindings.  The key to this map are button indexes. */
 static struct internal_button_binding {
     /* if this binding is triggered on a release */
@@ -17,6 +20,8 @@ static struct internal_button_binding {
     unsigned modifiers;
     /* the actions to execute */
     ActionBlock *actions;
+    /* if the binding was not set again since `mark_bindings_stale()` */
+    bool is_stale;
     /* another variation using the same button index */
     struct internal_button_binding *next;
 } *button_bindings[BUTTON_MAX - BUTTON_MIN];
@@ -31,6 +36,8 @@ static struct internal_key_binding {
     KeySym key_symbol;
     /* the actions to execute */
     ActionBlock *actions;
+    /* if the binding was not set again since `mark_bindings_stale()` */
+    bool is_stale;
     /* another variation using the same key code */
     struct internal_key_binding *next;
 } *key_bindings[KEYCODE_MAX - KEYCODE_MIN];
@@ -39,9 +46,15 @@ static struct internal_key_binding {
 static void grab_button(Window window, bool is_release,
         unsigned modifiers, int button);
 
+/* Ungrab a button on all windows. */
+static void ungrab_button(unsigned modifiers, int button);
+
 /* Grab a key on the root window. */
 static void grab_key(unsigned modifiers, KeyCode key_code);
 
+/* Ungrab a key on the root window. */
+static void ungrab_key(unsigned modifiers, KeyCode key_code);
+
 /* Set the modifiers to ignore. */
 inline void set_ignored_modifiers(unsigned modifiers)
 {
@@ -108,18 +121,13 @@ void set_button_binding(const struct button_binding *button_binding)
     }
 
     if (binding->actions != NULL && button_binding->actions == NULL) {
-        for (FcWindow *window = Window_first;
-                window != NULL;
-                window = window->next) {
-            XUngrabButton(display, index, modifiers, window->reference.id);
-        }
-        LOG_DEBUG("ungrabbing specific button %u+%d on all windows\n",
-                modifiers, index);
+        ungrab_button(modifiers, index);
     }
 
     /* clear any old binded actions */
     dereference_action_block(binding->actions);
 
+    binding->is_stale = false;
     binding->is_transparent = button_binding->is_transparent;
     binding->actions = button_binding->actions;
     reference_action_block(binding->actions);
@@ -147,26 +155,6 @@ void run_button_binding(Time event_time, bool is_release,
     }
 }
 
-/* Unset all configured button bindings. */
-void unset_button_bindings(void)
-{
-    struct internal_button_binding *binding;
-
-    for (int i = BUTTON_MIN; i < BUTTON_MAX; i++) {
-        binding = button_bindings[i - BUTTON_MIN];
-        for (; binding != NULL; binding = binding->next) {
-            dereference_action_block(binding->actions);
-            ZERO(&binding->actions, 1);
-        }
-    }
-
-    for (FcWindow *window = Window_first;
-            window != NULL;
-            window = window->next) {
-        XUngrabButton(display, AnyButton, AnyModifier, window->reference.id);
-    }
-}
-
 /**************************
  * Key binding management *
  **************************/
@@ -218,14 +206,13 @@ void set_key_binding(const struct key_binding *key_binding)
     if (binding->actions == NULL && key_binding->actions != NULL) {
         grab_key(modifiers, key_code);
     } else if (binding->actions != NULL && key_binding->actions == NULL) {
-        XUngrabKey(display, key_code, modifiers, DefaultRootWindow(display));
-        LOG_DEBUG("ungrabbing specific key %u+%d\n",
-                modifiers, key_code);
+        ungrab_key(modifiers, key_code);
     }
 
     /* clear any old binded actions */
     dereference_action_block(binding->actions);
 
+    binding->is_stale = false;
     binding->actions = key_binding->actions;
     reference_action_block(binding->actions);
 }
@@ -246,20 +233,143 @@ void run_key_binding(bool is_release, unsigned modifiers, KeyCode key_code)
     }
 }
 
-/* Unset all configured key bindings. */
-void unset_key_bindings(void)
+/* Mark all bindings as stale. */
+void mark_bindings_stale(void)
 {
-    struct internal_key_binding *binding;
+    struct internal_button_binding *button_binding;
+    struct internal_key_binding *key_binding;
+
+    stale_modifiers_ignore = modifiers_ignore;
+
+    for (int i = BUTTON_MIN; i < BUTTON_MAX; i++) {
+        button_binding = button_bindings[i - BUTTON_MIN];
+        for (; button_binding != NULL; button_binding = button_binding->next) {
+            button_binding->is_stale = button_binding->actions != NULL;
+        }
+    }
 
     for (int i = KEYCODE_MIN; i < KEYCODE_MAX; i++) {
-        binding = key_bindings[i - KEYCODE_MIN];
-        for (; binding != NULL; binding = binding->next) {
-            dereference_action_block(binding->actions);
-            binding->actions = NULL;
+        key_binding = key_bindings[i - KEYCODE_MIN];
+        for (; key_binding != NULL; key_binding = key_binding->next) {
+            key_binding->is_stale = key_binding->actions != NULL;
         }
     }
+}
 
-    XUngrabKey(display, AnyKey, AnyModifier, DefaultRootWindow(display));
+/* Remove the stale button bindings of @button and grab what the ungrabbing
+ * removed from the bindings that are still set.
+ */
+static void remove_stale_button_bindings(button_t button)
+{
+    struct internal_button_binding *binding, *other;
+
+    binding = button_bindings[button - BUTTON_MIN];
+    for (; binding != NULL; binding = binding->next) {
+        if (!binding->is_stale) {
+            continue;
+        }
+
+        binding->is_stale = false;
+        dereference_action_block(binding->actions);
+        binding->actions = NULL;
+
+        ungrab_button(binding->modifiers, button);
+
+        /* a press and release binding share the same grab */
+        other = button_bindings[button - BUTTON_MIN];
+        for (; other != NULL; other = other->next) {
+            if (other->modifiers == binding->modifiers &&
+                    other->actions != NULL && !other->is_stale) {
+                for (FcWindow *window = Window_first;
+                        window != NULL;
+                        window = window->next) {
+                    grab_button(window->reference.id, other->is_release,
+                            other->modifiers, button);
+                }
+            }
+        }
+    }
+}
+
+/* Remove the stale key bindings of @key_code and grab what the ungrabbing
+ * removed from the bindings that are still set.
+ */
+static void remove_stale_key_bindings(KeyCode key_code)
+{
+    struct internal_key_binding *binding, *other;
+
+    binding = key_bindings[key_code - KEYCODE_MIN];
+    for (; binding != NULL; binding = binding->next) {
+        if (!binding->is_stale) {
+            continue;
+        }
+
+        binding->is_stale = false;
+        dereference_action_block(binding->actions);
+        binding->actions = NULL;
+
+        ungrab_key(binding->modifiers, key_code);
+
+        /* a press and release binding share the same grab */
+        other = key_bindings[key_code - KEYCODE_MIN];
+        for (; other != NULL; other = other->next) {
+            if (other->modifiers == binding->modifiers &&
+                    other->actions != NULL && !other->is_stale) {
+                grab_key(other->modifiers, key_code);
+            }
+        }
+    }
+}
+
+/* Remove all bindings that are still stale. */
+void remove_stale_bindings(void)
+{
+    struct internal_button_binding *button_binding;
+    struct internal_key_binding *key_binding;
+
+    /* the grabs of all bindings include the ignored modifiers */
+    if (stale_modifiers_ignore != modifiers_ignore) {
+        for (int i = BUTTON_MIN; i < BUTTON_MAX; i++) {
+            button_binding = button_bindings[i - BUTTON_MIN];
+            for (; button_binding != NULL;
+                    button_binding = button_binding->next) {
+                if (button_binding->is_stale) {
+                    button_binding->is_stale = false;
+                    dereference_action_block(button_binding->actions);
+                    button_binding->actions = NULL;
+                }
+            }
+        }
+
+        for (int i = KEYCODE_MIN; i < KEYCODE_MAX; i++) {
+            key_binding = key_bindings[i - KEYCODE_MIN];
+            for (; key_binding != NULL; key_binding = key_binding->next) {
+                if (key_binding->is_stale) {
+                    key_binding->is_stale = false;
+                    dereference_action_block(key_binding->actions);
+                    key_binding->actions = NULL;
+                }
+            }
+        }
+
+        for (FcWindow *window = Window_first;
+                window != NULL;
+                window = window->next) {
+            grab_configured_buttons(window->reference.id);
+        }
+        grab_configured_keys();
+
+        stale_modifiers_ignore = modifiers_ignore;
+        return;
+    }
+
+    for (button_t i = BUTTON_MIN; i < BUTTON_MAX; i++) {
+        remove_stale_button_bindings(i);
+    }
+
+    for (int i = KEYCODE_MIN; i < KEYCODE_MAX; i++) {
+        remove_stale_key_bindings(i);
+    }
 }
 
 /* Resolve all key symbols in case the mapping changed. */
@@ -358,6 +468,28 @@ static void grab_button(Window window, bool is_release,
     }
 }
 
+/* Ungrab a button on all windows. */
+static void ungrab_button(unsigned modifiers, int button)
+{
+    LOG_DEBUG("ungrabbing specific button %u+%d on all windows\n",
+            modifiers, button);
+
+    for (FcWindow *window = Window_first;
+            window != NULL;
+            window = window->next) {
+        for (unsigned i = modifiers_ignore;
+                true;
+                i = ((i - 1) & modifiers_ignore)) {
+            XUngrabButton(display, button, (i | modifiers),
+                    window->reference.id);
+
+            if (i == 0) {
+                break;
+            }
+        }
+    }
+}
+
 /* Grab the button bindings for a window so we receive MousePress/MouseRelease
  * events for it.
  *
@@ -409,6 +541,24 @@ static void grab_key(unsigned modifiers, KeyCode key_code)
     }
 }
 
+/* Ungrab a key on the root window. */
+static void ungrab_key(unsigned modifiers, KeyCode key_code)
+{
+    LOG_DEBUG("ungrabbing specific key %u+%d\n",
+            modifiers, key_code);
+
+    for (unsigned i = modifiers_ignore;
+            true;
+            i = ((i - 1) & modifiers_ignore)) {
+        XUngrabKey(display, key_code, (i | modifiers),
+                DefaultRootWindow(display));
+
+        if (i == 0) {
+            break;
+        }
+    }
+}
+
 /* Grab the key bindings so we receive KeyPress/KeyRelease events for them. */
 void grab_configured_keys(void)
 {
@@ -0,0 +1,780 @@
+#include <X11/XKBlib.h>
+
+#include "chooser.h"
+#include "configuration.h"
+#include "font.h"
+#include "log.h"
+#include "monitor.h"
+#include "window.h"
+#include "x11/display.h"
+
+/* the chooser window */
+struct chooser Chooser;
+
+/* Initialize the chooser window. */
+static int initialize_chooser(void)
+{
+    XSetWindowAttributes attributes;
+
+    if (Chooser.reference.id == None) {
+        Chooser.reference.x = -1;
+        Chooser.reference.y = -1;
+        Chooser.reference.width = 1;
+        Chooser.reference.height = 1;
+        Chooser.reference.border_width = configuration.border_size;
+        Chooser.reference.border = configuration.border_color;
+        attributes.border_pixel = Chooser.reference.border;
+        attributes.backing_pixel = configuration.background;
+        attributes.event_mask = KeyPressMask | FocusChangeMask | ExposureMask;
+        /* indicate to not manage the window */
+        attributes.override_redirect = True;
+        Chooser.reference.id = XCreateWindow(display,
+                    DefaultRootWindow(display), Chooser.reference.x,
+                    Chooser.reference.y, Chooser.reference.width,
+                    Chooser.reference.height,
+                    Chooser.reference.border_width, CopyFromParent,
+                    InputOutput, (Visual*) CopyFromParent,
+                    CWBorderPixel | CWBackPixel | CWOverrideRedirect |
+                        CWEventMask,
+                    &attributes);
+
+        if (Chooser.reference.id == None) {
+            LOG_ERROR("failed creating chooser window\n");
+            return ERROR;
+        }
+    }
+
+    /* create an XftDraw object if not done already */
+    if (Chooser.xft_draw == NULL) {
+        Chooser.xft_draw = XftDrawCreate(display, Chooser.reference.id,
+                DefaultVisual(display, DefaultScreen(display)),
+                DefaultColormap(display, DefaultScreen(display)));
+
+        if (Chooser.xft_draw == NULL) {
+            LOG_ERROR("could not create drawing context for the chooser "
+                        "window\n");
+            return ERROR;
+        }
+    }
+    return OK;
+}
+
+/*********
+ * Items *
+ *********/
+
+/* Add an item to the chooser. */
+void add_chooser_item(void *data)
+{
+    ChooserItem item;
+
+    item.data = data;
+    item.matched_length = 0;
+    LIST_APPEND_VALUE(Chooser.items, item);
+}
+
+/* Release all items within @items. */
+static void release_items(ChooserItem *items, size_t number_of_items)
+{
+    if (number_of_items == 0 || Chooser.source->release == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < number_of_items; i++) {
+        Chooser.source->release(items[i].data);
+    }
+}
+
+/* Find out how much of the current search @item matches. */
+static void update_matched_length(ChooserItem *item)
+{
+    const SearchKey *key;
+    size_t length;
+
+    key = Chooser.source->get_key(item->data);
+    if (key == NULL) {
+        item->matched_length = 0;
+        return;
+    }
+
+    /* most items match all or nothing, check the entire search first */
+    length = Chooser.search_length;
+    if (does_search_match(key, Chooser.search, length,
+                get_search_trigrams(Chooser.search, length))) {
+        item->matched_length = length;
+        return;
+    }
+
+    for (length = 0; length + 1 < Chooser.search_length; length++) {
+        if (!does_search_match(key, Chooser.search, length + 1,
+                    get_search_trigrams(Chooser.search, length + 1))) {
+            break;
+        }
+    }
+    item->matched_length = length;
+}
+
+/* Put all items matching the entire search into the matches. */
+static void collect_matches(void)
+{
+    Chooser.matches_length = 0;
+    for (unsigned i = 0; i < Chooser.items_length; i++) {
+        if (Chooser.items[i].matched_length == Chooser.search_length) {
+            LIST_APPEND_VALUE(Chooser.matches, i);
+        }
+    }
+}
+
+/* Get the data of the selected item or NULL if there is none. */
+static void *get_selected_data(void)
+{
+    if (Chooser.selected >= Chooser.matches_length) {
+        return NULL;
+    }
+    return Chooser.items[Chooser.matches[Chooser.selected]].data;
+}
+
+/* Select the item with @data again after the matches changed. */
+static void select_data(void *data)
+{
+    for (unsigned i = 0; i < Chooser.matches_length; i++) {
+        if (Chooser.items[Chooser.matches[i]].data == data) {
+            Chooser.selected = i;
+            break;
+        }
+    }
+}
+
+/* Reload all items from the source and keep the selected item selected. */
+static void reload_items(void)
+{
+    ChooserItem *old_items;
+    size_t old_length;
+    void *selected;
+
+    selected = get_selected_data();
+
+    /* keep the old items until the new ones are there so that the data of the
+     * selected item stays valid
+     */
+    old_items = Chooser.items;
+    old_length = Chooser.items_length;
+    Chooser.items = NULL;
+    Chooser.items_length = 0;
+    Chooser.items_capacity = 0;
+
+    (void) Chooser.source->fill();
+
+    for (unsigned i = 0; i < Chooser.items_length; i++) {
+        update_matched_length(&Chooser.items[i]);
+    }
+    collect_matches();
+    select_data(selected);
+
+    release_items(old_items, old_length);
+    xfree(old_items);
+}
+
+/* Get the index of @id within the changed windows or -1 if it is not in
+ * there.
+ */
+static int find_changed_window(Window id)
+{
+    for (size_t i = 0; i < Chooser.changed_windows_length; i++) {
+        if (Chooser.changed_windows[i] == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Update the items of the changed windows.
+ *
+ * Items of windows that are no longer shown are removed and only the items of
+ * changed windows are matched against the search again.  When a changed window
+ * needs an item it does not have yet, all items are reloaded so they stay in
+ * the order of the source.
+ */
+static void update_changed_items(void)
+{
+    ChooserItem *item;
+    Window id;
+    int index;
+    void *selected;
+    unsigned count = 0;
+
+    selected = get_selected_data();
+
+    for (unsigned i = 0; i < Chooser.items_length; i++) {
+        item = &Chooser.items[i];
+        id = Chooser.source->get_item_window(item->data);
+        if (id == None) {
+            if (Chooser.source->release != NULL) {
+                Chooser.source->release(item->data);
+            }
+            continue;
+        }
+
+        index = find_changed_window(id);
+        if (index >= 0) {
+            update_matched_length(item);
+            /* the window has its item */
+            Chooser.changed_windows[index] = None;
+        }
+        Chooser.items[count++] = *item;
+    }
+    Chooser.items_length = count;
+
+    collect_matches();
+    select_data(selected);
+
+    for (size_t i = 0; i < Chooser.changed_windows_length; i++) {
+        id = Chooser.changed_windows[i];
+        if (id != None && Chooser.source->is_window_shown(id)) {
+            reload_items();
+            break;
+        }
+    }
+}
+
+/* Release all items and clear the search. */
+static void clear_items(void)
+{
+    release_items(Chooser.items, Chooser.items_length);
+    LIST_CLEAR(Chooser.items);
+    LIST_CLEAR(Chooser.matches);
+    LIST_CLEAR(Chooser.search);
+    LIST_CLEAR(Chooser.changed_windows);
+    Chooser.is_searching = false;
+    Chooser.selected = 0;
+    Chooser.top = 0;
+}
+
+/**********
+ * Search *
+ **********/
+
+/* Append @character to the search and narrow down the matches.
+ *
+ * Only the items that matched the search before are checked again because a
+ * longer search can never match more items.
+ */
+static void append_search_character(utf8_t character)
+{
+    const size_t old_length = Chooser.search_length;
+    uint64_t trigrams;
+    unsigned count = 0;
+
+    LIST_APPEND_VALUE(Chooser.search, get_search_character(character));
+    trigrams = get_search_trigrams(Chooser.search, Chooser.search_length);
+
+    for (unsigned i = 0; i < Chooser.matches_length; i++) {
+        ChooserItem *const item = &Chooser.items[Chooser.matches[i]];
+        const SearchKey *const key = Chooser.source->get_key(item->data);
+
+        if (item->matched_length == old_length && key != NULL &&
+                does_search_match(key, Chooser.search,
+                    Chooser.search_length, trigrams)) {
+            item->matched_length = Chooser.search_length;
+            Chooser.matches[count++] = Chooser.matches[i];
+        }
+    }
+    Chooser.matches_length = count;
+}
+
+/* Shorten the search to @length.
+ *
+ * All items matching more than @length bytes of the search also match the
+ * shorter search.  And items that did not match a part of the search, still do
+ * not match.  Therefore no item needs to be checked again.
+ */
+static void truncate_search(size_t length)
+{
+    Chooser.search_length = length;
+    for (unsigned i = 0; i < Chooser.items_length; i++) {
+        Chooser.items[i].matched_length =
+            MIN(Chooser.items[i].matched_length, length);
+    }
+    collect_matches();
+}
+
+/* Handle a key press while the user is typing a search.
+ *
+ * @return true if the key press was consumed.
+ */
+static bool handle_search_key_press(XKeyPressedEvent *event,
+        KeySym key_symbol, const char *input, int input_length)
+{
+    size_t length;
+
+    switch (key_symbol) {
+    /* stop searching and show all items again */
+    case XK_Escape:
+        Chooser.is_searching = false;
+        truncate_search(0);
+        break;
+
+    /* remove the last character (which may span multiple bytes) */
+    case XK_BackSpace:
+        length = Chooser.search_length;
+        if (length == 0) {
+            Chooser.is_searching = false;
+            break;
+        }
+        do {
+            length--;
+        } while (length > 0 && (Chooser.search[length] & 0xc0) == 0x80);
+        truncate_search(length);
+        break;
+
+    default:
+        /* control characters like Return fall through to the normal key
+         * handling
+         */
+        if ((event->state & ControlMask) || input_length <= 0 ||
+                (unsigned char) input[0] < ' ' || input[0] == '\x7f') {
+            return false;
+        }
+
+        for (int i = 0; i < input_length; i++) {
+            /* avoid leading and double spaces, they would match nothing new */
+            if (input[i] == ' ' && (Chooser.search_length == 0 ||
+                        Chooser.search[Chooser.search_length - 1] == ' ')) {
+                continue;
+            }
+            append_search_character(input[i]);
+        }
+        break;
+    }
+
+    /* select the best match */
+    Chooser.selected = 0;
+    return true;
+}
+
+/*************
+ * Rendering *
+ *************/
+
+/* Create a text object for the item at @index within the matches. */
+static Text *create_item_text(unsigned index)
+{
+    utf8_t buffer[256];
+    int length;
+    FcChar32 *glyphs;
+    int glyph_count;
+
+    length = Chooser.source->get_text(
+            Chooser.items[Chooser.matches[index]].data,
+            buffer, sizeof(buffer));
+    length = MAX(MIN(length, (int) sizeof(buffer) - 1), 0);
+    glyphs = get_glyphs(buffer, length, &glyph_count);
+    return create_text(glyphs, glyph_count);
+}
+
+/* Create a text object for the case that no item is shown. */
+static Text *create_empty_text(void)
+{
+    utf8_t buffer[256];
+    int length;
+    FcChar32 *glyphs;
+    int glyph_count;
+
+    if (Chooser.items_length > 0) {
+        length = snprintf(buffer, sizeof(buffer), "No item matches");
+    } else {
+        length = Chooser.source->get_empty_text(buffer, sizeof(buffer));
+    }
+    length = MAX(MIN(length, (int) sizeof(buffer) - 1), 0);
+    glyphs = get_glyphs(buffer, length, &glyph_count);
+    return create_text(glyphs, glyph_count);
+}
+
+/* Render the chooser.
+ *
+ * Only text objects for the visible items are created.  All items are assumed
+ * to be as high as the selected item.
+ *
+ * @return ERROR if the rendering failed, OK otherwise.
+ */
+static int render_chooser(void)
+{
+    XftColor background, foreground;
+    Monitor *monitor;
+    Text *search_text = NULL;
+    Text *selected_text;
+    int search_height = 0;
+    int row_height;
+    unsigned available_height;
+    unsigned row_count;
+    unsigned width = 0, height;
+    int y;
+
+    if (allocate_xft_color(configuration.background, &background) == ERROR) {
+        return ERROR;
+    }
+
+    if (allocate_xft_color(configuration.foreground, &foreground) == ERROR) {
+        free_xft_color(&background);
+        return ERROR;
+    }
+
+    /* get the monitor the chooser should be on */
+    monitor = get_focused_monitor();
+
+    /* show the search on top of the list */
+    if (Chooser.is_searching) {
+        utf8_t buffer[256];
+        FcChar32 *glyphs;
+        int glyph_count;
+
+        const int length = snprintf(buffer, sizeof(buffer), "/%.*s",
+                (int) Chooser.search_length, Chooser.search);
+        glyphs = get_glyphs(buffer, MIN(length, (int) sizeof(buffer) - 1),
+                &glyph_count);
+        search_text = create_text(glyphs, glyph_count);
+        width = search_text->width;
+        search_height = search_text->height;
+    }
+
+    /* if items were removed, select the last item when the selection is out of
+     * bounds
+     */
+    if (Chooser.matches_length == 0) {
+        Chooser.selected = 0;
+        selected_text = create_empty_text();
+    } else {
+        if (Chooser.selected >= Chooser.matches_length) {
+            Chooser.selected = Chooser.matches_length - 1;
+        }
+        selected_text = create_item_text(Chooser.selected);
+    }
+
+    /* figure out how many items fit onto the monitor */
+    row_height = MAX(selected_text->height, 1);
+    available_height = monitor->height - search_height -
+        configuration.text_padding / 2;
+    row_count = MAX(available_height / row_height, 1);
+    row_count = MIN(row_count, MAX(Chooser.matches_length, 1));
+
+    /* scroll so that the selected item is visible */
+    if (Chooser.selected < Chooser.top) {
+        Chooser.top = Chooser.selected;
+    } else if (Chooser.selected >= Chooser.top + row_count) {
+        Chooser.top = Chooser.selected - row_count + 1;
+    }
+    if (Chooser.top + row_count > MAX(Chooser.matches_length, 1)) {
+        Chooser.top = MAX(Chooser.matches_length, 1) - row_count;
+    }
+
+    /* put enough text items on the stack */
+    Text *texts[row_count];
+
+    for (unsigned i = 0; i < row_count; i++) {
+        if (Chooser.top + i == Chooser.selected) {
+            texts[i] = selected_text;
+        } else {
+            texts[i] = create_item_text(Chooser.top + i);
+        }
+        width = MAX(width, texts[i]->width);
+    }
+
+    width += configuration.text_padding;
+    /* only apply half padding for the top, ignore the bottom */
+    height = search_height + configuration.text_padding / 2 +
+        row_count * row_height;
+
+    width = MIN(width, monitor->width / 2);
+    height = MIN(height, monitor->height);
+
+    /* change border color of the chooser window */
+    change_client_attributes(&Chooser.reference, configuration.foreground);
+
+    /* set the list position and size so it is in the top center of the
+     * focused monitor
+     */
+    configure_client(&Chooser.reference,
+            monitor->x + (monitor->width - width) / 2 -
+                configuration.border_size, monitor->y,
+            width, height, configuration.border_size);
+
+    LOG_DEBUG("showing %u items starting from %u\n",
+            row_count, Chooser.top);
+
+    /* render the visible items */
+    y = search_height + configuration.text_padding / 2;
+    for (unsigned i = 0; i < row_count; i++) {
+        XftColor *background_pointer, *foreground_pointer;
+        int rect_y, rect_height;
+
+        Text *const text = texts[i];
+
+        /* add a little extra to the top if this is the first item */
+        if (i == 0) {
+            rect_y = search_height;
+            rect_height = row_height + configuration.text_padding / 2;
+        } else {
+            rect_y = y;
+            rect_height = row_height;
+        }
+
+        /* use normal or inverted colors */
+        if (Chooser.matches_length == 0 ||
+                Chooser.top + i != Chooser.selected) {
+            foreground_pointer = &foreground;
+            background_pointer = &background;
+        } else {
+            foreground_pointer = &background;
+            background_pointer = &foreground;
+        }
+
+        /* draw background and text */
+        XftDrawRect(Chooser.xft_draw, background_pointer,
+                0, rect_y, width, rect_height);
+        draw_text(Chooser.xft_draw, foreground_pointer,
+                configuration.text_padding / 2 + text->x,
+                y + text->y, text);
+
+        y += row_height;
+    }
+
+    if (search_text != NULL) {
+        XftDrawRect(Chooser.xft_draw, &background,
+                0, 0, width, search_height);
+        draw_text(Chooser.xft_draw, &foreground,
+                configuration.text_padding / 2 + search_text->x,
+                search_text->y, search_text);
+        destroy_text(search_text);
+    }
+
+    /* clear all text objects */
+    for (unsigned i = 0; i < row_count; i++) {
+        destroy_text(texts[i]);
+    }
+
+    free_xft_color(&foreground);
+    free_xft_color(&background);
+
+    return OK;
+}
+
+/**********
+ * Events *
+ **********/
+
+/* Handle a key press for the chooser window. */
+static void handle_key_press(XKeyPressedEvent *event)
+{
+    char input[32];
+    int input_length;
+    KeySym key_symbol;
+
+    if (event->window != Chooser.reference.id) {
+        return;
+    }
+
+    if (Chooser.is_searching) {
+        input_length = XLookupString(event, input, sizeof(input), &key_symbol,
+                NULL);
+        if (handle_search_key_press(event, key_symbol, input, input_length)) {
+            return;
+        }
+    }
+
+    key_symbol = XkbKeycodeToKeysym(display, event->keycode, 0, 0);
+    switch (key_symbol) {
+    /* start typing a search */
+    case XK_slash:
+        Chooser.is_searching = true;
+        break;
+
+    /* cancel selection */
+    case XK_q:
+    case XK_n:
+    case XK_Escape:
+        hide_chooser();
+        break;
+
+    /* confirm selection */
+    case XK_y:
+    case XK_Return: {
+        void *const selected = get_selected_data();
+        if (selected != NULL) {
+            Chooser.source->choose(selected, !!(event->state & ShiftMask));
+        }
+        hide_chooser();
+        break;
+    }
+
+    /* go to the first item */
+    case XK_Home:
+        Chooser.selected = 0;
+        break;
+
+    /* go to the last item */
+    case XK_End:
+        Chooser.selected = UINT_MAX;
+        break;
+
+    /* go to the previous item */
+    case XK_h:
+    case XK_k:
+    case XK_Left:
+    case XK_Up:
+        if (Chooser.selected > 0) {
+            Chooser.selected--;
+        }
+        break;
+
+    /* go to the next item */
+    case XK_l:
+    case XK_j:
+    case XK_Right:
+    case XK_Down:
+        Chooser.selected++;
+        break;
+    }
+}
+
+/* Remember that the window with @id changed. */
+static void add_changed_window(Window id)
+{
+    if (Chooser.source->is_window_dependent &&
+            find_changed_window(id) < 0) {
+        LIST_APPEND_VALUE(Chooser.changed_windows, id);
+    }
+    Chooser.is_dirty = true;
+}
+
+/* Handle an incoming X event for the chooser. */
+void handle_chooser_event(XEvent *event)
+{
+    if (!Chooser.reference.is_mapped) {
+        return;
+    }
+
+    switch (event->type) {
+    /* a key was pressed */
+    case KeyPress:
+        handle_key_press(&event->xkey);
+        Chooser.is_dirty = true;
+        break;
+
+    /* regain focus if it was taken away */
+    case FocusOut: {
+        XFocusOutEvent *focus;
+
+        focus = (XFocusOutEvent*) event;
+        if (focus->window != Chooser.reference.id) {
+            break;
+        }
+
+        /* the mode must be NotifyNormal and not grab */
+        if (focus->mode != NotifyNormal || focus->detail != NotifyNonlinear) {
+            break;
+        }
+
+        XSetInputFocus(display, Chooser.reference.id,
+                RevertToParent, CurrentTime);
+        break;
+    }
+
+    /* windows changed, their items might have as well */
+    case MapNotify:
+        add_changed_window(event->xmap.window);
+        break;
+
+    case UnmapNotify:
+        add_changed_window(event->xunmap.window);
+        break;
+
+    case DestroyNotify:
+        add_changed_window(event->xdestroywindow.window);
+        break;
+
+    case PropertyNotify:
+        add_changed_window(event->xproperty.window);
+        break;
+
+    /* re-render after a few chosen events */
+    case KeyRelease:
+    case ButtonPress:
+    case ButtonRelease:
+    case Expose:
+        Chooser.is_dirty = true;
+        break;
+    }
+}
+
+/* Reload and render the chooser if anything changed. */
+void update_chooser(void)
+{
+    if (!Chooser.reference.is_mapped) {
+        return;
+    }
+
+    if (Chooser.changed_windows_length > 0) {
+        update_changed_items();
+        Chooser.changed_windows_length = 0;
+        Chooser.is_dirty = true;
+    }
+
+    if (Chooser.is_dirty) {
+        render_chooser();
+        Chooser.is_dirty = false;
+    }
+}
+
+/* Show the chooser with items from @source. */
+int show_chooser(const ChooserSource *source)
+{
+    unsigned selected;
+
+    if (initialize_chooser() != OK) {
+        return ERROR;
+    }
+
+    /* if the chooser is already shown, toggle the visibity */
+    if (Chooser.reference.is_mapped) {
+        const ChooserSource *const previous_source = Chooser.source;
+
+        hide_chooser();
+        if (previous_source == source) {
+            return OK;
+        }
+    }
+
+    XStoreName(display, Chooser.reference.id, source->name);
+
+    Chooser.source = source;
+    selected = source->fill();
+    collect_matches();
+    Chooser.selected = selected;
+    Chooser.top = 0;
+    Chooser.changed_windows_length = 0;
+    Chooser.is_dirty = false;
+
+    /* do an initial rendering, this also sizes the window */
+    if (render_chooser() == ERROR) {
+        LOG_ERROR("could not render chooser\n");
+        clear_items();
+        return ERROR;
+    }
+
+    /* show the chooser window on screen */
+    map_client_raised(&Chooser.reference);
+
+    /* focus the chooser */
+    XSetInputFocus(display, Chooser.reference.id,
+            RevertToParent, CurrentTime);
+
+    Window_server_focus = NULL;
+    return OK;
+}
+
+/* Hide the chooser and release all items. */
+void hide_chooser(void)
+{
+    unmap_client(&Chooser.reference);
+    clear_items();
+}
@@ -1,6 +1,12 @@
 #include <errno.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "action.h"
+#include "bar.h"
 #include "binding.h"
 #include "configuration.h"
 #include "cursor.h"
@@ -9,11 +15,30 @@
 #include "log.h"
 #include "notification.h"
 #include "parse/alias.h"
+#include "parse/cache.h"
 #include "parse/group.h"
 #include "parse/input.h"
 #include "parse/parse.h"
 #include "window.h"
 
+/* a configuration file that is watched for changes */
+struct watched_file {
+    /* the inotify watch descriptor of the directory containing the file */
+    int watch;
+    /* the name of the file within the directory */
+    char *name;
+};
+
+/* the configuration files that are watched for changes */
+static struct {
+    /* the inotify file descriptor or -1 if there is none */
+    int inotify;
+    /* all watched files */
+    LIST(struct watched_file, files);
+} watcher = {
+    .inotify = -1,
+};
+
 /* the settings of the default configuration */
 const struct configuration default_configuration = {
     .overlap = 80,
@@ -28,6 +53,8 @@ const struct configuration default_configuration = {
 
     .text_padding = 6,
 
+    .bar = false,
+
     .border_size = 2,
     .border_color = 0xff49494d,
     .border_color_active = 0xff939388,
@@ -141,6 +168,9 @@ static const struct default_key_binding {
     /* show the interactive window list */
     { 0, XK_w, .action = ACTION_SHOW_LIST },
 
+    /* show the interactive application launcher */
+    { 0, XK_m, .action = ACTION_SHOW_LAUNCHER },
+
     /* run the terminal or xterm as fall back */
     { 0, XK_Return, ACTION_RUN, 1,
         { 0, ACTION_DATA_TYPE_INTEGER, { .string =
@@ -268,13 +298,15 @@ static void set_default_key_bindings(void)
 /* Set the current configuration to the default configuration. */
 void set_default_configuration(void)
 {
-    clear_configuration();
+    mark_configuration_stale();
 
     configuration = default_configuration;
 
     set_ignored_modifiers(DEFAULT_IGNORE_MODIFIERS);
     set_default_button_bindings();
     set_default_key_bindings();
+
+    remove_stale_configuration();
 }
 
 /* Expand given @path.
@@ -289,7 +321,7 @@ static char *expand_path(char *path)
     if (path[0] == '~' && path[1] == '/') {
         expanded = xasprintf("%s%s",
                 Fensterchef_home, &path[1]);
-        free(path);
+        xfree(path);
     } else {
         expanded = path;
     }
@@ -334,11 +366,11 @@ const char *get_configuration_file(void)
     LOG_DEBUG("trying configuration path: %s\n",
             path);
     if (is_readable(path)) {
-        free(cached_path);
+        xfree(cached_path);
         cached_path = path;
         return path;
     }
-    free(path);
+    xfree(path);
 
     xdg_config_dirs = getenv("XDG_CONFIG_DIRS");
     if (xdg_config_dirs == NULL) {
@@ -361,11 +393,11 @@ const char *get_configuration_file(void)
         LOG_DEBUG("trying configuration path: %s\n",
                 path);
         if (is_readable(path)) {
-            free(cached_path);
+            xfree(cached_path);
             cached_path = path;
             break;
         }
-        free(path);
+        xfree(path);
         path = NULL;
 
         next = colon;
@@ -374,51 +406,209 @@ const char *get_configuration_file(void)
     return path;
 }
 
-/* Clear everything that is currently loaded in the configuration. */
-void clear_configuration(void)
+/* Mark everything that is currently loaded in the configuration as stale. */
+void mark_configuration_stale(void)
 {
-    clear_cursor_cache();
-    unset_button_bindings();
-    unset_key_bindings();
+    mark_cursors_stale();
+    mark_bindings_stale();
     unset_window_relations();
+    clear_bar_commands();
+
+    reset_font();
+}
+
+/* Remove everything from the configuration that is still stale. */
+void remove_stale_configuration(void)
+{
+    remove_stale_cursors();
+    remove_stale_bindings();
+}
+
+/* Watch the directories of @files so that the configuration is reloaded when
+ * one of them changes.
+ *
+ * @return ERROR if none of the files can be watched.
+ */
+static int watch_configuration_files(const struct parse_file *files,
+        size_t number_of_files)
+{
+#ifdef __linux__
+    const char *slash, *name;
+    char *directory;
+    struct watched_file file;
+
+    /* drop all previous watches */
+    if (watcher.inotify != -1) {
+        close(watcher.inotify);
+        watcher.inotify = -1;
+    }
+    for (size_t i = 0; i < watcher.files_length; i++) {
+        xfree(watcher.files[i].name);
+    }
+    watcher.files_length = 0;
+
+    if (number_of_files == 0) {
+        return OK;
+    }
+
+    watcher.inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher.inotify == -1) {
+        LOG_ERROR("could not initialize inotify: %s\n",
+                strerror(errno));
+        return ERROR;
+    }
+
+    for (size_t i = 0; i < number_of_files; i++) {
+        slash = strrchr(files[i].path, '/');
+        if (slash == NULL) {
+            directory = xstrdup(".");
+            name = files[i].path;
+        } else {
+            directory = xstrndup(files[i].path,
+                    MAX(slash - files[i].path, 1));
+            name = &slash[1];
+        }
+
+        /* editors often write a new file and move it over the old one, that
+         * is why the directory is watched and not the file
+         */
+        file.watch = inotify_add_watch(watcher.inotify, directory,
+                IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR);
+        if (file.watch == -1) {
+            LOG_ERROR("could not watch %s: %s\n",
+                    directory, strerror(errno));
+        } else {
+            file.name = xstrdup(name);
+            LIST_APPEND_VALUE(watcher.files, file);
+        }
+        xfree(directory);
+    }
+    return watcher.files_length > 0 ? OK : ERROR;
+#else
+    (void) files;
+    (void) number_of_files;
+    return OK;
+#endif
+}
+
+/* Get the file descriptor reporting changes of the configuration files. */
+int get_configuration_file_descriptor(void)
+{
+    return watcher.inotify;
+}
+
+/* Handle the changes reported by the configuration file descriptor. */
+void handle_configuration_changes(void)
+{
+#ifdef __linux__
+    union {
+        struct inotify_event event;
+        char bytes[4096];
+    } buffer;
+    ssize_t length;
+    const struct inotify_event *event;
+    bool is_changed = false;
+
+    /* read all events first so that multiple writes cause only one reload */
+    while (length = read(watcher.inotify, &buffer, sizeof(buffer)),
+            length > 0) {
+        for (ssize_t i = 0; i < length;
+                i += sizeof(*event) + event->len) {
+            event = (const struct inotify_event*) &buffer.bytes[i];
+
+            /* events were lost, assume the worst */
+            if ((event->mask & IN_Q_OVERFLOW)) {
+                is_changed = true;
+                continue;
+            }
+
+            if (event->len == 0) {
+                continue;
+            }
+
+            for (size_t j = 0; j < watcher.files_length; j++) {
+                if (watcher.files[j].watch == event->wd &&
+                        strcmp(watcher.files[j].name, event->name) == 0) {
+                    is_changed = true;
+                    break;
+                }
+            }
+        }
+    }
 
-    set_font(DEFAULT_FONT);
+    if (is_changed) {
+        LOG("the configuration changed, reloading it\n");
+        reload_configuration();
+    }
+#endif
 }
 
 /* Reload the fensterchef configuration. */
 void reload_configuration(void)
 {
     Parser *parser = NULL;
+    ActionBlock *actions;
+    struct parse_file *files;
+    size_t number_of_files;
 
     const char *const configuration = get_configuration_file();
 
     clear_all_aliases();
     clear_all_groups();
 
-    clear_configuration();
+    mark_configuration_stale();
 
     if (error_notification != NULL) {
         unmap_client(&error_notification->reference);
     }
 
-    if (configuration == NULL ||
+    if (configuration != NULL &&
+            (actions = load_configuration_cache(configuration, &files,
+                &number_of_files), actions != NULL)) {
+        if (watch_configuration_files(files, number_of_files) == ERROR) {
+            LOG_ERROR("changes of the configuration are not noticed\n");
+        }
+        free_parse_files(files, number_of_files);
+
+        run_parsed_actions(actions);
+        dereference_action_block(actions);
+    } else if (configuration == NULL ||
             (parser = create_file_parser(configuration),
                 parser == NULL)) {
         if (configuration != NULL) {
             LOG("could not open %s: %s\n",
                     configuration, strerror(errno));
         }
+        (void) watch_configuration_files(NULL, 0);
         set_default_configuration();
-    } else if (parse_and_run_actions(parser) != OK) {
-        char buffer[1024];
+    } else {
+        actions = parse_actions(parser);
+
+        /* also watch the files of a configuration with errors so that fixing
+         * them reloads it
+         */
+        if (watch_configuration_files(parser->files, parser->files_length) ==
+                ERROR) {
+            LOG_ERROR("changes of the configuration are not noticed\n");
+        }
 
-        snprintf(buffer, sizeof(buffer),
-                "Configuration parse error at %s:%u",
-                parser->first_error_file,
-                parser->first_error_line + 1);
-        set_error_notification(buffer);
+        if (actions == NULL) {
+            char buffer[1024];
 
-        set_default_configuration();
+            snprintf(buffer, sizeof(buffer),
+                    "Configuration parse error at %s:%u",
+                    parser->first_error_file,
+                    parser->first_error_line + 1);
+            set_error_notification(buffer);
+
+            set_default_configuration();
+        } else {
+            save_configuration_cache(parser, actions);
+            run_parsed_actions(actions);
+            dereference_action_block(actions);
+        }
     }
     destroy_parser(parser);
+
+    remove_stale_configuration();
 }
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <string.h>
 
 #include <X11/Xcursor/Xcursor.h>
@@ -12,11 +13,15 @@
 static struct cursor_cache_entry {
     /* the default name for this cursor */
     const char *default_name;
+    /* the name the cursor was loaded with */
+    char *name;
     /* the X cursor */
     Cursor cursor;
+    /* if the cursor was not loaded again since `mark_cursors_stale()` */
+    bool is_stale;
 } cursor_cache[CURSOR_MAX] = {
 #define X(identifier, default_name) \
-    [CURSOR_##identifier]  = { default_name, None },
+    [CURSOR_##identifier]  = { default_name, NULL, None, false },
     DEFINE_ALL_CURSORS
 #undef X
 };
@@ -26,6 +31,13 @@ Cursor load_cursor(cursor_id_t cursor_id, const char *name)
 {
     Cursor cursor = None;
 
+    /* the same cursor is already loaded */
+    if (name != NULL && cursor_cache[cursor_id].cursor != None &&
+            strcmp(cursor_cache[cursor_id].name, name) == 0) {
+        cursor_cache[cursor_id].is_stale = false;
+        return cursor_cache[cursor_id].cursor;
+    }
+
     /* if the cursor is not cached yet */
     if (cursor_cache[cursor_id].cursor == None || name != NULL) {
         if (name == NULL) {
@@ -48,7 +60,10 @@ Cursor load_cursor(cursor_id_t cursor_id, const char *name)
             if (cursor_cache[cursor_id].cursor != None) {
                 XFreeCursor(display, cursor_cache[cursor_id].cursor);
             }
+            xfree(cursor_cache[cursor_id].name);
+            cursor_cache[cursor_id].name = xstrdup(name);
             cursor_cache[cursor_id].cursor = cursor;
+            cursor_cache[cursor_id].is_stale = false;
         }
     } else {
         cursor = cursor_cache[cursor_id].cursor;
@@ -57,13 +72,33 @@ Cursor load_cursor(cursor_id_t cursor_id, const char *name)
     return cursor;
 }
 
-/* Clear all cursors within the cursor cache. */
-void clear_cursor_cache(void)
+/* Mark all cursors as stale. */
+void mark_cursors_stale(void)
+{
+    for (cursor_id_t i = 0; i < CURSOR_MAX; i++) {
+        cursor_cache[i].is_stale = true;
+    }
+}
+
+/* Free all cursors that are still stale and not the default cursor. */
+void remove_stale_cursors(void)
 {
     for (cursor_id_t i = 0; i < CURSOR_MAX; i++) {
-        if (cursor_cache[i].cursor != None) {
-            XFreeCursor(display, cursor_cache[i].cursor);
-            cursor_cache[i].cursor = None;
+        if (!cursor_cache[i].is_stale) {
+            continue;
         }
+        cursor_cache[i].is_stale = false;
+
+        /* the default cursor would be loaded again anyway */
+        if (cursor_cache[i].cursor == None ||
+                strcmp(cursor_cache[i].name,
+                    cursor_cache[i].default_name) == 0) {
+            continue;
+        }
+
+        XFreeCursor(display, cursor_cache[i].cursor);
+        cursor_cache[i].cursor = None;
+        xfree(cursor_cache[i].name);
+        cursor_cache[i].name = NULL;
     }
 }
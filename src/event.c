@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200809L /* sigaction() */
+
 #include <errno.h>
 #include <signal.h>
 #include <string.h>
@@ -7,18 +9,28 @@
 #include <X11/XKBlib.h>
 #include <X11/extensions/Xrandr.h>
 
+#include "bar.h"
 #include "binding.h"
+#include "chooser.h"
+#include "configuration.h"
 #include "event.h"
 #include "fensterchef.h"
+#include "flight_recorder.h"
 #include "frame.h"
+#include "ipc.h"
+#include "launcher.h"
 #include "log.h"
 #include "notification.h"
+#include "statistics.h"
+#include "trace.h"
 #include "window.h"
-#include "window_list.h"
 #include "x11/display.h"
 #include "x11/ewmh.h"
 #include "x11/move_resize.h"
 
+/* the number of seconds writing a crash report may take */
+#define CRASH_REPORT_TIMEOUT 5
+
 /* signals whether the alarm signal was received */
 volatile sig_atomic_t has_timer_expired;
 
@@ -30,10 +42,35 @@ static void alarm_handler(int signal_number)
     signal(signal_number, alarm_handler);
 }
 
-/* Create a signal handler for `SIGALRM`. */
+/* Write a crash report and let the signal do what it would normally do.
+ *
+ * The handler was reset to the default when it was entered so raising the
+ * signal again terminates.
+ */
+static void crash_handler(int signal_number)
+{
+    /* if writing the report hangs, the default alarm action terminates */
+    signal(SIGALRM, SIG_DFL);
+    alarm(CRASH_REPORT_TIMEOUT);
+
+    write_crash_report(signal_number == SIGSEGV ? "segmentation fault" :
+            "abort");
+    raise(signal_number);
+}
+
+/* Create a signal handler for `SIGALRM` and the crash signals. */
 void initialize_signal_handlers(void)
 {
+    struct sigaction action;
+
     signal(SIGALRM, alarm_handler);
+
+    ZERO(&action, 1);
+    action.sa_handler = crash_handler;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, NULL);
+    sigaction(SIGABRT, &action, NULL);
 }
 
 
@@ -41,18 +78,64 @@ void initialize_signal_handlers(void)
  * arrives.  When a signal is received, `select()` will however also unblock and
  * return -1.
  *
+ * This also waits for changes of the application directories, the configuration
+ * files and the output of the bar commands and handles them.  When the bar is
+ * shown, this returns 0 when the clock of the bar needs to change.
+ *
  * @return -1 if a signal disrupted the waiting.
  */
 static int wait_for_file_descriptor(void)
 {
-    int file_descriptor;
-    fd_set set;
+    int file_descriptor, launcher_file_descriptor, bar_file_descriptor;
+    int configuration_file_descriptor, ipc_file_descriptor;
+    fd_set set, write_set;
+    int bar_timeout;
+    struct timeval timeout;
+    int result;
 
     FD_ZERO(&set);
     file_descriptor = ConnectionNumber(display);
     FD_SET(file_descriptor, &set);
 
-    return select(file_descriptor + 1, &set, NULL, NULL, NULL);
+    launcher_file_descriptor = get_launcher_file_descriptor();
+    if (launcher_file_descriptor >= 0) {
+        FD_SET(launcher_file_descriptor, &set);
+    }
+
+    configuration_file_descriptor = get_configuration_file_descriptor();
+    if (configuration_file_descriptor >= 0) {
+        FD_SET(configuration_file_descriptor, &set);
+    }
+
+    bar_file_descriptor = set_bar_file_descriptors(&set);
+
+    FD_ZERO(&write_set);
+    ipc_file_descriptor = set_ipc_file_descriptors(&set, &write_set);
+
+    /* wake up when the clock of the bar changes */
+    bar_timeout = get_bar_timeout();
+    timeout.tv_sec = bar_timeout;
+    timeout.tv_usec = 0;
+
+    result = select(MAX(MAX(MAX(file_descriptor, launcher_file_descriptor),
+                    MAX(configuration_file_descriptor, bar_file_descriptor)),
+                ipc_file_descriptor) + 1,
+            &set, &write_set, NULL,
+            bar_timeout < 0 ? NULL : &timeout);
+
+    if (result > 0 && launcher_file_descriptor >= 0 &&
+            FD_ISSET(launcher_file_descriptor, &set)) {
+        handle_launcher_changes();
+    }
+    if (result > 0 && configuration_file_descriptor >= 0 &&
+            FD_ISSET(configuration_file_descriptor, &set)) {
+        handle_configuration_changes();
+    }
+    if (result > 0) {
+        handle_bar_file_descriptors(&set);
+        handle_ipc_file_descriptors(&set, &write_set);
+    }
+    return result;
 }
 
 /* Run the next cycle of the event loop. */
@@ -61,6 +144,8 @@ int next_cycle(void)
     FcWindow *old_focus_window;
     Frame *old_focus_frame;
     XEvent event;
+    const char *name;
+    uint64_t start;
 
     /* signal to stop running */
     if (!Fensterchef_is_running) {
@@ -86,12 +171,24 @@ int next_cycle(void)
         /* handle all received events */
         while (XPending(display)) {
             XNextEvent(display, &event);
+            record_event(&event);
 
-            handle_window_list_event(&event);
+            name = event_to_string(event.type);
+            begin_trace_span("event", name == NULL ? "extension" : name);
+            start = get_statistics_time();
+            handle_chooser_event(&event);
             handle_notification_event(&event);
+            handle_bar_event(&event);
             handle_event(&event);
+            count_event(event.type, start);
+            end_trace_span();
         }
 
+        /* reflect changes to the windows in the chooser */
+        begin_trace_span("cycle", "update chooser");
+        update_chooser();
+        end_trace_span();
+
         synchronize_with_server();
 
         /* show the current frame indicator if needed */
@@ -113,6 +210,9 @@ int next_cycle(void)
         }
     }
 
+    /* reflect changes of the windows, command outputs and time in the bar */
+    update_bars();
+
     if (has_timer_expired && system_notification != NULL) {
         unmap_client(&system_notification->reference);
         has_timer_expired = false;
@@ -129,6 +229,7 @@ int next_cycle(void)
     /* flush after every series of events so all changes are reflected */
     XFlush(display);
 
+    end_statistics_cycle();
     return OK;
 }
 
@@ -1,10 +1,23 @@
+#include <errno.h>
 #include <inttypes.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 #include <X11/Xatom.h>
 
+#include "bar.h"
+#include "fensterchef.h"
 #include "font.h"
 #include "frame.h"
+#include "ipc.h"
 #include "log.h"
+#include "statistics.h"
 #include "window.h"
 #include "x11/display.h"
 
@@ -17,9 +30,42 @@ char *Fensterchef_configuration;
 /* true while the window manager is running */
 bool Fensterchef_is_running;
 
-/* Spawn a window that has the `FENSTERCHEF_COMMAND` property. */
+/* Get the path of the file @name within the fensterchef cache directory. */
+char *get_cache_file(const char *name)
+{
+    const char *xdg_cache_home;
+    char *path;
+    char *slash;
+
+    xdg_cache_home = getenv("XDG_CACHE_HOME");
+    if (xdg_cache_home == NULL || xdg_cache_home[0] == '\0') {
+        path = xasprintf("%s/.cache/" FENSTERCHEF_NAME "/%s",
+                Fensterchef_home, name);
+    } else {
+        path = xasprintf("%s/" FENSTERCHEF_NAME "/%s", xdg_cache_home, name);
+    }
+
+    /* make sure all directories leading up to the file exist */
+    for (slash = strchr(&path[1], '/'); slash != NULL;
+            slash = strchr(&slash[1], '/')) {
+        slash[0] = '\0';
+        if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+            LOG_ERROR("could not create cache directory %s: %s\n",
+                    path, strerror(errno));
+            xfree(path);
+            return NULL;
+        }
+        slash[0] = '/';
+    }
+    return path;
+}
+
+/* Send @command to the running fensterchef over its socket or spawn a window
+ * that has the `FENSTERCHEF_COMMAND` property.
+ */
 void run_external_command(const char *command)
 {
+    bool is_success;
     Display *display;
 
     XSetWindowAttributes attributes;
@@ -29,6 +75,15 @@ void run_external_command(const char *command)
 
     XEvent event;
 
+    if (send_ipc_command(command, &is_success) == OK) {
+        if (!is_success) {
+            fprintf(stderr, "fensterchef command: the command failed, "
+                        "see the log for details\n");
+        }
+        exit(is_success ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    /* fall back to the window for a fensterchef without socket */
     display = XOpenDisplay(NULL);
     if (display == NULL) {
         fprintf(stderr, "fensterchef command: "
@@ -74,12 +129,26 @@ void run_external_command(const char *command)
 void quit_fensterchef(int exit_code)
 {
     LOG("quitting fensterchef with exit code: %d\n", exit_code);
+    stop_ipc_server();
     /* when debugging, this avoids ugly messages from the sanitizer */
+    free_bars();
     free_font_list();
     XCloseDisplay(display);
     exit(exit_code);
 }
 
+#ifdef ALLOCATION_ACCOUNTING
+/* the state at the last memory dump to tell the allocation rate */
+static struct {
+    /* when the dump was made, 0 if there was none */
+    time_t time;
+    /* the number of allocations at that time */
+    size_t allocation_count;
+    /* the number of allocations of each site at that time */
+    size_t site_allocation_counts[MAX_ALLOCATION_SITES + 1];
+} last_memory_dump;
+#endif
+
 /* Dump a frame into a file. */
 static void dump_frame(Frame *frame, unsigned indentation, FILE *file)
 {
@@ -109,16 +178,9 @@ static void dump_frame(Frame *frame, unsigned indentation, FILE *file)
     }
 }
 
-/* Output the frames and windows into a file as textual output. */
-int dump_frames_and_windows(const char *file_path)
+/* Write the frames and windows into @file as textual output. */
+void write_frames_and_windows(FILE *file)
 {
-    FILE *file;
-
-    file = fopen(file_path, "w");
-    if (file == NULL) {
-        return ERROR;
-    }
-
     fputs("[Global]:\n", file);
     fprintf(file, "%p %p\n",
             (void*) Frame_focus, (void*) Window_focus);
@@ -215,6 +277,167 @@ int dump_frames_and_windows(const char *file_path)
                 (void*) window->next);
     }
 
+    /* objects that are still used but no longer in any list are kept alive by
+     * a reference
+     */
+    fputs("[Pools]:\n", file);
+    print_object_pool(&Window_pool, file);
+    print_object_pool(&Frame_pool, file);
+}
+
+/* Output the frames and windows into a file as textual output. */
+int dump_frames_and_windows(const char *file_path)
+{
+    FILE *file;
+
+    file = fopen(file_path, "w");
+    if (file == NULL) {
+        return ERROR;
+    }
+    write_frames_and_windows(file);
+    fclose(file);
+    return OK;
+}
+
+/* Print the number of bytes the heap has in use into @file. */
+static void print_heap_usage(FILE *file)
+{
+#if defined(__GLIBC__) && \
+        (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info;
+
+    info = mallinfo2();
+    fprintf(file, "%zu bytes in use\n",
+            info.uordblks + info.hblkhd);
+#else
+    /* there is no portable way to ask the allocator */
+    (void) file;
+#endif
+}
+
+/* Output the lines within the log ring into a file. */
+int dump_log_ring(const char *file_path)
+{
+    FILE *file;
+
+    file = fopen(file_path, "w");
+    if (file == NULL) {
+        return ERROR;
+    }
+    write_log_ring(file);
+    fclose(file);
+    return OK;
+}
+
+#ifdef ALLOCATION_ACCOUNTING
+/* Compare two allocation sites so that the one with more live bytes comes
+ * first.
+ */
+static int compare_allocation_sites(const void *a, const void *b)
+{
+    const struct allocation_site *const site_a =
+        *(const struct allocation_site**) a;
+    const struct allocation_site *const site_b =
+        *(const struct allocation_site**) b;
+
+    return site_a->live_bytes < site_b->live_bytes ? 1 :
+        site_a->live_bytes > site_b->live_bytes ? -1 : 0;
+}
+
+/* Print the allocations of each source file into @file. */
+static void print_allocation_sites(FILE *file)
+{
+    const struct allocation_site *sites;
+    const struct allocation_site *sorted_sites[MAX_ALLOCATION_SITES + 1];
+    size_t number_of_sites;
+    size_t allocation_count;
+    size_t index;
+    time_t current_time;
+
+    allocation_count = get_allocation_count();
+    current_time = time(NULL);
+    fprintf(file, "%zu allocations",
+            allocation_count);
+    if (last_memory_dump.time != 0) {
+        fprintf(file, ", %zu in %lld seconds since the last dump",
+                allocation_count - last_memory_dump.allocation_count,
+                (long long) (current_time - last_memory_dump.time));
+    }
+    fputc('\n', file);
+
+    sites = get_allocation_sites(&number_of_sites);
+    for (size_t i = 0; i < number_of_sites; i++) {
+        sorted_sites[i] = &sites[i];
+    }
+    SORT(sorted_sites, number_of_sites, compare_allocation_sites);
+    for (size_t i = 0; i < number_of_sites; i++) {
+        if (sorted_sites[i]->allocation_count == 0) {
+            continue;
+        }
+        index = sorted_sites[i] - sites;
+        fprintf(file, "%s: %zu allocations, %zu live bytes, %zu peak bytes",
+                sorted_sites[i]->file, sorted_sites[i]->allocation_count,
+                sorted_sites[i]->live_bytes, sorted_sites[i]->peak_bytes);
+        if (last_memory_dump.time != 0) {
+            fprintf(file, ", %zu since the last dump",
+                    sorted_sites[i]->allocation_count -
+                        last_memory_dump.site_allocation_counts[index]);
+        }
+        fputc('\n', file);
+        last_memory_dump.site_allocation_counts[index] =
+            sorted_sites[i]->allocation_count;
+    }
+
+    last_memory_dump.time = current_time;
+    last_memory_dump.allocation_count = allocation_count;
+}
+#endif
+
+/* Output statistics about the used memory into a file as textual output. */
+int dump_memory(const char *file_path)
+{
+    FILE *file;
+    struct rusage usage;
+
+    file = fopen(file_path, "w");
+    if (file == NULL) {
+        return ERROR;
+    }
+
+    fputs("[Heap]:\n", file);
+    print_heap_usage(file);
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        fprintf(file, "%ld KiB peak resident\n",
+                usage.ru_maxrss);
+    }
+
+    fputs("[Allocations]:\n", file);
+#ifdef ALLOCATION_ACCOUNTING
+    print_allocation_sites(file);
+#else
+    fputs("not counted, build with ALLOCATION_ACCOUNTING defined\n", file);
+#endif
+
+    fputs("[Pools]:\n", file);
+    print_object_pool(&Window_pool, file);
+    print_object_pool(&Frame_pool, file);
+
+    fclose(file);
+    return OK;
+}
+
+/* Output the event, action and round-trip statistics into a file. */
+int dump_statistics(const char *file_path)
+{
+    FILE *file;
+
+    file = fopen(file_path, "w");
+    if (file == NULL) {
+        return ERROR;
+    }
+
+    write_statistics(file);
+
     fclose(file);
     return OK;
 }
@@ -0,0 +1,498 @@
+#define _POSIX_C_SOURCE 200809L /* O_CLOEXEC */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fensterchef.h"
+#include "flight_recorder.h"
+#include "frame.h"
+#include "log.h"
+#include "log_writer.h"
+#include "monitor.h"
+#include "window.h"
+
+/* the maximum length of a string argument of an action that is remembered */
+#define RECORDED_STRING_LENGTH 63
+
+/* an event or action within the flight recorder */
+struct flight_entry {
+    /* when the event was received or the action was done */
+    time_t time;
+    /* if this is an action and not an event */
+    bool is_action;
+    union {
+        /* the received event */
+        XEvent event;
+        /* the done action */
+        struct {
+            /* the action type */
+            action_type_t type;
+            /* the type of the first data point or `ACTION_DATA_TYPE_MAX` */
+            action_data_type_t data_type;
+            /* the value of the first data point */
+            action_integer_t integer;
+            char string[RECORDED_STRING_LENGTH + 1];
+        } action;
+    } u;
+};
+
+/* the last events and actions */
+static struct {
+    /* the entries in a ring */
+    struct flight_entry entries[FLIGHT_RECORDER_SIZE];
+    /* the number of entries ever recorded, the next entry goes to this number
+     * modulo the size
+     */
+    size_t count;
+    /* if the crash report was written */
+    volatile sig_atomic_t has_crashed;
+} flight_recorder;
+
+/* The crash report is written from a signal handler where only async-signal
+ * safe functions may be used.  That excludes stdio, so everything is formatted
+ * by hand into `buffer` and written out with `write()`.
+ */
+static struct {
+    /* the file the report goes into, opened ahead of time */
+    int file_descriptor;
+    /* the path of the opened file or empty if the log output is used */
+    char path[1024];
+    /* the formatted output that is not yet written */
+    char buffer[4096];
+    /* the number of bytes within `buffer` */
+    size_t length;
+} crash_output = { .file_descriptor = STDERR_FILENO };
+
+/* Get the next entry to fill within the flight recorder. */
+static struct flight_entry *get_next_flight_entry(void)
+{
+    struct flight_entry *entry;
+
+    entry = &flight_recorder.entries[
+        flight_recorder.count % FLIGHT_RECORDER_SIZE];
+    flight_recorder.count++;
+    entry->time = time(NULL);
+    return entry;
+}
+
+/* Remember that @event was received. */
+void record_event(const XEvent *event)
+{
+    struct flight_entry *entry;
+
+    entry = get_next_flight_entry();
+    entry->is_action = false;
+    entry->u.event = *event;
+}
+
+/* Check if the action @type has any data. */
+static bool has_action_data(action_type_t type)
+{
+    const char *string;
+
+    /* data is a single upper case character within the action string */
+    for (string = get_action_string(type); string[0] != '\0'; string++) {
+        if ((string[1] == ' ' || string[1] == '\0') &&
+                (string == get_action_string(type) || string[-1] == ' ') &&
+                get_action_data_type_from_identifier(string[0]) !=
+                    ACTION_DATA_TYPE_MAX) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Remember that the action @type was done with @data. */
+void record_action(action_type_t type, const struct action_data *data)
+{
+    struct flight_entry *entry;
+
+    entry = get_next_flight_entry();
+    entry->is_action = true;
+    entry->u.action.type = type;
+    entry->u.action.data_type = ACTION_DATA_TYPE_MAX;
+    if (!has_action_data(type)) {
+        return;
+    }
+
+    entry->u.action.data_type = data->type;
+    switch (data->type) {
+    case ACTION_DATA_TYPE_INTEGER:
+        entry->u.action.integer = data->u.integer;
+        break;
+
+    case ACTION_DATA_TYPE_STRING:
+        strncpy(entry->u.action.string, data->u.string,
+                RECORDED_STRING_LENGTH);
+        entry->u.action.string[RECORDED_STRING_LENGTH] = '\0';
+        break;
+
+    /* only the type is remembered for anything else */
+    default:
+        break;
+    }
+}
+
+/* Write out everything within the crash output buffer. */
+static void flush_crash_output(void)
+{
+    ssize_t count;
+
+    for (size_t i = 0; i < crash_output.length; i += count) {
+        count = write(crash_output.file_descriptor, &crash_output.buffer[i],
+                crash_output.length - i);
+        if (count <= 0) {
+            break;
+        }
+    }
+    crash_output.length = 0;
+}
+
+/* Put @length bytes of @string into the crash output. */
+static void put_bytes(const char *string, size_t length)
+{
+    size_t count;
+
+    while (length > 0) {
+        if (crash_output.length == sizeof(crash_output.buffer)) {
+            flush_crash_output();
+        }
+        count = MIN(length, sizeof(crash_output.buffer) - crash_output.length);
+        memcpy(&crash_output.buffer[crash_output.length], string, count);
+        crash_output.length += count;
+        string += count;
+        length -= count;
+    }
+}
+
+/* Put @string into the crash output, NULL is put as `(null)`. */
+static void put_string(const char *string)
+{
+    if (string == NULL) {
+        string = "(null)";
+    }
+    put_bytes(string, strlen(string));
+}
+
+/* Put @number in given @base into the crash output, padded with zeroes to
+ * at least @width digits.
+ */
+static void put_number(uintmax_t number, unsigned base, unsigned width)
+{
+    char digits[sizeof(number) * 8];
+    size_t index = sizeof(digits);
+
+    do {
+        digits[--index] = "0123456789abcdef"[number % base];
+        number /= base;
+    } while (number > 0 || sizeof(digits) - index < width);
+    put_bytes(&digits[index], sizeof(digits) - index);
+}
+
+/* Put the signed @number into the crash output. */
+static void put_integer(intmax_t number)
+{
+    if (number < 0) {
+        put_bytes("-", 1);
+        put_number(-(uintmax_t) number, 10, 1);
+    } else {
+        put_number(number, 10, 1);
+    }
+}
+
+/* Put @pointer as hexadecimal number into the crash output. */
+static void put_pointer(const void *pointer)
+{
+    put_bytes("0x", 2);
+    put_number((uintptr_t) pointer, 16, 1);
+}
+
+/* Put @time as UTC date into the crash output.
+ *
+ * `localtime()` is not async-signal-safe, the civil date is computed by hand.
+ */
+static void put_time(time_t time)
+{
+    intmax_t days, era, year;
+    unsigned day_of_era, year_of_era, day_of_year, month_index;
+    unsigned seconds;
+
+    days = time / 86400;
+    seconds = time % 86400;
+    if (time < 0 && seconds != 0) {
+        days--;
+        seconds += 86400;
+    }
+
+    /* convert the days since 1970-01-01 into a date, years start in March */
+    days += 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    day_of_era = days - era * 146097;
+    year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+            day_of_era / 146096) / 365;
+    day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 -
+            year_of_era / 100);
+    month_index = (5 * day_of_year + 2) / 153;
+    year = year_of_era + era * 400 + (month_index >= 10);
+
+    put_bytes("[", 1);
+    put_integer(year);
+    put_bytes("-", 1);
+    put_number(month_index < 10 ? month_index + 3 : month_index - 9, 10, 2);
+    put_bytes("-", 1);
+    put_number(day_of_year - (153 * month_index + 2) / 5 + 1, 10, 2);
+    put_bytes(" ", 1);
+    put_number(seconds / 3600, 10, 2);
+    put_bytes(":", 1);
+    put_number(seconds / 60 % 60, 10, 2);
+    put_bytes(":", 1);
+    put_number(seconds % 60, 10, 2);
+    put_bytes("] ", 2);
+}
+
+/* Put the recorded @event into the crash output.
+ *
+ * Only the type and window are written because formatting the full event
+ * might need requests to the X server.
+ */
+static void put_recorded_event(const XEvent *event)
+{
+    if (event_to_string(event->type) == NULL) {
+        put_string("UNKNOWN_EVENT(");
+        put_integer(event->type);
+        put_string(")");
+    } else {
+        put_string(event_to_string(event->type));
+    }
+    put_string(" window 0x");
+    put_number(event->xany.window, 16, 1);
+    put_string("\n");
+}
+
+/* Put the recorded action @entry into the crash output. */
+static void put_recorded_action(const struct flight_entry *entry)
+{
+    put_string("action ");
+    put_string(get_action_string(entry->u.action.type));
+    switch (entry->u.action.data_type) {
+    case ACTION_DATA_TYPE_INTEGER:
+        put_string(" (");
+        put_integer(entry->u.action.integer);
+        put_string(")");
+        break;
+
+    case ACTION_DATA_TYPE_STRING:
+        put_string(" (");
+        put_string(entry->u.action.string);
+        put_string(")");
+        break;
+
+    default:
+        break;
+    }
+    put_string("\n");
+}
+
+/* Put all recorded events and actions into the crash output. */
+static void put_flight_recorder(void)
+{
+    const struct flight_entry *entry;
+    size_t start;
+
+    start = flight_recorder.count > FLIGHT_RECORDER_SIZE ?
+        flight_recorder.count - FLIGHT_RECORDER_SIZE : 0;
+    for (size_t i = start; i < flight_recorder.count; i++) {
+        entry = &flight_recorder.entries[i % FLIGHT_RECORDER_SIZE];
+        put_time(entry->time);
+        if (entry->is_action) {
+            put_recorded_action(entry);
+        } else {
+            put_recorded_event(&entry->u.event);
+        }
+    }
+}
+
+/* Write all recorded events and actions into @file_descriptor. */
+void write_flight_recorder(int file_descriptor)
+{
+    const int previous_file_descriptor = crash_output.file_descriptor;
+
+    crash_output.file_descriptor = file_descriptor;
+    put_flight_recorder();
+    flush_crash_output();
+    crash_output.file_descriptor = previous_file_descriptor;
+}
+
+/* Put a log line of the log ring into the crash output. */
+static void put_log_ring_line(time_t time, const char *format)
+{
+    size_t length;
+
+    put_time(time);
+    /* the arguments are not formatted, only the call site is told */
+    length = strlen(format);
+    if (length > 0 && format[length - 1] == '\n') {
+        length--;
+    }
+    put_bytes(format, length);
+    put_string("\n");
+}
+
+/* Put @frame and its children into the crash output. */
+static void put_frame(const Frame *frame, unsigned indentation)
+{
+    for (unsigned i = 0; i < indentation; i++) {
+        put_string("  ");
+    }
+    put_pointer(frame);
+    put_string(" ");
+    put_integer(frame->number);
+    put_string(" ");
+    put_integer(frame->x);
+    put_string(" ");
+    put_integer(frame->y);
+    put_string(" ");
+    put_integer(frame->width);
+    put_string(" ");
+    put_integer(frame->height);
+    put_string(" ");
+    put_pointer(frame->window);
+    put_string(frame->split_direction == FRAME_SPLIT_HORIZONTALLY ?
+            " H\n" : " V\n");
+    if (frame->left != NULL) {
+        put_frame(frame->left, indentation + 1);
+        put_frame(frame->right, indentation + 1);
+    }
+}
+
+/* Put the frames and windows into the crash output. */
+static void put_frames_and_windows(void)
+{
+    put_string("[Global]:\n");
+    put_pointer(Frame_focus);
+    put_string(" ");
+    put_pointer(Window_focus);
+    put_string("\n");
+
+    put_string("[Frames]:\n");
+    for (const Monitor *monitor = Monitor_first;
+            monitor != NULL;
+            monitor = monitor->next) {
+        put_string(monitor->name);
+        put_string("\n");
+        put_frame(monitor->frame, 0);
+    }
+
+    put_string("[Stash]:\n");
+    for (const Frame *frame = Frame_last_stashed;
+            frame != NULL;
+            frame = frame->previous_stashed) {
+        put_frame(frame, 0);
+    }
+
+    put_string("[Windows]:\n");
+    for (const FcWindow *window = Window_first;
+            window != NULL;
+            window = window->next) {
+        put_pointer(window);
+        put_string(" 0x");
+        put_number(window->reference.id, 16, 1);
+        put_string(" ");
+        put_integer(window->number);
+        put_string(window->state.is_visible ? " V " : " I ");
+        put_string(window->properties.name);
+        put_string("\n");
+    }
+}
+
+/* Remove the crash report file again if nothing was written into it. */
+static void remove_unused_crash_report(void)
+{
+    if (flight_recorder.has_crashed || crash_output.path[0] == '\0') {
+        return;
+    }
+    close(crash_output.file_descriptor);
+    unlink(crash_output.path);
+}
+
+/* Open the file the crash report goes into. */
+void prepare_crash_report(void)
+{
+    static bool is_exit_handler_set;
+
+    size_t length;
+    int file_descriptor;
+
+    /* put the report next to the log file */
+    if (log_file_path == NULL || log_file_path[0] != '/' ||
+            crash_output.path[0] != '\0') {
+        return;
+    }
+
+    length = strlen(log_file_path);
+    if (length > 4 && strcmp(&log_file_path[length - 4], ".log") == 0) {
+        length -= 4;
+    }
+    if (length + sizeof(".crash") > sizeof(crash_output.path)) {
+        return;
+    }
+
+    memcpy(crash_output.path, log_file_path, length);
+    memcpy(&crash_output.path[length], ".crash", sizeof(".crash"));
+    file_descriptor = open(crash_output.path,
+            O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file_descriptor == -1) {
+        LOG_ERROR("could not open %s: %s\n",
+                crash_output.path, strerror(errno));
+        crash_output.path[0] = '\0';
+        return;
+    }
+    crash_output.file_descriptor = file_descriptor;
+
+    if (!is_exit_handler_set) {
+        atexit(remove_unused_crash_report);
+        is_exit_handler_set = true;
+    }
+}
+
+/* Write a crash report for given @reason. */
+void write_crash_report(const char *reason)
+{
+    if (flight_recorder.has_crashed) {
+        return;
+    }
+    flight_recorder.has_crashed = true;
+
+    put_string("[Crash]:\n");
+    put_string(reason);
+    put_string("\n");
+
+    put_string("[Flight recorder]:\n");
+    put_flight_recorder();
+
+    if (is_log_ring_used()) {
+        put_string("[Log]:\n");
+        walk_log_ring(put_log_ring_line);
+    }
+
+    put_frames_and_windows();
+    flush_crash_output();
+
+    if (crash_output.path[0] != '\0') {
+        crash_output.file_descriptor = STDERR_FILENO;
+        put_string("wrote crash report to ");
+        put_string(crash_output.path);
+        put_string("\n");
+        flush_crash_output();
+    }
+
+    /* give the writer thread the chance to write out the lines logged before
+     * the crash, they are lost when the process dies
+     */
+    flush_log_writer();
+}
@@ -1,14 +1,30 @@
+#include <errno.h>
 #include <inttypes.h>
+#include <string.h>
+#include <sys/stat.h>
 
 #include "configuration.h"
+#include "fensterchef.h"
 #include "font.h"
 #include "log.h"
+#include "trace.h"
+#include "utility/utf8.h"
 #include "utility/utility.h"
 #include "x11/display.h"
 
+/* the first line of the font cache file, changing the format requires a new
+ * version
+ */
+#define FONT_CACHE_HEADER "fensterchef fonts 1\n"
+
+/* the maximum number of font names remembered in the font cache file */
+#define FONT_CACHE_MAXIMUM_ENTRIES 8
+
 /* a list of known fonts */
 struct font {
-    /* the pattern of the font */
+    /* the pattern of the font, this is only prepared for rendering when the
+     * font is opened
+     */
     FcPattern *pattern;
     /* the loaded font object, may be NULL to indicate it was not loaded yet */
     XftFont *font;
@@ -16,7 +32,19 @@ struct font {
 
 /* list of the currently used fonts */
 static struct font_list {
-    /* all fonts within the font list */
+    /* the font name set by the user */
+    char *name;
+    /* the font name the font list was resolved for */
+    char *resolved_name;
+    /* the fontconfig time stamp when the font list was resolved */
+    long long resolved_time;
+    /* if the font list needs to be checked against the name */
+    bool is_outdated;
+    /* the pattern matching the name, used to prepare the fallback fonts */
+    FcPattern *match;
+    /* if the fallback fonts were added to the font list */
+    bool has_fallback_fonts;
+    /* all fonts within the font list, the first one is the primary font */
     struct font *fonts;
     /* the number of fonts in the font list */
     int count;
@@ -53,8 +81,8 @@ void free_xft_color(XftColor *color)
             color);
 }
 
-/* Free the resources the font list occupies. */
-void free_font_list(void)
+/* Free the resolved fonts within the font list. */
+static void clear_resolved_fonts(void)
 {
     for (int i = 0; i < font_list.count; i++) {
         if (font_list.fonts[i].font != NULL) {
@@ -62,22 +90,88 @@ void free_font_list(void)
         }
         FcPatternDestroy(font_list.fonts[i].pattern);
     }
-    free(font_list.fonts);
+    xfree(font_list.fonts);
+    font_list.fonts = NULL;
+    font_list.count = 0;
+
+    if (font_list.match != NULL) {
+        FcPatternDestroy(font_list.match);
+        font_list.match = NULL;
+    }
+    font_list.has_fallback_fonts = false;
+
+    xfree(font_list.resolved_name);
+    font_list.resolved_name = NULL;
 }
 
-/* Set the global font using given fontconfig pattern string. */
-int set_font(const utf8_t *name)
+/* Free the resources the font list occupies. */
+void free_font_list(void)
 {
+    clear_resolved_fonts();
+    xfree(font_list.name);
+    font_list.name = NULL;
+}
+
+/* Get a time stamp that changes whenever the fontconfig configuration or a
+ * font directory changes.
+ */
+static long long get_fontconfig_time(void)
+{
+    FcStrList *list;
+    FcChar8 *path;
+    struct stat status;
+    long long time = 0;
+
+    for (int i = 0; i < 2; i++) {
+        list = i == 0 ? FcConfigGetFontDirs(NULL) :
+            FcConfigGetConfigFiles(NULL);
+        if (list == NULL) {
+            continue;
+        }
+        while (path = FcStrListNext(list), path != NULL) {
+            if (stat((char*) path, &status) == 0) {
+                time = MAX(time, (long long) status.st_mtime);
+            }
+        }
+        FcStrListDone(list);
+    }
+    return time;
+}
+
+/* Load the primary font if the font name or the fonts on the system
+ * changed.
+ *
+ * The fallback fonts are only resolved when a glyph is not in the primary font.
+ * The current fonts are only replaced once the new font is open.
+ *
+ * @return ERROR if the font could not be loaded, the old fonts are kept then.
+ */
+static int resolve_primary_font(void)
+{
+    const char *name;
     FcPattern *pattern;
     FcPattern *match;
     FcResult result;
-    FcFontSet *set;
+    XftFont *font;
+    long long time;
 
-    struct font *fonts;
-    int font_count = 0;
+    if (!font_list.is_outdated) {
+        return OK;
+    }
+    font_list.is_outdated = false;
+
+    name = font_list.name == NULL ? DEFAULT_FONT : font_list.name;
 
     /* reload font configuration if anything changed */
     (void) FcInitBringUptoDate();
+    time = get_fontconfig_time();
+
+    /* nothing changed, keep the current fonts */
+    if (font_list.resolved_name != NULL &&
+            strcmp(font_list.resolved_name, name) == 0 &&
+            font_list.resolved_time == time) {
+        return OK;
+    }
 
     pattern = XftNameParse(name);
     if (pattern == NULL) {
@@ -88,84 +182,397 @@ int set_font(const utf8_t *name)
 
     match = XftFontMatch(display, DefaultScreen(display), pattern, &result);
     FcPatternDestroy(pattern);
-
     if (match == NULL) {
         LOG_ERROR("could not match font name: %s\n",
                 name);
         return ERROR;
     }
 
-    /* get a set of fonts covering most unicode glyphs */
-    set = FcFontSort(NULL, match, FcTrue, NULL, &result);
-    if (set == NULL) {
+    /* the match is already prepared for rendering, on success opening takes
+     * ownership of the duplicate
+     */
+    pattern = FcPatternDuplicate(match);
+    font = pattern == NULL ? NULL : XftFontOpenPattern(display, pattern);
+    if (font == NULL) {
+        if (pattern != NULL) {
+            FcPatternDestroy(pattern);
+        }
         FcPatternDestroy(match);
-        LOG_ERROR("could not create FcFontSet for font creation\n");
+        LOG_ERROR("could not open font: %s\n",
+                name);
         return ERROR;
     }
 
-    /* allocate the fonts to hold onto the patterns */
-    ALLOCATE_ZERO(fonts, set->nfont);
+    clear_resolved_fonts();
+
+    font_list.match = match;
+    ALLOCATE_ZERO(font_list.fonts, 1);
+    FcPatternReference(match);
+    font_list.fonts[0].pattern = match;
+    font_list.fonts[0].font = font;
+    font_list.count = 1;
+
+    font_list.resolved_name = xstrdup(name);
+    font_list.resolved_time = time;
+
+    LOG("loaded primary font for %s\n",
+            name);
+    return OK;
+}
+
+/* Set the global font using given fontconfig pattern string. */
+int set_font(const utf8_t *name)
+{
+    char *old_name;
+
+    old_name = font_list.name;
+    font_list.name = xstrdup(name);
+    font_list.is_outdated = true;
+    if (resolve_primary_font() == ERROR) {
+        xfree(font_list.name);
+        font_list.name = old_name;
+        return ERROR;
+    }
+    xfree(old_name);
+    return OK;
+}
+
+/* Go back to the default font. */
+void reset_font(void)
+{
+    xfree(font_list.name);
+    font_list.name = NULL;
+    font_list.is_outdated = true;
+}
+
+/* Find the font with given @file and @index within the system fonts.
+ *
+ * @return NULL if there is no such font.
+ */
+static FcPattern *find_system_font(FcFontSet *set, const char *file,
+        int index)
+{
+    FcChar8 *other_file;
+    int other_index;
 
     for (int i = 0; i < set->nfont; i++) {
-        fonts[i].pattern = FcFontRenderPrepare(NULL, match, set->fonts[i]);
-        if (fonts[i].pattern == NULL) {
-            font_count = -1;
-            /* dereference all previous font patterns */
-            for (int j = 0; j < i; j++) {
-                FcPatternDestroy(fonts[j].pattern);
-            }
-            break;
+        if (FcPatternGetString(set->fonts[i], FC_FILE, 0, &other_file) !=
+                    FcResultMatch ||
+                strcmp((char*) other_file, file) != 0) {
+            continue;
+        }
+        if (FcPatternGetInteger(set->fonts[i], FC_INDEX, 0, &other_index) !=
+                    FcResultMatch) {
+            other_index = 0;
+        }
+        if (other_index == index) {
+            return set->fonts[i];
         }
-        font_count++;
     }
+    return NULL;
+}
 
-    FcPatternDestroy(match);
-    FcFontSetDestroy(set);
+/* Append @pattern to the font list as fallback font. */
+static void add_fallback_font(FcPattern *pattern)
+{
+    FcPatternReference(pattern);
+    REALLOCATE(font_list.fonts, font_list.count + 1);
+    font_list.fonts[font_list.count].pattern = pattern;
+    font_list.fonts[font_list.count].font = NULL;
+    font_list.count++;
+}
+
+/* Try to get the fallback fonts from the font cache file.
+ *
+ * The cache file has an entry for each font name with the fontconfig time
+ * stamp.  Each entry lists the file and index of the fallback fonts in order.
+ *
+ * @return ERROR if the cache has no valid entry.
+ */
+static int load_cached_fallback_fonts(void)
+{
+    char *path;
+    FILE *file;
+    char line[4096];
+    char *tab;
+    size_t length;
+    bool is_entry = false;
+    FcFontSet *set;
+    FcPattern *pattern;
 
-    if (font_count < 0) {
-        LOG_ERROR("could not create font patterns for font rendering\n");
-        free(fonts);
+    set = FcConfigGetFonts(NULL, FcSetSystem);
+    if (set == NULL) {
         return ERROR;
     }
 
-    /* free the old font list */
-    free_font_list();
+    path = get_cache_file("fonts");
+    if (path == NULL) {
+        return ERROR;
+    }
+    file = fopen(path, "r");
+    xfree(path);
+    if (file == NULL) {
+        return ERROR;
+    }
 
-    font_list.fonts = fonts;
-    font_list.count = font_count;
+    if (fgets(line, sizeof(line), file) == NULL ||
+            strcmp(line, FONT_CACHE_HEADER) != 0) {
+        fclose(file);
+        return ERROR;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        length = strlen(line);
+        if (length == 0 || line[length - 1] != '\n') {
+            break;
+        }
+        line[length - 1] = '\0';
+
+        tab = strchr(line, '\t');
+        if (tab == NULL) {
+            break;
+        }
+        tab[0] = '\0';
+
+        /* F<tab>time stamp<tab>font name */
+        if (strcmp(line, "F") == 0) {
+            /* the entry ended */
+            if (is_entry) {
+                break;
+            }
 
-    LOG("got %d fonts from %s\n",
-            font_count, name);
+            char *const time = &tab[1];
+            tab = strchr(time, '\t');
+            if (tab == NULL) {
+                break;
+            }
+            tab[0] = '\0';
+            is_entry = strtoll(time, NULL, 10) == font_list.resolved_time &&
+                strcmp(&tab[1], font_list.resolved_name) == 0;
+        /* index<tab>file */
+        } else if (is_entry) {
+            pattern = find_system_font(set, &tab[1], atoi(line));
+            /* the system fonts are not what they were */
+            if (pattern == NULL) {
+                is_entry = false;
+                break;
+            }
+            add_fallback_font(pattern);
+        }
+    }
+
+    fclose(file);
+
+    if (!is_entry) {
+        /* undo what was added */
+        for (int i = 1; i < font_list.count; i++) {
+            FcPatternDestroy(font_list.fonts[i].pattern);
+        }
+        font_list.count = MIN(font_list.count, 1);
+        return ERROR;
+    }
     return OK;
 }
 
-/* Convert given @utf8 string with @length to a glyph array.  */
-FcChar32 *get_glyphs(const utf8_t *utf8, int length, int *glyph_count)
+/* Write the fallback fonts into the font cache file.
+ *
+ * The entries of other font names are kept.
+ */
+static void save_cached_fallback_fonts(void)
 {
-    static FcChar32 glyphs[MAX_GLYPH_COUNT];
+    char *path, *temporary_path;
+    FILE *old_file, *file;
+    char line[4096];
+    char *tab;
+    const size_t name_length = strlen(font_list.resolved_name);
+    unsigned entry_count = 0;
+    bool is_copying = false;
+    FcChar8 *font_file;
+    int index;
+
+    path = get_cache_file("fonts");
+    if (path == NULL) {
+        return;
+    }
+
+    temporary_path = xasprintf("%s.new", path);
+    file = fopen(temporary_path, "w");
+    if (file == NULL) {
+        xfree(temporary_path);
+        xfree(path);
+        return;
+    }
 
-    int index = 0;
+    fputs(FONT_CACHE_HEADER, file);
+    fprintf(file, "F\t%lld\t%s\n",
+            font_list.resolved_time, font_list.resolved_name);
+    for (int i = 1; i < font_list.count; i++) {
+        FcPattern *const pattern = font_list.fonts[i].pattern;
 
-    if (length < 0) {
-        length = strlen(utf8);
+        if (FcPatternGetString(pattern, FC_FILE, 0, &font_file) !=
+                FcResultMatch) {
+            continue;
+        }
+        if (FcPatternGetInteger(pattern, FC_INDEX, 0, &index) !=
+                FcResultMatch) {
+            index = 0;
+        }
+        fprintf(file, "%d\t%s\n",
+                index, (char*) font_file);
     }
 
-    /* go over each unicode codepoint of the UTF-8 string */
-    while (length > 0) {
-        const int n = FcUtf8ToUcs4((FcChar8*) utf8, &glyphs[index], length);
-        if (n <= 0) {
-            break;
+    /* copy the other entries of the old cache file */
+    old_file = fopen(path, "r");
+    if (old_file != NULL) {
+        if (fgets(line, sizeof(line), old_file) != NULL &&
+                strcmp(line, FONT_CACHE_HEADER) == 0) {
+            while (fgets(line, sizeof(line), old_file) != NULL) {
+                if (strncmp(line, "F\t", 2) == 0) {
+                    tab = strchr(&line[2], '\t');
+                    entry_count++;
+                    is_copying = tab != NULL &&
+                        entry_count < FONT_CACHE_MAXIMUM_ENTRIES &&
+                        (strncmp(&tab[1], font_list.resolved_name,
+                            name_length) != 0 ||
+                         tab[1 + name_length] != '\n');
+                }
+                if (is_copying) {
+                    fputs(line, file);
+                }
+            }
+        }
+        fclose(old_file);
+    }
+
+    if (fclose(file) != 0 || rename(temporary_path, path) == -1) {
+        LOG_ERROR("could not write the font cache %s: %s\n",
+                path, strerror(errno));
+        remove(temporary_path);
+    }
+
+    xfree(temporary_path);
+    xfree(path);
+}
+
+/* Add all fonts that cover the glyphs the primary font does not have. */
+static void resolve_fallback_fonts(void)
+{
+    FcFontSet *set;
+    FcResult result;
+
+    if (font_list.has_fallback_fonts || font_list.match == NULL) {
+        return;
+    }
+    font_list.has_fallback_fonts = true;
+
+    if (load_cached_fallback_fonts() == OK) {
+        LOG("got %d fallback fonts for %s from the cache\n",
+                font_list.count - 1, font_list.resolved_name);
+        return;
+    }
+
+    /* get a set of fonts covering most unicode glyphs */
+    set = FcFontSort(NULL, font_list.match, FcTrue, NULL, &result);
+    if (set == NULL) {
+        LOG_ERROR("could not create FcFontSet for fallback fonts\n");
+        return;
+    }
+
+    for (int i = 0; i < set->nfont; i++) {
+        add_fallback_font(set->fonts[i]);
+    }
+
+    FcFontSetDestroy(set);
+
+    LOG("got %d fallback fonts for %s\n",
+            font_list.count - 1, font_list.resolved_name);
+
+    save_cached_fallback_fonts();
+}
+
+/* Find the font that has @glyph.
+ *
+ * @return the index of the font within the font list or -1 if no font has it.
+ */
+static int find_glyph_font(FcChar32 glyph)
+{
+    FcCharSet *charset;
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < font_list.count; i++) {
+            FcPattern *const pattern = font_list.fonts[i].pattern;
+            if (FcPatternGetCharSet(pattern, FC_CHARSET, 0, &charset) !=
+                    FcResultMatch) {
+                LOG_DEBUG("font at %d has no char set\n",
+                        i);
+                continue;
+            }
+
+            if (FcCharSetHasChar(charset, glyph)) {
+                return i;
+            }
         }
-        index++;
-        if (index == sizeof(glyphs)) {
-            LOG_VERBOSE("ran out of glyph space, have %d more bytes\n",
-                    length);
+
+        /* only now is it time to look for fallback fonts */
+        if (font_list.has_fallback_fonts) {
             break;
         }
-        utf8 += n;
-        length -= n;
+        resolve_fallback_fonts();
+    }
+    return -1;
+}
+
+/* Open the font at @index within the font list if it is not open yet. */
+static XftFont *open_font(int index)
+{
+    struct font *const font = &font_list.fonts[index];
+    FcPattern *pattern;
+
+    if (font->font != NULL) {
+        return font->font;
+    }
+
+    /* the primary font is opened when it is resolved, the fallback fonts are
+     * prepared now
+     */
+    pattern = FcFontRenderPrepare(NULL, font_list.match, font->pattern);
+    if (pattern != NULL) {
+        /* on success, this takes ownership of the pattern */
+        font->font = XftFontOpenPattern(display, pattern);
+        if (font->font == NULL) {
+            FcPatternDestroy(pattern);
+        }
+    }
+    return font->font;
+}
+
+/* Get the primary font. */
+XftFont *get_primary_font(void)
+{
+    resolve_primary_font();
+    if (font_list.count == 0) {
+        return NULL;
+    }
+    return open_font(0);
+}
+
+/* Convert given @utf8 string with @length to a glyph array.  */
+FcChar32 *get_glyphs(const utf8_t *utf8, int length, int *glyph_count)
+{
+    static FcChar32 *glyphs;
+    static size_t glyph_capacity;
+
+    if (length < 0) {
+        length = strlen(utf8);
     }
-    *glyph_count = index;
+
+    /* each byte makes at most one glyph */
+    if ((size_t) length > glyph_capacity) {
+        glyph_capacity = MAX((size_t) length, glyph_capacity * 2);
+        REALLOCATE(glyphs, glyph_capacity);
+    }
+
+    *glyph_count = decode_utf8(utf8, length, (uint32_t*) glyphs);
     return glyphs;
 }
 
@@ -176,6 +583,8 @@ Text *create_text(const FcChar32 *glyphs, int glyph_count)
     int item_capacity = 2;
     int glyph_index = 0;
 
+    begin_trace_span("text", "create text");
+
     /* create the text object */
     text = xmalloc(sizeof(*text) + sizeof(*text->glyphs) * glyph_count);
     text->x = 0;
@@ -185,48 +594,23 @@ Text *create_text(const FcChar32 *glyphs, int glyph_count)
     ALLOCATE(text->items, item_capacity);
     text->item_count = 0;
 
+    resolve_primary_font();
+
     /* go over all glyphs */
-    for (int i = 0, j; i < glyph_count; i++) {
+    for (int i = 0; i < glyph_count; i++) {
         const FcChar32 glyph = glyphs[i];
+        int index;
 
         /* find the font that has this glyph */
-        for (j = 0; j < font_list.count; j++) {
-            FcCharSet *charset;
-
-            FcPattern *const pattern = font_list.fonts[j].pattern;
-            if (FcPatternGetCharSet(pattern, FC_CHARSET, 0, &charset) !=
-                    FcResultMatch) {
-                LOG_DEBUG("font at %d has no char set\n",
-                        j);
-                continue;
-            }
-
-            if (FcCharSetHasChar(charset, glyph)) {
-                break;
-            }
-        }
-
-        if (j == font_list.count) {
+        index = find_glyph_font(glyph);
+        if (index < 0) {
             LOG_DEBUG("no font has glyph %#08" PRIx32 "\n",
                     glyph);
             continue;
         }
 
-        /* create the font if not already created */
-        if (font_list.fonts[j].font == NULL) {
-            FcResult result;
-            FcPattern *match;
-
-            match = XftFontMatch(display, DefaultScreen(display),
-                    font_list.fonts[j].pattern, &result);
-            if (match != NULL) {
-                font_list.fonts[j].font = XftFontOpenPattern(display, match);
-                FcPatternDestroy(match);
-            }
-        }
-
         /* get the font and do a sanity check */
-        XftFont *const font = font_list.fonts[j].font;
+        XftFont *const font = open_font(index);
         if (font == NULL) {
             LOG_ERROR("could not open font for glyph: %#08" PRIx32 "\n",
                     glyph);
@@ -293,6 +677,7 @@ Text *create_text(const FcChar32 *glyphs, int glyph_count)
     LOG_DEBUG("text bounds: %R\n",
             text->x, text->y, text->width, text->height);
 
+    end_trace_span();
     return text;
 }
 
@@ -302,6 +687,8 @@ void draw_text(XftDraw *draw, XftColor *color, int start_x, int start_y,
 {
     int x, y;
 
+    begin_trace_span("text", "draw text");
+
     x = start_x;
     y = start_y;
     /* draw each glyph section with the respective item font */
@@ -316,11 +703,13 @@ void draw_text(XftDraw *draw, XftColor *color, int start_x, int start_y,
         x += item->extents.xOff;
         y += item->extents.yOff;
     }
+
+    end_trace_span();
 }
 
 /* Destroy a text object. */
 void destroy_text(Text *text)
 {
-    free(text->items);
-    free(text);
+    xfree(text->items);
+    xfree(text);
 }
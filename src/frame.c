@@ -15,6 +15,9 @@ Frame *Frame_last_stashed;
 /* the currently selected/focused frame */
 Frame *Frame_focus;
 
+/* the pool all frames are allocated from */
+ObjectPool Frame_pool = OBJECT_POOL(Frame, 64);
+
 /*********************************
  * Frame creation an destruction *
  *********************************/
@@ -31,7 +34,7 @@ inline void dereference_frame(Frame *frame)
 {
     frame->reference_count--;
     if (frame->reference_count == 0) {
-        free(frame);
+        free_pool_object(&Frame_pool, frame);
     }
 }
 
@@ -40,7 +43,7 @@ inline Frame *create_frame(void)
 {
     Frame *frame;
 
-    ALLOCATE_ZERO(frame, 1);
+    frame = allocate_pool_object(&Frame_pool);
     frame->reference_count = 1;
     return frame;
 }
@@ -0,0 +1,420 @@
+#define _POSIX_C_SOURCE 200809L /* MSG_NOSIGNAL */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "fensterchef.h"
+#include "ipc.h"
+#include "log.h"
+#include "parse/parse.h"
+#include "utility/list.h"
+#include "utility/xalloc.h"
+
+/* a connection to the server */
+struct ipc_client {
+    /* the connected socket */
+    int file_descriptor;
+    /* the received bytes not yet run as command */
+    LIST(char, input);
+    /* the replies not yet written */
+    LIST(char, output);
+    /* if nothing more is read from the client, it is removed once all replies
+     * are written
+     */
+    bool is_closing;
+};
+
+/* the socket server */
+static struct {
+    /* the path of the socket */
+    char *path;
+    /* the listening socket or -1 if the server is not running */
+    int file_descriptor;
+    /* all connected clients */
+    LIST(struct ipc_client, clients);
+} ipc = { .file_descriptor = -1 };
+
+/* Get the path of the socket for the current display. */
+char *get_ipc_socket_path(void)
+{
+    const char *runtime_directory;
+    char *display_name;
+    char *path;
+    struct sockaddr_un address;
+
+    display_name = getenv("DISPLAY");
+    display_name = xstrdup(display_name == NULL ? "" : display_name);
+    /* a slash would be taken as directory */
+    for (char *slash = strchr(display_name, '/'); slash != NULL;
+            slash = strchr(slash, '/')) {
+        slash[0] = '_';
+    }
+
+    runtime_directory = getenv("XDG_RUNTIME_DIR");
+    if (runtime_directory == NULL || runtime_directory[0] == '\0') {
+        path = xasprintf("/tmp/" FENSTERCHEF_NAME "-%ld-%s.socket",
+                (long) getuid(), display_name);
+    } else {
+        path = xasprintf("%s/" FENSTERCHEF_NAME "-%s.socket",
+                runtime_directory, display_name);
+    }
+    xfree(display_name);
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        xfree(path);
+        return NULL;
+    }
+    return path;
+}
+
+/* Fill @address with the address of the socket at @path. */
+static void set_socket_address(struct sockaddr_un *address, const char *path)
+{
+    ZERO(address, 1);
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, path);
+}
+
+/* Make @file_descriptor non blocking and not be inherited by child
+ * processes.
+ */
+static void set_socket_flags(int file_descriptor)
+{
+    (void) fcntl(file_descriptor, F_SETFL,
+            fcntl(file_descriptor, F_GETFL) | O_NONBLOCK);
+    (void) fcntl(file_descriptor, F_SETFD, FD_CLOEXEC);
+}
+
+/* Create the socket and start listening. */
+int start_ipc_server(void)
+{
+    struct sockaddr_un address;
+    mode_t old_mask;
+    int result;
+
+    ipc.path = get_ipc_socket_path();
+    if (ipc.path == NULL) {
+        LOG_ERROR("the path of the command socket is too long\n");
+        return ERROR;
+    }
+
+    ipc.file_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (ipc.file_descriptor == -1) {
+        LOG_ERROR("could not create the command socket: %s\n",
+                strerror(errno));
+        xfree(ipc.path);
+        ipc.path = NULL;
+        return ERROR;
+    }
+    set_socket_flags(ipc.file_descriptor);
+
+    set_socket_address(&address, ipc.path);
+    /* this fensterchef has the window manager role on this display so an
+     * existing socket can only be left over
+     */
+    (void) unlink(ipc.path);
+    /* only the user may connect */
+    old_mask = umask(0077);
+    result = bind(ipc.file_descriptor, (struct sockaddr*) &address,
+            sizeof(address));
+    umask(old_mask);
+    if (result == -1 || listen(ipc.file_descriptor, 16) == -1) {
+        LOG_ERROR("could not listen on %s: %s\n",
+                ipc.path, strerror(errno));
+        close(ipc.file_descriptor);
+        ipc.file_descriptor = -1;
+        xfree(ipc.path);
+        ipc.path = NULL;
+        return ERROR;
+    }
+
+    LOG("listening for commands on %s\n",
+            ipc.path);
+    return OK;
+}
+
+/* Close the connection to @client and free its buffers. */
+static void close_ipc_client(struct ipc_client *client)
+{
+    close(client->file_descriptor);
+    LIST_CLEAR(client->input);
+    LIST_CLEAR(client->output);
+}
+
+/* Add the file descriptors of the server and its connections to the sets. */
+int set_ipc_file_descriptors(fd_set *read_set, fd_set *write_set)
+{
+    int maximum;
+
+    if (ipc.file_descriptor < 0) {
+        return -1;
+    }
+
+    FD_SET(ipc.file_descriptor, read_set);
+    maximum = ipc.file_descriptor;
+    for (size_t i = 0; i < ipc.clients_length; i++) {
+        const struct ipc_client *const client = &ipc.clients[i];
+
+        /* stop reading from clients not reading their replies */
+        if (!client->is_closing &&
+                client->output_length < IPC_MAXIMUM_REPLY_LENGTH) {
+            FD_SET(client->file_descriptor, read_set);
+        }
+        if (client->output_length > 0) {
+            FD_SET(client->file_descriptor, write_set);
+        }
+        maximum = MAX(maximum, client->file_descriptor);
+    }
+    return maximum;
+}
+
+/* Accept all waiting connections. */
+static void accept_ipc_clients(void)
+{
+    int file_descriptor;
+
+    while (file_descriptor = accept(ipc.file_descriptor, NULL, NULL),
+            file_descriptor != -1) {
+        /* `select()` can not handle higher file descriptors */
+        if (file_descriptor >= FD_SETSIZE) {
+            LOG_ERROR("too many open files to accept a connection\n");
+            close(file_descriptor);
+            continue;
+        }
+
+        set_socket_flags(file_descriptor);
+        LIST_APPEND(ipc.clients, NULL, 1);
+        ipc.clients[ipc.clients_length - 1].file_descriptor = file_descriptor;
+    }
+}
+
+/* Run @command and queue the reply for @client. */
+static void run_ipc_command(struct ipc_client *client, const char *command)
+{
+    Parser *parser;
+    int result;
+
+    LOG("received command: %s\n",
+            command);
+
+    parser = create_string_parser(command);
+    result = parse_and_run_actions(parser);
+    destroy_parser(parser);
+
+    if (result == OK) {
+        LIST_APPEND(client->output, "ok\n", strlen("ok\n"));
+    } else {
+        LIST_APPEND(client->output, "error\n", strlen("error\n"));
+    }
+}
+
+/* Run all complete commands within the input of @client. */
+static void run_ipc_commands(struct ipc_client *client)
+{
+    char *start, *end;
+    char *limit;
+    size_t remaining;
+
+    start = client->input;
+    limit = &client->input[client->input_length];
+    /* each command is terminated by a null byte */
+    while (end = memchr(start, '\0', limit - start), end != NULL) {
+        run_ipc_command(client, start);
+        start = end + 1;
+    }
+
+    /* keep the incomplete command */
+    remaining = limit - start;
+    memmove(client->input, start, remaining);
+    client->input_length = remaining;
+}
+
+/* Read what @client sent and run all complete commands. */
+static void read_ipc_client(struct ipc_client *client)
+{
+    char buffer[16 * 1024];
+    ssize_t count;
+
+    /* read only once so a busy client can not hold up the event loop */
+    count = read(client->file_descriptor, buffer, sizeof(buffer));
+    if (count > 0) {
+        LIST_APPEND(client->input, buffer, count);
+        run_ipc_commands(client);
+        if (client->input_length > IPC_MAXIMUM_COMMAND_LENGTH) {
+            LOG_ERROR("received command is too long\n");
+            client->is_closing = true;
+        }
+    } else if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK &&
+                errno != EINTR)) {
+        client->is_closing = true;
+    }
+}
+
+/* Write as much of the replies to @client as possible. */
+static void write_ipc_client(struct ipc_client *client)
+{
+    ssize_t count;
+
+    count = send(client->file_descriptor, client->output, client->output_length,
+            MSG_NOSIGNAL);
+    if (count > 0) {
+        client->output_length -= count;
+        memmove(client->output, &client->output[count], client->output_length);
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        /* the client is gone, nobody reads the replies */
+        client->output_length = 0;
+        client->is_closing = true;
+    }
+}
+
+/* Write all replies still waiting for @client, for example the reply to the
+ * `quit` that stops the server.
+ */
+static void flush_ipc_client(struct ipc_client *client)
+{
+    const struct timeval timeout = { .tv_sec = IPC_FLUSH_TIMEOUT };
+    size_t length;
+
+    /* block for a bounded time so a client not reading can not hold up
+     * quitting
+     */
+    (void) setsockopt(client->file_descriptor, SOL_SOCKET, SO_SNDTIMEO,
+            &timeout, sizeof(timeout));
+    (void) fcntl(client->file_descriptor, F_SETFL,
+            fcntl(client->file_descriptor, F_GETFL) & ~O_NONBLOCK);
+    while (client->output_length > 0 && !client->is_closing) {
+        length = client->output_length;
+        write_ipc_client(client);
+        /* the time ran out */
+        if (client->output_length == length) {
+            break;
+        }
+    }
+}
+
+/* Close all connections and remove the socket. */
+void stop_ipc_server(void)
+{
+    if (ipc.file_descriptor < 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < ipc.clients_length; i++) {
+        flush_ipc_client(&ipc.clients[i]);
+        close_ipc_client(&ipc.clients[i]);
+    }
+    LIST_CLEAR(ipc.clients);
+
+    close(ipc.file_descriptor);
+    ipc.file_descriptor = -1;
+    (void) unlink(ipc.path);
+    xfree(ipc.path);
+    ipc.path = NULL;
+}
+
+/* Accept connections, run the received commands and write the replies. */
+void handle_ipc_file_descriptors(const fd_set *read_set,
+        const fd_set *write_set)
+{
+    struct ipc_client *client;
+
+    if (ipc.file_descriptor < 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < ipc.clients_length; i++) {
+        client = &ipc.clients[i];
+        if (FD_ISSET(client->file_descriptor, read_set)) {
+            read_ipc_client(client);
+        }
+        /* write the replies right away, most of the time they fit */
+        if (client->output_length > 0 &&
+                (FD_ISSET(client->file_descriptor, read_set) ||
+                    FD_ISSET(client->file_descriptor, write_set))) {
+            write_ipc_client(client);
+        }
+    }
+
+    /* remove the clients that are done */
+    for (size_t i = ipc.clients_length; i > 0; i--) {
+        client = &ipc.clients[i - 1];
+        if (client->is_closing && client->output_length == 0) {
+            close_ipc_client(client);
+            ipc.clients[i - 1] = ipc.clients[ipc.clients_length - 1];
+            ipc.clients_length--;
+        }
+    }
+
+    if (FD_ISSET(ipc.file_descriptor, read_set)) {
+        accept_ipc_clients();
+    }
+}
+
+/* Send @command to the running fensterchef and wait for the reply. */
+int send_ipc_command(const char *command, _Out bool *is_success)
+{
+    char *path;
+    int file_descriptor;
+    struct sockaddr_un address;
+    const struct timeval timeout = { .tv_sec = IPC_REPLY_TIMEOUT };
+    char reply[16];
+    size_t reply_length = 0;
+    size_t length;
+    ssize_t count;
+
+    path = get_ipc_socket_path();
+    if (path == NULL) {
+        return ERROR;
+    }
+
+    file_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (file_descriptor == -1) {
+        xfree(path);
+        return ERROR;
+    }
+    set_socket_address(&address, path);
+    xfree(path);
+    if (connect(file_descriptor, (struct sockaddr*) &address,
+                sizeof(address)) == -1) {
+        close(file_descriptor);
+        return ERROR;
+    }
+
+    /* send the command with its terminating null byte */
+    length = strlen(command) + 1;
+    for (size_t written = 0; written < length; written += count) {
+        count = send(file_descriptor, &command[written], length - written,
+                MSG_NOSIGNAL);
+        if (count <= 0) {
+            close(file_descriptor);
+            return ERROR;
+        }
+    }
+
+    /* wait for the line with the reply, but not forever in case the server
+     * is stuck
+     */
+    (void) setsockopt(file_descriptor, SOL_SOCKET, SO_RCVTIMEO,
+            &timeout, sizeof(timeout));
+    while (reply_length < sizeof(reply) - 1 &&
+            memchr(reply, '\n', reply_length) == NULL) {
+        count = read(file_descriptor, &reply[reply_length],
+                sizeof(reply) - 1 - reply_length);
+        if (count <= 0) {
+            break;
+        }
+        reply_length += count;
+    }
+    close(file_descriptor);
+
+    reply[reply_length] = '\0';
+    *is_success = strcmp(reply, "ok\n") == 0;
+    return OK;
+}
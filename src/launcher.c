@@ -0,0 +1,833 @@
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "chooser.h"
+#include "fensterchef.h"
+#include "launcher.h"
+#include "log.h"
+
+/* the first line of the cache file, changing the format requires a new
+ * version
+ */
+#define LAUNCHER_CACHE_HEADER "fensterchef applications 1\n"
+
+/* the maximum length of a line within the cache file or a .desktop file */
+#define LAUNCHER_MAXIMUM_LINE_LENGTH 4096
+
+/* a directory applications are found in */
+struct application_directory {
+    /* the path to the directory */
+    char *path;
+    /* if the directory contains .desktop files instead of executables */
+    bool is_desktop;
+    /* the modification time of the directory when it was last looked at */
+    time_t modification_time;
+    /* the inotify watch descriptor or -1 if the directory is not watched */
+    int watch;
+    /* if the directory needs to be scanned again */
+    bool is_outdated;
+};
+
+/* an application that can be launched */
+struct application {
+    /* the index of the directory the application was found in */
+    unsigned directory;
+    /* the name of the file within the directory */
+    char *file;
+    /* the name shown to the user */
+    char *name;
+    /* the shell command that runs the application */
+    char *command;
+    /* the key used for searching */
+    SearchKey key;
+};
+
+/* the launcher source for the chooser */
+static const ChooserSource launcher_source;
+
+/* the application launcher */
+static struct launcher {
+    /* if the directories were collected and the cache was loaded */
+    bool is_initialized;
+    /* all directories applications are found in */
+    LIST(struct application_directory, directories);
+    /* all known applications */
+    LIST(struct application, applications);
+    /* if the applications are sorted by name */
+    bool is_sorted;
+    /* if the applications changed since the cache was written */
+    bool is_modified;
+    /* the inotify file descriptor or -1 if there is none */
+    int inotify;
+} launcher = {
+    .inotify = -1,
+};
+
+/***************
+ * Directories *
+ ***************/
+
+/* Add a directory to the launcher directories unless it is already there. */
+static void add_directory(const char *path, size_t length, bool is_desktop)
+{
+    struct application_directory directory;
+
+    if (length == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < launcher.directories_length; i++) {
+        if (strncmp(launcher.directories[i].path, path, length) == 0 &&
+                launcher.directories[i].path[length] == '\0') {
+            return;
+        }
+    }
+
+    directory.path = xstrndup(path, length);
+    directory.is_desktop = is_desktop;
+    directory.modification_time = 0;
+    directory.watch = -1;
+    directory.is_outdated = true;
+    LIST_APPEND_VALUE(launcher.directories, directory);
+}
+
+/* Add all directories within the colon separated @paths. */
+static void add_directory_list(const char *paths, const char *suffix,
+        bool is_desktop)
+{
+    const char *colon;
+    char *path;
+
+    for (; paths[0] != '\0'; paths = colon + 1) {
+        colon = strchr(paths, ':');
+        if (colon == NULL) {
+            colon = &paths[strlen(paths)];
+        }
+
+        path = xasprintf("%.*s%s", (int) (colon - paths), paths, suffix);
+        add_directory(path, strlen(path), is_desktop);
+        xfree(path);
+
+        if (colon[0] == '\0') {
+            break;
+        }
+    }
+}
+
+/* Collect all directories that contain applications. */
+static void collect_directories(void)
+{
+    const char *variable;
+    char *path;
+
+    variable = getenv("PATH");
+    if (variable != NULL) {
+        add_directory_list(variable, "", false);
+    }
+
+    variable = getenv("XDG_DATA_HOME");
+    if (variable == NULL || variable[0] == '\0') {
+        path = xasprintf("%s/.local/share/applications", Fensterchef_home);
+        add_directory(path, strlen(path), true);
+        xfree(path);
+    } else {
+        add_directory_list(variable, "/applications", true);
+    }
+
+    variable = getenv("XDG_DATA_DIRS");
+    if (variable == NULL || variable[0] == '\0') {
+        variable = "/usr/local/share:/usr/share";
+    }
+    add_directory_list(variable, "/applications", true);
+}
+
+/* Get the modification time of the directory at @path.
+ *
+ * @return 0 if the directory does not exist.
+ */
+static time_t get_modification_time(const char *path)
+{
+    struct stat status;
+
+    if (stat(path, &status) == -1) {
+        return 0;
+    }
+    return status.st_mtime;
+}
+
+/****************
+ * Applications *
+ ****************/
+
+/* Remove characters from @string that would break the cache file. */
+static void sanitize_string(char *string)
+{
+    for (; string[0] != '\0'; string++) {
+        if (string[0] == '\t' || string[0] == '\n') {
+            string[0] = ' ';
+        }
+    }
+}
+
+/* Add an application to the application list.
+ *
+ * This takes ownership of all given strings.
+ */
+static void add_application(unsigned directory, char *file, char *name,
+        char *command)
+{
+    struct application application;
+    const char *strings[2];
+
+    sanitize_string(file);
+    sanitize_string(name);
+    sanitize_string(command);
+
+    application.directory = directory;
+    application.file = file;
+    application.name = name;
+    application.command = command;
+
+    strings[0] = name;
+    strings[1] = strcmp(name, command) == 0 ? NULL : command;
+    application.key.string = NULL;
+    set_search_key(&application.key, strings, SIZE(strings));
+
+    LIST_APPEND_VALUE(launcher.applications, application);
+
+    launcher.is_sorted = false;
+    launcher.is_modified = true;
+}
+
+/* Free the resources occupied by @application. */
+static void free_application(struct application *application)
+{
+    xfree(application->file);
+    xfree(application->name);
+    xfree(application->command);
+    clear_search_key(&application->key);
+}
+
+/* Remove the applications within @directory.
+ *
+ * @file is the name of the file to remove or NULL to remove all.
+ */
+static void remove_applications(unsigned directory, const char *file)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < launcher.applications_length; i++) {
+        struct application *const application = &launcher.applications[i];
+
+        if (application->directory == directory &&
+                (file == NULL || strcmp(application->file, file) == 0)) {
+            free_application(application);
+            launcher.is_modified = true;
+        } else {
+            launcher.applications[count++] = *application;
+        }
+    }
+    launcher.applications_length = count;
+}
+
+/* Remove the field codes like %f or %U from an Exec entry. */
+static char *strip_field_codes(const char *exec)
+{
+    char *command;
+    size_t length = 0;
+
+    command = xstrdup(exec);
+    for (size_t i = 0; exec[i] != '\0'; i++) {
+        if (exec[i] != '%') {
+            command[length++] = exec[i];
+        } else if (exec[i + 1] == '%') {
+            command[length++] = '%';
+            i++;
+        } else if (exec[i + 1] != '\0') {
+            i++;
+        }
+    }
+
+    /* trim trailing white space left over by removed field codes */
+    while (length > 0 && command[length - 1] == ' ') {
+        length--;
+    }
+    command[length] = '\0';
+    return command;
+}
+
+/* Read the name and command of the desktop entry at @path.
+ *
+ * @return ERROR if the file does not describe an application to show.
+ */
+static int read_desktop_file(const char *path, _Out char **name,
+        _Out char **command)
+{
+    FILE *file;
+    char line[LAUNCHER_MAXIMUM_LINE_LENGTH];
+    bool is_in_entry = false;
+    bool is_application = false, is_hidden = false;
+    size_t length;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        return ERROR;
+    }
+
+    *name = NULL;
+    *command = NULL;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        length = strlen(line);
+        while (length > 0 && (line[length - 1] == '\n' ||
+                    line[length - 1] == '\r')) {
+            length--;
+        }
+        line[length] = '\0';
+
+        if (line[0] == '[') {
+            is_in_entry = strcmp(line, "[Desktop Entry]") == 0;
+        } else if (!is_in_entry) {
+            continue;
+        } else if (strncmp(line, "Name=", strlen("Name=")) == 0) {
+            xfree(*name);
+            *name = xstrdup(&line[strlen("Name=")]);
+        } else if (strncmp(line, "Exec=", strlen("Exec=")) == 0) {
+            xfree(*command);
+            *command = strip_field_codes(&line[strlen("Exec=")]);
+        } else if (strcmp(line, "Type=Application") == 0) {
+            is_application = true;
+        } else if (strcmp(line, "NoDisplay=true") == 0 ||
+                strcmp(line, "Hidden=true") == 0) {
+            is_hidden = true;
+        }
+    }
+
+    fclose(file);
+
+    if (!is_application || is_hidden || *name == NULL || *command == NULL ||
+            (*command)[0] == '\0') {
+        xfree(*name);
+        xfree(*command);
+        return ERROR;
+    }
+    return OK;
+}
+
+/* Add the application described by @file within @directory if it is one. */
+static void add_application_file(unsigned directory, const char *file)
+{
+    struct application_directory *const application_directory =
+        &launcher.directories[directory];
+    char *path;
+    struct stat status;
+    char *name, *command;
+
+    if (file[0] == '.') {
+        return;
+    }
+
+    path = xasprintf("%s/%s", application_directory->path, file);
+
+    if (application_directory->is_desktop) {
+        const size_t length = strlen(file);
+
+        if (length > strlen(".desktop") &&
+                strcmp(&file[length - strlen(".desktop")], ".desktop") == 0 &&
+                read_desktop_file(path, &name, &command) == OK) {
+            add_application(directory, xstrdup(file), name, command);
+        }
+    } else if (stat(path, &status) == 0 && S_ISREG(status.st_mode) &&
+            (status.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH))) {
+        add_application(directory, xstrdup(file), xstrdup(file),
+                xstrdup(file));
+    }
+
+    xfree(path);
+}
+
+/* Scan @directory for applications again. */
+static void scan_directory(unsigned directory)
+{
+    struct application_directory *const application_directory =
+        &launcher.directories[directory];
+    DIR *stream;
+    struct dirent *entry;
+
+    remove_applications(directory, NULL);
+
+    application_directory->modification_time =
+        get_modification_time(application_directory->path);
+    application_directory->is_outdated = false;
+
+    stream = opendir(application_directory->path);
+    if (stream == NULL) {
+        return;
+    }
+
+    LOG_VERBOSE("scanning application directory %s\n",
+            application_directory->path);
+
+    while (entry = readdir(stream), entry != NULL) {
+        add_application_file(directory, entry->d_name);
+    }
+
+    closedir(stream);
+
+    launcher.is_modified = true;
+}
+
+/* Compare two applications by name and then by the order of directories. */
+static int compare_applications(const void *a, const void *b)
+{
+    const struct application *const application_a = a;
+    const struct application *const application_b = b;
+    int result;
+
+    result = strcmp(application_a->name, application_b->name);
+    if (result != 0) {
+        return result;
+    }
+    return application_a->directory < application_b->directory ? -1 :
+        application_a->directory > application_b->directory;
+}
+
+/*********
+ * Cache *
+ *********/
+
+/* Split @line at the next tab.
+ *
+ * @return the start of the next field or NULL if there is none.
+ */
+static char *split_field(char *line)
+{
+    char *tab;
+
+    tab = strchr(line, '\t');
+    if (tab == NULL) {
+        return NULL;
+    }
+    tab[0] = '\0';
+    return &tab[1];
+}
+
+/* Load the applications of all directories that did not change since the
+ * cache file was written.
+ *
+ * @return ERROR if the cache file is invalid.
+ */
+static int load_cache(void)
+{
+    char *path;
+    FILE *file;
+    char line[LAUNCHER_MAXIMUM_LINE_LENGTH];
+    size_t length;
+    unsigned directory = UINT_MAX;
+    char *time_field, *kind_field, *path_field;
+    char *file_field, *name_field, *command_field;
+    int error = OK;
+
+    path = get_cache_file("applications");
+    if (path == NULL) {
+        return ERROR;
+    }
+    file = fopen(path, "r");
+    xfree(path);
+    if (file == NULL) {
+        return ERROR;
+    }
+
+    if (fgets(line, sizeof(line), file) == NULL ||
+            strcmp(line, LAUNCHER_CACHE_HEADER) != 0) {
+        fclose(file);
+        return ERROR;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        length = strlen(line);
+        /* the line was too long which means the file is broken */
+        if (length == 0 || line[length - 1] != '\n') {
+            error = ERROR;
+            break;
+        }
+        line[length - 1] = '\0';
+
+        switch (line[0]) {
+        /* D<tab>modification time<tab>kind<tab>path */
+        case 'D':
+            time_field = split_field(line);
+            kind_field = time_field == NULL ? NULL : split_field(time_field);
+            path_field = kind_field == NULL ? NULL : split_field(kind_field);
+            if (path_field == NULL) {
+                error = ERROR;
+                break;
+            }
+
+            /* only use the directory if it is still wanted and unchanged */
+            directory = UINT_MAX;
+            for (unsigned i = 0; i < launcher.directories_length; i++) {
+                struct application_directory *const application_directory =
+                    &launcher.directories[i];
+
+                if (strcmp(application_directory->path, path_field) == 0 &&
+                        application_directory->is_desktop ==
+                            (kind_field[0] == 'd') &&
+                        application_directory->is_outdated &&
+                        application_directory->modification_time ==
+                            (time_t) strtoll(time_field, NULL, 10) &&
+                        application_directory->modification_time != 0) {
+                    directory = i;
+                    application_directory->is_outdated = false;
+                    break;
+                }
+            }
+            break;
+
+        /* A<tab>file<tab>name<tab>command */
+        case 'A':
+            file_field = split_field(line);
+            name_field = file_field == NULL ? NULL : split_field(file_field);
+            command_field = name_field == NULL ? NULL :
+                split_field(name_field);
+            if (command_field == NULL) {
+                error = ERROR;
+                break;
+            }
+
+            if (directory != UINT_MAX) {
+                add_application(directory, xstrdup(file_field),
+                        xstrdup(name_field), xstrdup(command_field));
+            }
+            break;
+
+        default:
+            error = ERROR;
+            break;
+        }
+
+        if (error != OK) {
+            break;
+        }
+    }
+
+    fclose(file);
+
+    /* throw away everything from a broken cache */
+    if (error != OK) {
+        LOG_ERROR("the application cache is broken and is ignored\n");
+        for (unsigned i = 0; i < launcher.directories_length; i++) {
+            launcher.directories[i].is_outdated = true;
+        }
+        for (size_t i = 0; i < launcher.applications_length; i++) {
+            free_application(&launcher.applications[i]);
+        }
+        launcher.applications_length = 0;
+    }
+    return error;
+}
+
+/* Write all applications to the cache file. */
+static void save_cache(void)
+{
+    char *path, *temporary_path;
+    FILE *file;
+
+    path = get_cache_file("applications");
+    if (path == NULL) {
+        return;
+    }
+
+    /* write into a temporary file first so that the cache file is never
+     * incomplete
+     */
+    temporary_path = xasprintf("%s.new", path);
+    file = fopen(temporary_path, "w");
+    if (file == NULL) {
+        LOG_ERROR("could not open %s: %s\n",
+                temporary_path, strerror(errno));
+        xfree(temporary_path);
+        xfree(path);
+        return;
+    }
+
+    fputs(LAUNCHER_CACHE_HEADER, file);
+    for (unsigned i = 0; i < launcher.directories_length; i++) {
+        const struct application_directory *const directory =
+            &launcher.directories[i];
+
+        fprintf(file, "D\t%lld\t%c\t%s\n",
+                (long long) directory->modification_time,
+                directory->is_desktop ? 'd' : 'x', directory->path);
+        for (size_t j = 0; j < launcher.applications_length; j++) {
+            const struct application *const application =
+                &launcher.applications[j];
+
+            if (application->directory == i) {
+                fprintf(file, "A\t%s\t%s\t%s\n",
+                        application->file, application->name,
+                        application->command);
+            }
+        }
+    }
+
+    if (fclose(file) != 0 || rename(temporary_path, path) == -1) {
+        LOG_ERROR("could not write the application cache %s: %s\n",
+                path, strerror(errno));
+        remove(temporary_path);
+    } else {
+        launcher.is_modified = false;
+    }
+
+    xfree(temporary_path);
+    xfree(path);
+}
+
+/*******************
+ * Change tracking *
+ *******************/
+
+/* Start watching all directories for changes. */
+static void watch_directories(void)
+{
+#ifdef __linux__
+    launcher.inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (launcher.inotify == -1) {
+        LOG_ERROR("could not initialize inotify: %s\n",
+                strerror(errno));
+        return;
+    }
+
+    for (unsigned i = 0; i < launcher.directories_length; i++) {
+        launcher.directories[i].watch = inotify_add_watch(launcher.inotify,
+                launcher.directories[i].path,
+                IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                    IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF |
+                    IN_MOVE_SELF | IN_ONLYDIR);
+    }
+#endif
+}
+
+/* Get the file descriptor reporting changes of the application directories. */
+int get_launcher_file_descriptor(void)
+{
+    return launcher.inotify;
+}
+
+/* Check if the chooser currently shows the launcher. */
+static bool is_launcher_shown(void)
+{
+    return Chooser.reference.is_mapped && Chooser.source == &launcher_source;
+}
+
+/* Handle the changes reported by the launcher file descriptor. */
+void handle_launcher_changes(void)
+{
+#ifdef __linux__
+    union {
+        struct inotify_event event;
+        char bytes[4096];
+    } buffer;
+    ssize_t length;
+    const struct inotify_event *event;
+    unsigned directory;
+
+    while (length = read(launcher.inotify, &buffer, sizeof(buffer)),
+            length > 0) {
+        for (ssize_t i = 0; i < length;
+                i += sizeof(*event) + event->len) {
+            event = (const struct inotify_event*) &buffer.bytes[i];
+
+            /* events were lost, look at everything again */
+            if ((event->mask & IN_Q_OVERFLOW)) {
+                for (directory = 0; directory < launcher.directories_length;
+                        directory++) {
+                    launcher.directories[directory].is_outdated = true;
+                }
+                continue;
+            }
+
+            for (directory = 0; directory < launcher.directories_length;
+                    directory++) {
+                if (launcher.directories[directory].watch == event->wd) {
+                    break;
+                }
+            }
+
+            if (directory == launcher.directories_length) {
+                continue;
+            }
+
+            struct application_directory *const application_directory =
+                &launcher.directories[directory];
+
+            /* the directory itself is gone */
+            if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))) {
+                application_directory->watch = -1;
+                application_directory->is_outdated = true;
+                continue;
+            }
+
+            if (event->len == 0) {
+                continue;
+            }
+
+            /* while the launcher is shown, its items must stay valid */
+            if (is_launcher_shown()) {
+                application_directory->is_outdated = true;
+                continue;
+            }
+
+            if (application_directory->is_outdated) {
+                continue;
+            }
+
+            LOG_DEBUG("application file %s/%s changed\n",
+                    application_directory->path, event->name);
+
+            remove_applications(directory, event->name);
+            add_application_file(directory, event->name);
+            application_directory->modification_time =
+                get_modification_time(application_directory->path);
+            launcher.is_modified = true;
+        }
+    }
+#endif
+}
+
+/* Bring all applications up to date. */
+static void update_applications(void)
+{
+    if (!launcher.is_initialized) {
+        collect_directories();
+        /* start watching before reading so that no change is missed */
+        watch_directories();
+
+        for (unsigned i = 0; i < launcher.directories_length; i++) {
+            launcher.directories[i].modification_time =
+                get_modification_time(launcher.directories[i].path);
+        }
+
+        (void) load_cache();
+        launcher.is_modified = false;
+        launcher.is_initialized = true;
+    }
+
+    for (unsigned i = 0; i < launcher.directories_length; i++) {
+        struct application_directory *const directory =
+            &launcher.directories[i];
+
+        /* without a watch, the modification time has to be checked */
+        if (directory->watch == -1 && !directory->is_outdated &&
+                directory->modification_time !=
+                    get_modification_time(directory->path)) {
+            directory->is_outdated = true;
+        }
+
+        if (directory->is_outdated) {
+            scan_directory(i);
+        }
+    }
+
+    if (!launcher.is_sorted) {
+        SORT(launcher.applications, launcher.applications_length,
+                compare_applications);
+        launcher.is_sorted = true;
+    }
+
+    if (launcher.is_modified) {
+        save_cache();
+    }
+}
+
+/*******************
+ * Chooser methods *
+ *******************/
+
+/* Add all applications to the chooser. */
+static unsigned fill_launcher(void)
+{
+    const struct application *previous = NULL;
+
+    for (size_t i = 0; i < launcher.applications_length; i++) {
+        struct application *const application = &launcher.applications[i];
+
+        /* executables found earlier in $PATH hide the later ones */
+        if (previous != NULL &&
+                !launcher.directories[previous->directory].is_desktop &&
+                !launcher.directories[application->directory].is_desktop &&
+                strcmp(previous->name, application->name) == 0) {
+            continue;
+        }
+
+        add_chooser_item(application);
+        previous = application;
+    }
+    return 0;
+}
+
+/* Get the search key of an application. */
+static const SearchKey *get_application_key(void *data)
+{
+    const struct application *const application = data;
+
+    return &application->key;
+}
+
+/* Get the text shown for an application. */
+static int get_application_text(void *data, utf8_t *buffer,
+        size_t buffer_size)
+{
+    const struct application *const application = data;
+
+    return snprintf(buffer, buffer_size, "%s", application->name);
+}
+
+/* Get the text shown when there are no applications. */
+static int get_launcher_empty_text(utf8_t *buffer, size_t buffer_size)
+{
+    return snprintf(buffer, buffer_size, "No applications were found");
+}
+
+/* Run the chosen application. */
+static void run_application(void *data, bool shift)
+{
+    const struct application *const application = data;
+
+    (void) shift;
+    LOG("launching %s\n",
+            application->command);
+    run_shell(application->command);
+}
+
+/* the launcher source for the chooser */
+static const ChooserSource launcher_source = {
+    .name = "[fensterchef] launcher",
+    .is_window_dependent = false,
+    .fill = fill_launcher,
+    .get_key = get_application_key,
+    .get_text = get_application_text,
+    .get_empty_text = get_launcher_empty_text,
+    .choose = run_application,
+    .release = NULL,
+};
+
+/* Show the application launcher on screen. */
+int show_launcher(void)
+{
+    /* the items must stay valid while the launcher is shown */
+    if (!is_launcher_shown()) {
+        update_applications();
+    }
+    return show_chooser(&launcher_source);
+}
@@ -1,5 +1,9 @@
+#define _POSIX_C_SOURCE 200809L /* fmemopen(), strnlen() */
+
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <time.h>
 
@@ -8,12 +12,12 @@
 #include <X11/XKBlib.h>
 
 #include "action.h"
+#include "chooser.h"
 #include "event.h"
 #include "frame.h"
 #include "log.h"
 #include "notification.h"
 #include "window.h"
-#include "window_list.h"
 #include "x11/display.h"
 #include "x11/ewmh.h"
 
@@ -29,7 +33,8 @@ FILE *log_file;
 /***********************/
 /** String conversion **/
 
-static const char *event_to_string(int type)
+/* Get the name of the X event @type. */
+const char *event_to_string(int type)
 {
     const char *event_strings[] = {
         [KeyPress] = "KeyPress",
@@ -68,7 +73,7 @@ static const char *event_to_string(int type)
     };
 
     /* types smaller than 0 are reserved for errors and replies */
-    if (type < 2 || type > (int) SIZE(event_strings)) {
+    if (type < 2 || type >= (int) SIZE(event_strings)) {
         return NULL;
     }
     return event_strings[type];
@@ -421,8 +426,8 @@ static void log_x_window(Window window)
     fputs(COLOR(YELLOW), log_file);
     if (window == ewmh_window) {
         fputs("<check>", log_file);
-    } else if (window == WindowList.reference.id) {
-        fputs("<window list>", log_file);
+    } else if (window == Chooser.reference.id) {
+        fputs("<chooser>", log_file);
     } else if (system_notification != NULL &&
             window == system_notification->reference.id) {
         fputs("<notification>", log_file);
@@ -1159,26 +1164,29 @@ static void log_event(XEvent *event)
     fputs("]", log_file);
 }
 
-/* Log a window to standard error output. */
-static void log_window(const FcWindow *window)
+/* Log a window with given X window @id and @number to log_file. */
+static void log_window(Window id, unsigned number)
 {
-    log_hexadecimal(window->reference.id);
+    log_hexadecimal(id);
     fprintf(log_file, COLOR(YELLOW) "<%u>" CLEAR_COLOR,
-            window->number);
+            number);
 }
 
-/* Log a window to standard error output. */
-static void log_frame(const Frame *frame)
+/* Log a frame with given rectangle and @number to log_file. */
+static void log_frame(int x, int y, unsigned width, unsigned height,
+        unsigned number)
 {
     fputs(COLOR(MAGENTA) "[", log_file);
-    log_rectangle(frame->x, frame->y, frame->width, frame->height);
+    log_rectangle(x, y, width, height);
     fputs(COLOR(MAGENTA) "]" CLEAR_COLOR, log_file);
-    if (frame->number > 0) {
+    if (number > 0) {
         fprintf(log_file, COLOR(YELLOW) "<%u>" CLEAR_COLOR,
-                frame->number);
+                number);
     }
 }
 
+static void log_directly(const char *format, ...);
+
 /* Log given data point to log_file. */
 static void log_action_data(const struct action_data *data)
 {
@@ -1193,14 +1201,14 @@ static void log_action_data(const struct action_data *data)
         break;
 
     case ACTION_DATA_TYPE_STRING:
-        log_formatted("%s",
+        log_directly("%s",
                 data->u.string);
         break;
 
     case ACTION_DATA_TYPE_RELATION: {
         const struct window_relation *const relation =
             &data->u.relation;
-        log_formatted("%s,%s %A",
+        log_directly("%s,%s %A",
                 relation->instance_pattern,
                 relation->class_pattern,
                 relation->actions);
@@ -1216,10 +1224,10 @@ static void log_action_data(const struct action_data *data)
             fprintf(log_file, COLOR(YELLOW) "transparent" CLEAR_COLOR " ");
         }
         if (binding->modifiers != 0) {
-            log_formatted("%u+",
+            log_directly("%u+",
                     binding->modifiers);
         }
-        log_formatted("%u %A",
+        log_directly("%u %A",
                 binding->modifiers, binding->actions);
         break;
     }
@@ -1235,14 +1243,14 @@ static void log_action_data(const struct action_data *data)
         }
 
         if (binding->key_symbol == NoSymbol) {
-            log_formatted("[%d]",
+            log_directly("[%d]",
                     (int) binding->key_code);
         } else {
             fprintf(log_file, COLOR(CYAN) "%s" CLEAR_COLOR,
                     XKeysymToString(binding->key_symbol));
         }
 
-        log_formatted(" %A",
+        log_directly(" %A",
                 binding->actions);
         break;
     }
@@ -1350,190 +1358,965 @@ static void log_display(Display *display)
     fputs("]", log_file);
 }
 
-/* Log to log_file and use the variable argument list. */
-void _log_va_formatted(const char *format, va_list list)
+/*****************
+ ** Log records **/
+
+/* the maximum number of bytes the arguments of a log line take up */
+#define LOG_RECORD_SIZE 1024
+
+/* the maximum length of a string that is copied into a log record */
+#define LOG_STRING_LENGTH 255
+
+/* the maximum length of an object formatted into a log record right away */
+#define LOG_TEXT_LENGTH 511
+
+/* a log line with its raw arguments, formatting happens later */
+struct log_record {
+    /* when the line was logged */
+    time_t time;
+    /* the format of the line, it also tells the call site */
+    const char *format;
+#ifdef DEBUG
+    /* the source file and line of the call site */
+    const char *file;
+    int line;
+#endif
+    /* the severity, `LOG_SEVERITY_NOTHING` for a line without prolog */
+    log_severity_t severity;
+    /* If strings and objects are copied into `data`.  Otherwise only pointers
+     * are stored and the record must be formatted before they become invalid.
+     */
+    bool is_copied;
+    /* if not all arguments fit into `data` */
+    bool is_truncated;
+    /* the number of bytes used within `data` */
+    size_t size;
+    /* the arguments in the order they appear in the format */
+    unsigned char data[LOG_RECORD_SIZE];
+};
+
+/* the kind of value a standard conversion specification takes */
+typedef enum {
+    /* a signed integer, stored as `intmax_t` */
+    LOG_VALUE_SIGNED,
+    /* an unsigned integer, stored as `uintmax_t` */
+    LOG_VALUE_UNSIGNED,
+    /* a character, stored as `intmax_t` */
+    LOG_VALUE_CHARACTER,
+    /* a floating point number, stored as `double` */
+    LOG_VALUE_DOUBLE,
+    /* a string */
+    LOG_VALUE_STRING,
+    /* a pointer, stored as `void*` */
+    LOG_VALUE_POINTER,
+} log_value_t;
+
+/* a standard printf conversion specification like `%-8.*lx` */
+struct conversion_specification {
+    /* the flags, width and precision as written */
+    const char *prefix;
+    int prefix_length;
+    /* if the width and precision are given as `*` argument */
+    bool has_width_argument;
+    bool has_precision_argument;
+    /* the length modifier like "l" or "zu" */
+    char length_modifier[3];
+    /* the conversion character */
+    char conversion;
+    /* the kind of value */
+    log_value_t value;
+    /* the number of characters after the `%` */
+    int length;
+};
+
+/* Parse the conversion specification after a `%` at @format.
+ *
+ * @return false if @format has no valid conversion specification.
+ */
+static bool parse_conversion_specification(const char *format,
+        struct conversion_specification *specification)
+{
+    const char *start = format;
+    int length = 0;
+
+    specification->prefix = format;
+    specification->has_width_argument = false;
+    specification->has_precision_argument = false;
+
+    while (strchr("-+ #0", format[0]) != NULL && format[0] != '\0') {
+        format++;
+    }
+    if (format[0] == '*') {
+        specification->has_width_argument = true;
+        format++;
+    } else {
+        while (format[0] >= '0' && format[0] <= '9') {
+            format++;
+        }
+    }
+    if (format[0] == '.') {
+        format++;
+        if (format[0] == '*') {
+            specification->has_precision_argument = true;
+            format++;
+        } else {
+            while (format[0] >= '0' && format[0] <= '9') {
+                format++;
+            }
+        }
+    }
+    specification->prefix_length = format - start;
+
+    while (strchr("hlzjtL", format[0]) != NULL && format[0] != '\0') {
+        if (length == sizeof(specification->length_modifier) - 1) {
+            return false;
+        }
+        specification->length_modifier[length] = format[0];
+        length++;
+        format++;
+    }
+    specification->length_modifier[length] = '\0';
+
+    specification->conversion = format[0];
+    switch (format[0]) {
+    case 'd':
+    case 'i':
+        specification->value = LOG_VALUE_SIGNED;
+        break;
+
+    case 'u':
+    case 'o':
+    case 'x':
+        specification->value = LOG_VALUE_UNSIGNED;
+        break;
+
+    case 'c':
+        specification->value = LOG_VALUE_CHARACTER;
+        break;
+
+    case 'f':
+    case 'e':
+    case 'g':
+        specification->value = LOG_VALUE_DOUBLE;
+        break;
+
+    case 's':
+        specification->value = LOG_VALUE_STRING;
+        break;
+
+    case 'p':
+        specification->value = LOG_VALUE_POINTER;
+        break;
+
+    default:
+        return false;
+    }
+    specification->length = format + 1 - start;
+    return true;
+}
+
+/* Put @size bytes of @value into @record. */
+static void put_log_value(struct log_record *record, const void *value,
+        size_t size)
 {
-    char buffer[64];
+    if (record->is_truncated || size > LOG_RECORD_SIZE - record->size) {
+        record->is_truncated = true;
+        return;
+    }
+    memcpy(&record->data[record->size], value, size);
+    record->size += size;
+}
+
+/* Put @value of @type into @record. */
+#define PUT_LOG_VALUE(record, type, value) do { \
+    const type _value = (value); \
+    put_log_value((record), &_value, sizeof(_value)); \
+} while (false)
+
+/* Get @size bytes at @offset within @record into @value.
+ *
+ * @return false if the record has no more values.
+ */
+static bool get_log_value(const struct log_record *record, size_t *offset,
+        void *value, size_t size)
+{
+    if (size > record->size - *offset) {
+        return false;
+    }
+    memcpy(value, &record->data[*offset], size);
+    *offset += size;
+    return true;
+}
+
+/* Put @string into @record, it is copied if the record wants that. */
+static void put_log_string(struct log_record *record, const char *string)
+{
+    size_t length;
+
+    if (!record->is_copied) {
+        PUT_LOG_VALUE(record, char*, string);
+        return;
+    }
+
+    length = string == NULL ? SIZE_MAX : strnlen(string, LOG_STRING_LENGTH);
+    PUT_LOG_VALUE(record, size_t, length);
+    if (string != NULL) {
+        put_log_value(record, string, length);
+        PUT_LOG_VALUE(record, char, '\0');
+    }
+}
+
+/* Get a string at @offset within @record.
+ *
+ * @return false if the record has no more values.
+ */
+static bool get_log_string(const struct log_record *record, size_t *offset,
+        const char **string)
+{
+    size_t length;
+
+    if (!record->is_copied) {
+        return get_log_value(record, offset, (void*) string, sizeof(*string));
+    }
+
+    if (!get_log_value(record, offset, &length, sizeof(length))) {
+        return false;
+    }
+    if (length == SIZE_MAX) {
+        *string = NULL;
+        return true;
+    }
+    if (length + 1 > record->size - *offset) {
+        return false;
+    }
+    *string = (const char*) &record->data[*offset];
+    *offset += length + 1;
+    return true;
+}
+
+/* Put an object that can only be formatted now into @record.
+ *
+ * @specifier is the format specifier of the object.
+ */
+static void put_log_object(struct log_record *record, char specifier,
+        const void *object)
+{
+    char text[LOG_TEXT_LENGTH + 1];
+    const char format[3] = { '%', specifier, '\0' };
+    FILE *previous_file;
+
+    if (!record->is_copied) {
+        PUT_LOG_VALUE(record, const void*, object);
+        return;
+    }
+
+    /* format the object into `text` */
+    previous_file = log_file;
+    log_file = fmemopen(text, sizeof(text), "w");
+    if (log_file == NULL) {
+        log_file = previous_file;
+        put_log_string(record, "<no memory>");
+        return;
+    }
+    log_directly(format, object);
+    fclose(log_file);
+    log_file = previous_file;
+
+    text[sizeof(text) - 1] = '\0';
+    put_log_string(record, text);
+}
+
+/* Put all arguments within @list described by @format into @record. */
+static void capture_log_arguments(struct log_record *record,
+        const char *format, va_list list)
+{
+    struct conversion_specification specification;
 
     for (; format[0] != '\0'; format++) {
-        if (format[0] == '%') {
-            switch (format[1]) {
-            case '%':
-                format++;
-                /* fall through */
-            case '\0':
-                fputc('%', log_file);
-                continue;
-
-            /* print a point */
-            case 'P': {
-                const int x = va_arg(list, int);
-                const int y = va_arg(list, int);
-                log_point(x, y);
-                break;
+        if (format[0] != '%') {
+            continue;
+        }
+
+        format++;
+        switch (format[0]) {
+        case '\0':
+            return;
+
+        case '%':
+            break;
+
+        case 'P':
+            PUT_LOG_VALUE(record, int, va_arg(list, int));
+            PUT_LOG_VALUE(record, int, va_arg(list, int));
+            break;
+
+        case 'S':
+            PUT_LOG_VALUE(record, unsigned, va_arg(list, unsigned));
+            PUT_LOG_VALUE(record, unsigned, va_arg(list, unsigned));
+            break;
+
+        case 'R':
+            PUT_LOG_VALUE(record, int, va_arg(list, int));
+            PUT_LOG_VALUE(record, int, va_arg(list, int));
+            PUT_LOG_VALUE(record, unsigned, va_arg(list, unsigned));
+            PUT_LOG_VALUE(record, unsigned, va_arg(list, unsigned));
+            break;
+
+        case 'b':
+            PUT_LOG_VALUE(record, int, va_arg(list, int));
+            break;
+
+        case 'w':
+            PUT_LOG_VALUE(record, Window, va_arg(list, Window));
+            break;
+
+        /* windows and frames are logged with a few values only, these are
+         * copied so the object may be gone when formatting
+         */
+        case 'W': {
+            const FcWindow *const window = va_arg(list, FcWindow*);
+
+            PUT_LOG_VALUE(record, Window, window->reference.id);
+            PUT_LOG_VALUE(record, unsigned, window->number);
+            break;
+        }
+
+        case 'm':
+            PUT_LOG_VALUE(record, window_mode_t,
+                    va_arg(list, window_mode_t));
+            break;
+
+        case 'F': {
+            const Frame *const frame = va_arg(list, Frame*);
+
+            PUT_LOG_VALUE(record, int, frame->x);
+            PUT_LOG_VALUE(record, int, frame->y);
+            PUT_LOG_VALUE(record, unsigned, frame->width);
+            PUT_LOG_VALUE(record, unsigned, frame->height);
+            PUT_LOG_VALUE(record, unsigned, frame->number);
+            break;
+        }
+
+        case 'V':
+            put_log_value(record, va_arg(list, XEvent*), sizeof(XEvent));
+            break;
+
+        case 'A':
+        case 'T':
+        case 'D':
+            put_log_object(record, format[0], va_arg(list, const void*));
+            break;
+
+        case 'a':
+            PUT_LOG_VALUE(record, Atom, va_arg(list, Atom));
+            break;
+
+        default:
+            if (!parse_conversion_specification(format, &specification)) {
+                return;
             }
+            format += specification.length - 1;
 
-            /* print a size */
-            case 'S': {
-                const unsigned width = va_arg(list, unsigned);
-                const unsigned height = va_arg(list, unsigned);
-                log_size(width, height);
-                break;
+            if (specification.has_width_argument) {
+                PUT_LOG_VALUE(record, int, va_arg(list, int));
+            }
+            if (specification.has_precision_argument) {
+                PUT_LOG_VALUE(record, int, va_arg(list, int));
             }
 
-            /* print a rectangle */
-            case 'R': {
-                const int x = va_arg(list, int);
-                const int y = va_arg(list, int);
-                const unsigned width = va_arg(list, unsigned);
-                const unsigned height = va_arg(list, unsigned);
-                log_rectangle(x, y, width, height);
+            switch (specification.value) {
+            case LOG_VALUE_SIGNED: {
+                const char *const modifier = specification.length_modifier;
+                intmax_t value;
+
+                if (strcmp(modifier, "hh") == 0) {
+                    value = (signed char) va_arg(list, int);
+                } else if (strcmp(modifier, "h") == 0) {
+                    value = (short) va_arg(list, int);
+                } else if (strcmp(modifier, "l") == 0) {
+                    value = va_arg(list, long);
+                } else if (strcmp(modifier, "ll") == 0) {
+                    value = va_arg(list, long long);
+                } else if (strcmp(modifier, "j") == 0) {
+                    value = va_arg(list, intmax_t);
+                } else if (strcmp(modifier, "z") == 0 ||
+                        strcmp(modifier, "t") == 0) {
+                    value = va_arg(list, ptrdiff_t);
+                } else {
+                    value = va_arg(list, int);
+                }
+                PUT_LOG_VALUE(record, intmax_t, value);
                 break;
             }
 
-            /* print a boolean */
-            case 'b':
-                log_boolean(va_arg(list, int));
+            case LOG_VALUE_UNSIGNED: {
+                const char *const modifier = specification.length_modifier;
+                uintmax_t value;
+
+                if (strcmp(modifier, "hh") == 0) {
+                    value = (unsigned char) va_arg(list, unsigned);
+                } else if (strcmp(modifier, "h") == 0) {
+                    value = (unsigned short) va_arg(list, unsigned);
+                } else if (strcmp(modifier, "l") == 0) {
+                    value = va_arg(list, unsigned long);
+                } else if (strcmp(modifier, "ll") == 0) {
+                    value = va_arg(list, unsigned long long);
+                } else if (strcmp(modifier, "j") == 0) {
+                    value = va_arg(list, uintmax_t);
+                } else if (strcmp(modifier, "z") == 0) {
+                    value = va_arg(list, size_t);
+                } else if (strcmp(modifier, "t") == 0) {
+                    value = va_arg(list, ptrdiff_t);
+                } else {
+                    value = va_arg(list, unsigned);
+                }
+                PUT_LOG_VALUE(record, uintmax_t, value);
                 break;
+            }
 
-            /* print an X window */
-            case 'w':
-                log_x_window(va_arg(list, Window));
+            case LOG_VALUE_CHARACTER:
+                PUT_LOG_VALUE(record, intmax_t, va_arg(list, int));
                 break;
 
-            /* print a window */
-            case 'W':
-                log_window(va_arg(list, FcWindow*));
+            case LOG_VALUE_DOUBLE:
+                if (strcmp(specification.length_modifier, "L") == 0) {
+                    PUT_LOG_VALUE(record, double, va_arg(list, long double));
+                } else {
+                    PUT_LOG_VALUE(record, double, va_arg(list, double));
+                }
                 break;
 
-            /* print a window mode */
-            case 'm':
-                log_window_mode(va_arg(list, window_mode_t));
+            case LOG_VALUE_STRING:
+                put_log_string(record, va_arg(list, const char*));
                 break;
 
-            /* print a frame */
-            case 'F':
-                log_frame(va_arg(list, Frame*));
+            case LOG_VALUE_POINTER:
+                PUT_LOG_VALUE(record, void*, va_arg(list, void*));
                 break;
+            }
+            break;
+        }
+    }
+}
 
-            /* print an X event */
-            case 'V':
-                log_event(va_arg(list, XEvent*));
-                break;
+/* Format a standard conversion at @offset within @record.
+ *
+ * @return false if the record has no more values.
+ */
+static bool log_conversion(const struct log_record *record, size_t *offset,
+        const struct conversion_specification *specification)
+{
+    char buffer[64];
+    int length;
+    int width, precision;
+    const char *prefix;
+    int prefix_length;
+    intmax_t signed_value;
+    uintmax_t unsigned_value;
+    double double_value;
+    const char *string;
+    void *pointer;
 
-            /* print a block of actions */
-            case 'A':
-                log_action_block(va_arg(list, const ActionBlock*));
-                break;
+    /* put the `*` arguments directly into the specification */
+    prefix = specification->prefix;
+    prefix_length = specification->prefix_length;
+    if (prefix_length > (int) sizeof(buffer) - 32) {
+        return false;
+    }
+    length = 0;
+    buffer[length++] = '%';
+    while (prefix_length > 0 && prefix[0] != '*' && prefix[0] != '.') {
+        buffer[length++] = prefix[0];
+        prefix++;
+        prefix_length--;
+    }
+    if (specification->has_width_argument) {
+        if (!get_log_value(record, offset, &width, sizeof(width))) {
+            return false;
+        }
+        length += sprintf(&buffer[length], "%d", width);
+        prefix++;
+        prefix_length--;
+    }
+    if (specification->has_precision_argument) {
+        if (!get_log_value(record, offset, &precision, sizeof(precision))) {
+            return false;
+        }
+        /* a negative precision is taken as if it was omitted */
+        if (precision >= 0) {
+            length += sprintf(&buffer[length], ".%d", precision);
+        }
+    } else {
+        memcpy(&buffer[length], prefix, prefix_length);
+        length += prefix_length;
+    }
 
-            /* print a parse data point */
-            case 'T':
-                log_action_data(va_arg(list, const struct action_data*));
-                break;
+    fputs(COLOR(GREEN), log_file);
+    switch (specification->value) {
+    case LOG_VALUE_SIGNED:
+        if (!get_log_value(record, offset, &signed_value,
+                    sizeof(signed_value))) {
+            return false;
+        }
+        sprintf(&buffer[length], "j%c", specification->conversion);
+        fprintf(log_file, buffer, signed_value);
+        break;
 
-            /* print an X atom */
-            case 'a':
-                log_atom(va_arg(list, Atom));
-                break;
+    case LOG_VALUE_UNSIGNED:
+        if (!get_log_value(record, offset, &unsigned_value,
+                    sizeof(unsigned_value))) {
+            return false;
+        }
+        sprintf(&buffer[length], "j%c", specification->conversion);
+        fprintf(log_file, buffer, unsigned_value);
+        break;
 
-            /* print display information */
-            case 'D':
-                log_display(va_arg(list, Display*));
-                break;
+    case LOG_VALUE_CHARACTER:
+        if (!get_log_value(record, offset, &signed_value,
+                    sizeof(signed_value))) {
+            return false;
+        }
+        sprintf(&buffer[length], "%c", specification->conversion);
+        fprintf(log_file, buffer, (int) signed_value);
+        break;
 
-            /* standard print format specifiers */
-            default: {
-                unsigned i = 0;
-
-                fputs(COLOR(GREEN), log_file);
-
-                /* move a segment of `format` into `buffer` and feed it into the
-                 * real `printf()`
-                 */
-                do {
-                    buffer[i] = format[i];
-                    if (strchr(PRINTF_FORMAT_SPECIFIERS, format[i]) != NULL) {
-                        buffer[i + 1] = '\0';
-                        vfprintf(log_file, buffer, list);
-                        fputs(CLEAR_COLOR, log_file);
-                        format += i - 1;
-                        /* all clean */
-                        i = 0;
-                        break;
-                    }
-                    i++;
-                } while (format[i] != '\0' && i < sizeof(buffer) - 2);
+    case LOG_VALUE_DOUBLE:
+        if (!get_log_value(record, offset, &double_value,
+                    sizeof(double_value))) {
+            return false;
+        }
+        sprintf(&buffer[length], "%c", specification->conversion);
+        fprintf(log_file, buffer, double_value);
+        break;
 
-                /* if anything is weird print the rest of the format string */
-                if (i > 0) {
-                    fputs(format, log_file);
-                    while (format[2] != '\0') {
-                        format++;
-                    }
+    case LOG_VALUE_STRING:
+        if (!get_log_string(record, offset, &string)) {
+            return false;
+        }
+        sprintf(&buffer[length], "%c", specification->conversion);
+        fprintf(log_file, buffer, string);
+        break;
+
+    case LOG_VALUE_POINTER:
+        if (!get_log_value(record, offset, &pointer, sizeof(pointer))) {
+            return false;
+        }
+        sprintf(&buffer[length], "%c", specification->conversion);
+        fprintf(log_file, buffer, pointer);
+        break;
+    }
+    fputs(CLEAR_COLOR, log_file);
+    return true;
+}
+
+/* Get a value of @type at the current offset within the record or stop
+ * formatting.
+ */
+#define GET_LOG_VALUE(value) \
+    if (!get_log_value(record, &offset, &(value), sizeof(value))) { \
+        break; \
+    }
+
+/* Format the arguments of @record to the log file. */
+static void log_record_arguments(const struct log_record *record)
+{
+    const char *format;
+    size_t offset = 0;
+    struct conversion_specification specification;
+    int integers[4];
+    unsigned number;
+    Window window;
+    Atom atom;
+    window_mode_t mode;
+    XEvent event;
+    const void *object;
+    const char *text;
+    bool has_value;
+
+    for (format = record->format; format[0] != '\0'; format++) {
+        if (format[0] != '%') {
+            fputc(format[0], log_file);
+            continue;
+        }
+
+        format++;
+        has_value = false;
+        switch (format[0]) {
+        case '%':
+        case '\0':
+            fputc('%', log_file);
+            if (format[0] == '\0') {
+                return;
+            }
+            continue;
+
+        /* print a point */
+        case 'P':
+            GET_LOG_VALUE(integers[0]);
+            GET_LOG_VALUE(integers[1]);
+            log_point(integers[0], integers[1]);
+            has_value = true;
+            break;
+
+        /* print a size */
+        case 'S':
+            GET_LOG_VALUE(integers[0]);
+            GET_LOG_VALUE(integers[1]);
+            log_size((unsigned) integers[0], (unsigned) integers[1]);
+            has_value = true;
+            break;
+
+        /* print a rectangle */
+        case 'R':
+            GET_LOG_VALUE(integers[0]);
+            GET_LOG_VALUE(integers[1]);
+            GET_LOG_VALUE(integers[2]);
+            GET_LOG_VALUE(integers[3]);
+            log_rectangle(integers[0], integers[1],
+                    (unsigned) integers[2], (unsigned) integers[3]);
+            has_value = true;
+            break;
+
+        /* print a boolean */
+        case 'b':
+            GET_LOG_VALUE(integers[0]);
+            log_boolean(integers[0]);
+            has_value = true;
+            break;
+
+        /* print an X window */
+        case 'w':
+            GET_LOG_VALUE(window);
+            log_x_window(window);
+            has_value = true;
+            break;
+
+        /* print a window */
+        case 'W':
+            GET_LOG_VALUE(window);
+            GET_LOG_VALUE(number);
+            log_window(window, number);
+            has_value = true;
+            break;
+
+        /* print a window mode */
+        case 'm':
+            GET_LOG_VALUE(mode);
+            log_window_mode(mode);
+            has_value = true;
+            break;
+
+        /* print a frame */
+        case 'F':
+            GET_LOG_VALUE(integers[0]);
+            GET_LOG_VALUE(integers[1]);
+            GET_LOG_VALUE(integers[2]);
+            GET_LOG_VALUE(integers[3]);
+            GET_LOG_VALUE(number);
+            log_frame(integers[0], integers[1],
+                    (unsigned) integers[2], (unsigned) integers[3], number);
+            has_value = true;
+            break;
+
+        /* print an X event */
+        case 'V':
+            GET_LOG_VALUE(event);
+            log_event(&event);
+            has_value = true;
+            break;
+
+        /* print a block of actions, a parse data point or display
+         * information
+         */
+        case 'A':
+        case 'T':
+        case 'D':
+            if (record->is_copied) {
+                if (!get_log_string(record, &offset, &text)) {
+                    break;
+                }
+                fputs(text, log_file);
+            } else {
+                GET_LOG_VALUE(object);
+                if (format[0] == 'A') {
+                    log_action_block(object);
+                } else if (format[0] == 'T') {
+                    log_action_data(object);
+                } else {
+                    log_display((Display*) object);
                 }
-                break;
             }
+            has_value = true;
+            break;
+
+        /* print an X atom */
+        case 'a':
+            GET_LOG_VALUE(atom);
+            log_atom(atom);
+            has_value = true;
+            break;
+
+        /* standard print format specifiers */
+        default:
+            if (!parse_conversion_specification(format, &specification)) {
+                /* if anything is weird print the rest of the format string */
+                fprintf(log_file, "%%%s", format);
+                return;
             }
-            format++;
-        } else {
-            fputc(format[0], log_file);
+            has_value = log_conversion(record, &offset, &specification);
+            format += specification.length - 1;
+            break;
+        }
+
+        /* the arguments did not fit into the record */
+        if (!has_value) {
+            fputs(COLOR(RED) "<truncated>" CLEAR_COLOR "\n", log_file);
+            return;
         }
     }
 }
 
+#undef GET_LOG_VALUE
+
+/* Format @record with its prolog to the log file. */
+static void log_record(const struct log_record *record)
+{
+    char buffer[64];
+    struct tm *tm;
+
+    if (record->severity != LOG_SEVERITY_NOTHING) {
+        /* print the time and file with line number at the front */
+        tm = localtime(&record->time);
+        strftime(buffer, sizeof(buffer),
+                record->severity == LOG_SEVERITY_ERROR ?
+                    COLOR(RED) "{%F %T} " : COLOR(GREEN) "[%F %T] ", tm);
+        fputs(buffer, log_file);
+#ifdef DEBUG
+        fprintf(log_file, COLOR(YELLOW) "(%s:%d) " CLEAR_COLOR,
+                record->file, record->line);
+#endif
+    }
+
+    log_record_arguments(record);
+}
+
+/* Format @format with the variable argument list right away. */
+static void log_directly(const char *format, ...)
+{
+    struct log_record record;
+    va_list list;
+
+    record.format = format;
+    record.severity = LOG_SEVERITY_NOTHING;
+    record.is_copied = false;
+    record.is_truncated = false;
+    record.size = 0;
+
+    va_start(list, format);
+    capture_log_arguments(&record, format, list);
+    va_end(list);
+
+    log_record_arguments(&record);
+}
+
+/**************
+ ** Log ring **/
+
+/* the header in front of every record within the log ring */
+struct log_ring_entry {
+    /* the number of bytes the entry takes up including this header */
+    uint32_t size;
+    /* if the entry only fills the end of the ring and has no record */
+    uint32_t is_padding;
+};
+
+/* the bytes within a record that are always stored */
+#define LOG_RECORD_HEADER_SIZE offsetof(struct log_record, data)
+
+/* Round @size up to a multiple of 8 so that all entries stay aligned. */
+#define ALIGN_LOG_SIZE(size) (((size) + 7) / 8 * 8)
+
+/* The log ring keeps the last log lines as raw records in memory.  Positions
+ * only grow, the place within `data` is the position modulo the size.
+ */
+static struct {
+    /* the memory of the ring, NULL if the log ring is not used */
+    unsigned char *data;
+    /* the number of bytes in `data` */
+    size_t size;
+    /* the position of the oldest entry */
+    uint64_t tail;
+    /* the position where the next entry goes */
+    uint64_t head;
+} log_ring;
+
+/* Start keeping log lines in the log ring. */
+void start_log_ring(size_t size)
+{
+    /* a record must always fit with room to spare */
+    size = MAX(ALIGN_LOG_SIZE(size), 4 * ALIGN_LOG_SIZE(
+                sizeof(struct log_ring_entry) + sizeof(struct log_record)));
+
+    xfree(log_ring.data);
+    log_ring.data = xmalloc(size);
+    log_ring.size = size;
+    log_ring.tail = 0;
+    log_ring.head = 0;
+}
+
+/* Check if log lines are kept in the log ring. */
+bool is_log_ring_used(void)
+{
+    return log_ring.data != NULL;
+}
+
+/* Get the entry at @position within the log ring. */
+static struct log_ring_entry *get_log_ring_entry(uint64_t position)
+{
+    return (struct log_ring_entry*) &log_ring.data[position % log_ring.size];
+}
+
+/* Make space for @size bytes at the head of the log ring. */
+static void reserve_log_ring(size_t size)
+{
+    while (log_ring.head + size - log_ring.tail > log_ring.size) {
+        log_ring.tail += get_log_ring_entry(log_ring.tail)->size;
+    }
+}
+
+/* Put @record at the head of the log ring, overwriting the oldest records. */
+static void put_log_ring_record(const struct log_record *record)
+{
+    const size_t size = ALIGN_LOG_SIZE(sizeof(struct log_ring_entry) +
+            LOG_RECORD_HEADER_SIZE + record->size);
+    const size_t end_size = log_ring.size - log_ring.head % log_ring.size;
+    struct log_ring_entry *entry;
+
+    /* entries are never split, fill the end if the record does not fit */
+    if (end_size < size) {
+        reserve_log_ring(end_size);
+        entry = get_log_ring_entry(log_ring.head);
+        entry->size = end_size;
+        entry->is_padding = true;
+        log_ring.head += end_size;
+    }
+
+    reserve_log_ring(size);
+    entry = get_log_ring_entry(log_ring.head);
+    entry->size = size;
+    entry->is_padding = false;
+    memcpy(entry + 1, record, LOG_RECORD_HEADER_SIZE + record->size);
+    log_ring.head += size;
+}
+
+/* Format all records within the log ring into @file. */
+void write_log_ring(FILE *file)
+{
+    FILE *previous_file;
+    const struct log_ring_entry *entry;
+    struct log_record record;
+
+    previous_file = log_file;
+    log_file = file;
+    for (uint64_t position = log_ring.tail;
+            position != log_ring.head;
+            position += entry->size) {
+        entry = get_log_ring_entry(position);
+        if (entry->is_padding) {
+            continue;
+        }
+        memcpy(&record, entry + 1,
+                entry->size - sizeof(*entry) < sizeof(record) ?
+                    entry->size - sizeof(*entry) : sizeof(record));
+        log_record(&record);
+    }
+    log_file = previous_file;
+}
+
+/* Call @callback with the time and format of all records within the log ring,
+ * oldest first.
+ */
+void walk_log_ring(void (*callback)(time_t time, const char *format))
+{
+    const struct log_ring_entry *entry;
+    const struct log_record *record;
+
+    for (uint64_t position = log_ring.tail;
+            position != log_ring.head;
+            position += entry->size) {
+        entry = get_log_ring_entry(position);
+        /* the ring might be cut off in the middle of an update */
+        if (entry->size == 0 || entry->size > log_ring.size) {
+            break;
+        }
+        if (entry->is_padding) {
+            continue;
+        }
+        record = (const struct log_record*) (entry + 1);
+        callback(record->time, record->format);
+    }
+}
+
+/**********************
+ ** Public interface **/
+
+/* Capture a log line and either format it right away or put it into the log
+ * ring.
+ */
+static void log_line(struct log_record *record, va_list list)
+{
+    record->time = time(NULL);
+    record->is_copied = is_log_ring_used();
+    record->is_truncated = false;
+    record->size = 0;
+    capture_log_arguments(record, record->format, list);
+
+    if (record->is_copied) {
+        put_log_ring_record(record);
+        /* errors should still be seen right away */
+        if (record->severity != LOG_SEVERITY_ERROR) {
+            return;
+        }
+    }
+    log_record(record);
+}
+
 /* Print a formatted string to standard error output. */
 #ifdef DEBUG
 void _log_formatted(log_severity_t severity, const char *file, int line,
         const char *format, ...)
 {
+    struct log_record record;
     va_list list;
-    char buffer[64];
-    time_t current_time;
-    struct tm *tm;
 
     /* omit logging if not severe enough */
     if (log_severity > severity) {
         return;
     }
 
-    /* print the time and file with line number at the front */
-    current_time = time(NULL);
-    tm = localtime(&current_time);
-    strftime(buffer, sizeof(buffer),
-            severity == LOG_SEVERITY_ERROR ? COLOR(RED) "{%F %T} " :
-                COLOR(GREEN) "[%F %T] ", tm);
-    fprintf(log_file, "%s" COLOR(YELLOW) "(%s:%d) " CLEAR_COLOR,
-            buffer, file, line);
-
-    /* parse the format string */
+    record.format = format;
+    record.file = file;
+    record.line = line;
+    record.severity = severity;
     va_start(list, format);
-    _log_va_formatted(format, list);
+    log_line(&record, list);
     va_end(list);
 }
 #else
 void _log_formatted(log_severity_t severity, const char *format, ...)
 {
+    struct log_record record;
     va_list list;
-    char buffer[64];
-    time_t current_time;
-    struct tm *tm;
 
     /* omit logging if not severe enough */
     if (log_severity > severity) {
         return;
     }
 
-    /* print the time and file with line number at the front */
-    current_time = time(NULL);
-    tm = localtime(&current_time);
-    strftime(buffer, sizeof(buffer),
-            severity == LOG_SEVERITY_ERROR ? COLOR(RED) "{%F %T} " :
-                COLOR(GREEN) "[%F %T] ", tm);
-    fputs(buffer, log_file);
-
-    /* parse the format string */
+    record.format = format;
+    record.severity = severity;
     va_start(list, format);
-    _log_va_formatted(format, list);
+    log_line(&record, list);
     va_end(list);
 }
 #endif
@@ -1541,9 +2324,39 @@ void _log_formatted(log_severity_t severity, const char *format, ...)
 /* Same as above but write no prolog. */
 void log_formatted(const char *format, ...)
 {
+    struct log_record record;
     va_list list;
 
+    record.format = format;
+#ifdef DEBUG
+    record.file = NULL;
+    record.line = 0;
+#endif
+    record.severity = LOG_SEVERITY_NOTHING;
     va_start(list, format);
-    _log_va_formatted(format, list);
+    log_line(&record, list);
     va_end(list);
 }
+
+/* Format a line without prolog into @file right away. */
+void write_formatted(FILE *file, const char *format, ...)
+{
+    struct log_record record;
+    FILE *previous_file;
+    va_list list;
+
+    record.format = format;
+    record.severity = LOG_SEVERITY_NOTHING;
+    record.is_copied = false;
+    record.is_truncated = false;
+    record.size = 0;
+
+    va_start(list, format);
+    capture_log_arguments(&record, format, list);
+    va_end(list);
+
+    previous_file = log_file;
+    log_file = file;
+    log_record_arguments(&record);
+    log_file = previous_file;
+}
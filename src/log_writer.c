@@ -0,0 +1,416 @@
+#define _GNU_SOURCE /* fopencookie() */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_writer.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+/* the maximum length of the path of a log file */
+#define LOG_PATH_SIZE 1024
+
+/* the number of times `flush_log_writer()` checks if the writer is done */
+#define LOG_FLUSH_ATTEMPTS 100
+
+/* the nanoseconds `flush_log_writer()` waits between the checks */
+#define LOG_FLUSH_INTERVAL 10000000
+
+/* the state of the log writer */
+static struct {
+    /* the stream given out to write into the queue */
+    FILE *stream;
+    /* the directory the log files go into */
+    char *directory;
+    /* the size after which a new log file is started */
+    size_t maximum_size;
+    /* the number of log files to keep */
+    unsigned retention;
+
+    /* the path of the current log file */
+    char path[LOG_PATH_SIZE];
+    /* the time within the name of the current log file */
+    char time_name[32];
+    /* the counter appended to the name of the current log file */
+    unsigned time_counter;
+    /* the current log file, this is NULL if it could not be opened */
+    FILE *file;
+    /* the number of bytes written into the current log file */
+    size_t file_size;
+
+    /* the queued bytes */
+    char queue[LOG_QUEUE_SIZE];
+    /* the absolute position the next byte is queued at, only the producer
+     * moves it
+     */
+    size_t head;
+    /* the absolute position of the next byte to write out, only the writer
+     * thread moves it
+     */
+    size_t tail;
+    /* the absolute position up to which the bytes are flushed into the log
+     * file, only the writer thread moves it
+     */
+    size_t flushed;
+    /* the number of bytes dropped because the queue was full */
+    size_t dropped_count;
+    /* true when the stream was closed and the writer thread should stop */
+    bool is_stopping;
+
+    /* posted when something new is queued */
+    sem_t semaphore;
+    /* the writer thread */
+    pthread_t thread;
+} log_writer;
+
+/* Open a new log file named after the current time.
+ *
+ * If a file with the same name exists (a second file within the same second),
+ * a counter is appended.
+ *
+ * @return ERROR if the file could not be opened.
+ */
+static int open_new_log_file(void)
+{
+    time_t current_time;
+    struct tm tm;
+    char name[32];
+    unsigned counter;
+    int length;
+    int descriptor = -1;
+
+    current_time = time(NULL);
+    localtime_r(&current_time, &tm);
+    strftime(name, sizeof(name), "%F_%T", &tm);
+
+    /* continue counting so a name removed in between is not used again */
+    if (strcmp(name, log_writer.time_name) == 0) {
+        counter = log_writer.time_counter + 1;
+    } else {
+        strcpy(log_writer.time_name, name);
+        counter = 0;
+    }
+
+    for (; descriptor == -1; counter++) {
+        if (counter == 0) {
+            length = snprintf(log_writer.path, sizeof(log_writer.path),
+                    "%s/%s.log", log_writer.directory, name);
+        } else {
+            length = snprintf(log_writer.path, sizeof(log_writer.path),
+                    "%s/%s_%03u.log", log_writer.directory, name, counter);
+        }
+        if (length < 0 || (size_t) length >= sizeof(log_writer.path)) {
+            fprintf(stderr, "log directory path is too long\n");
+            return ERROR;
+        }
+
+        descriptor = open(log_writer.path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (descriptor == -1 && (errno != EEXIST || counter >= 999)) {
+            fprintf(stderr, "could not open log file \"%s\": %s\n",
+                    log_writer.path, strerror(errno));
+            return ERROR;
+        }
+    }
+
+    log_writer.time_counter = counter - 1;
+
+    log_writer.file = fdopen(descriptor, "w");
+    if (log_writer.file == NULL) {
+        close(descriptor);
+        return ERROR;
+    }
+    log_writer.file_size = 0;
+    return OK;
+}
+
+/* Remove the oldest log files until only the configured number is left.
+ *
+ * The file names start with the time so the oldest file has the smallest
+ * name.
+ */
+static void remove_old_log_files(void)
+{
+    DIR *directory;
+    struct dirent *entry;
+    const char *current_name;
+    char oldest[256];
+    char path[LOG_PATH_SIZE];
+    unsigned count;
+    size_t length;
+
+    directory = opendir(log_writer.directory);
+    if (directory == NULL) {
+        return;
+    }
+
+    current_name = strrchr(log_writer.path, '/') + 1;
+    while (true) {
+        count = 0;
+        oldest[0] = '\0';
+        rewinddir(directory);
+        while (entry = readdir(directory), entry != NULL) {
+            length = strlen(entry->d_name);
+            if (length < 4 || length >= sizeof(oldest) ||
+                    strcmp(&entry->d_name[length - 4], ".log") != 0) {
+                continue;
+            }
+            count++;
+            if (strcmp(entry->d_name, current_name) == 0) {
+                continue;
+            }
+            if (oldest[0] == '\0' || strcmp(entry->d_name, oldest) < 0) {
+                memcpy(oldest, entry->d_name, length + 1);
+            }
+        }
+
+        if (count <= log_writer.retention || oldest[0] == '\0') {
+            break;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", log_writer.directory, oldest);
+        if (remove(path) != 0) {
+            break;
+        }
+    }
+    closedir(directory);
+}
+
+/* Write @data into the log files.
+ *
+ * When the current log file would grow beyond its maximum size, the output is
+ * cut after the last complete line and continued in a new log file.
+ */
+static void write_to_log_files(const char *data, size_t length)
+{
+    size_t fitting;
+
+    /* if there is no log file, the output is lost */
+    while (length > 0 && log_writer.file != NULL) {
+        if (log_writer.file_size + length <= log_writer.maximum_size) {
+            fitting = length;
+        } else {
+            fitting = 0;
+            if (log_writer.file_size < log_writer.maximum_size) {
+                fitting = log_writer.maximum_size - log_writer.file_size;
+            }
+            while (fitting > 0 && data[fitting - 1] != '\n') {
+                fitting--;
+            }
+            /* a line longer than a whole file can not be cut nicely */
+            if (fitting == 0 && log_writer.file_size == 0) {
+                fitting = length;
+            }
+        }
+
+        fwrite(data, 1, fitting, log_writer.file);
+        log_writer.file_size += fitting;
+        data += fitting;
+        length -= fitting;
+
+        if (length > 0) {
+            fclose(log_writer.file);
+            log_writer.file = NULL;
+            if (open_new_log_file() == OK) {
+                remove_old_log_files();
+            }
+        }
+    }
+}
+
+/* Write out the queue until the stream is closed. */
+static void *run_log_writer(void *data)
+{
+    bool is_stopping;
+    size_t head, tail;
+    size_t offset, length;
+    size_t dropped_count;
+    char note[64];
+
+    (void) data;
+
+    tail = log_writer.tail;
+    do {
+        while (sem_wait(&log_writer.semaphore) == -1 && errno == EINTR) {
+            /* nothing */
+        }
+
+        /* load this first so everything queued before stopping is seen */
+        is_stopping = __atomic_load_n(&log_writer.is_stopping,
+                __ATOMIC_ACQUIRE);
+        head = __atomic_load_n(&log_writer.head, __ATOMIC_ACQUIRE);
+
+        /* try again if a new log file could not be opened before */
+        if (log_writer.file == NULL && tail != head &&
+                open_new_log_file() == OK) {
+            remove_old_log_files();
+        }
+
+        while (tail != head) {
+            offset = tail % LOG_QUEUE_SIZE;
+            length = MIN(head - tail, LOG_QUEUE_SIZE - offset);
+            write_to_log_files(&log_writer.queue[offset], length);
+            tail += length;
+            __atomic_store_n(&log_writer.tail, tail, __ATOMIC_RELEASE);
+        }
+
+        dropped_count = __atomic_exchange_n(&log_writer.dropped_count, 0,
+                __ATOMIC_RELAXED);
+        if (dropped_count > 0) {
+            length = snprintf(note, sizeof(note),
+                    "[%zu bytes of log output were dropped]\n",
+                    dropped_count);
+            write_to_log_files(note, length);
+        }
+
+        if (log_writer.file != NULL) {
+            fflush(log_writer.file);
+        }
+        __atomic_store_n(&log_writer.flushed, tail, __ATOMIC_RELEASE);
+    } while (!is_stopping);
+
+    return NULL;
+}
+
+/* Put @data into the queue.
+ *
+ * This never waits for the writer thread, if the queue is full, @data is
+ * dropped.
+ */
+static ssize_t write_log_queue(void *cookie, const char *data, size_t size)
+{
+    size_t head, tail;
+    size_t offset, length;
+
+    (void) cookie;
+
+    head = log_writer.head;
+    tail = __atomic_load_n(&log_writer.tail, __ATOMIC_ACQUIRE);
+    if (size > LOG_QUEUE_SIZE - (head - tail)) {
+        __atomic_add_fetch(&log_writer.dropped_count, size, __ATOMIC_RELAXED);
+    } else {
+        offset = head % LOG_QUEUE_SIZE;
+        length = MIN(size, LOG_QUEUE_SIZE - offset);
+        memcpy(&log_writer.queue[offset], data, length);
+        memcpy(log_writer.queue, &data[length], size - length);
+        __atomic_store_n(&log_writer.head, head + size, __ATOMIC_RELEASE);
+    }
+
+    sem_post(&log_writer.semaphore);
+    /* even dropped data counts as written, otherwise the stream would go into
+     * an error state
+     */
+    return size;
+}
+
+/* Wait until the writer thread wrote out everything queued. */
+void flush_log_writer(void)
+{
+    const struct timespec interval = { .tv_nsec = LOG_FLUSH_INTERVAL };
+    size_t head;
+
+    if (log_writer.stream == NULL) {
+        return;
+    }
+
+    head = __atomic_load_n(&log_writer.head, __ATOMIC_ACQUIRE);
+    sem_post(&log_writer.semaphore);
+    for (unsigned i = 0; i < LOG_FLUSH_ATTEMPTS; i++) {
+        if (__atomic_load_n(&log_writer.flushed, __ATOMIC_ACQUIRE) >= head) {
+            break;
+        }
+        nanosleep(&interval, NULL);
+    }
+}
+
+/* Write out everything queued and stop the writer thread. */
+static int close_log_queue(void *cookie)
+{
+    (void) cookie;
+
+    __atomic_store_n(&log_writer.is_stopping, true, __ATOMIC_RELEASE);
+    sem_post(&log_writer.semaphore);
+    pthread_join(log_writer.thread, NULL);
+    sem_destroy(&log_writer.semaphore);
+
+    if (log_writer.file != NULL) {
+        fclose(log_writer.file);
+        log_writer.file = NULL;
+    }
+    xfree(log_writer.directory);
+    log_writer.directory = NULL;
+    log_writer.stream = NULL;
+    return 0;
+}
+
+/* Close the log writer stream if it is still open. */
+static void close_log_writer_at_exit(void)
+{
+    if (log_writer.stream != NULL) {
+        fclose(log_writer.stream);
+    }
+}
+
+/* Open the first log file in @directory and start the writer thread. */
+FILE *open_log_writer(const char *directory, size_t maximum_size,
+        unsigned retention, _Out char **path)
+{
+    static bool is_exit_handler_set;
+
+    const cookie_io_functions_t functions = {
+        .write = write_log_queue,
+        .close = close_log_queue,
+    };
+
+    log_writer.directory = xstrdup(directory);
+    log_writer.maximum_size = maximum_size;
+    log_writer.retention = retention;
+    log_writer.head = 0;
+    log_writer.tail = 0;
+    log_writer.flushed = 0;
+    log_writer.dropped_count = 0;
+    log_writer.is_stopping = false;
+
+    if (open_new_log_file() != OK) {
+        xfree(log_writer.directory);
+        log_writer.directory = NULL;
+        return NULL;
+    }
+    remove_old_log_files();
+
+    sem_init(&log_writer.semaphore, 0, 0);
+    if (pthread_create(&log_writer.thread, NULL, run_log_writer,
+                NULL) != 0) {
+        fprintf(stderr, "could not start the log writer thread\n");
+        sem_destroy(&log_writer.semaphore);
+        fclose(log_writer.file);
+        log_writer.file = NULL;
+        xfree(log_writer.directory);
+        log_writer.directory = NULL;
+        return NULL;
+    }
+
+    log_writer.stream = fopencookie(NULL, "w", functions);
+    if (log_writer.stream == NULL) {
+        /* this stops the thread and closes the file */
+        (void) close_log_queue(NULL);
+        return NULL;
+    }
+
+    /* make sure queued output is written when exiting from anywhere */
+    if (!is_exit_handler_set) {
+        atexit(close_log_writer_at_exit);
+        is_exit_handler_set = true;
+    }
+
+    setvbuf(log_writer.stream, NULL, _IOLBF, 0);
+    *path = xstrdup(log_writer.path);
+    return log_writer.stream;
+}
@@ -1,12 +1,15 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <sys/stat.h>
-#include <time.h>
 
+#include "bar.h"
 #include "configuration.h"
 #include "event.h"
+#include "flight_recorder.h"
+#include "ipc.h"
 #include "fensterchef.h"
 #include "log.h"
+#include "log_writer.h"
 #include "monitor.h"
 #include "utility/list.h"
 #include "x11/display.h"
@@ -19,6 +22,7 @@ typedef enum program_option {
     PROGRAM_OPTION_VERSION, /* -v, --version */
     PROGRAM_OPTION_VERBOSITY, /* -d, --verbosity VERBOSITY */
     PROGRAM_OPTION_VERBOSE, /* --verbose */
+    PROGRAM_OPTION_LOG_RING, /* --log-ring SIZE */
     PROGRAM_OPTION_CONFIG, /* --config FILE */
     PROGRAM_OPTION_COMMAND, /* -e, --command COMMAND... */
 } program_option_t;
@@ -39,6 +43,7 @@ static const struct program_parse_option {
     [PROGRAM_OPTION_VERSION] = { 'v', "version", 0 },
     [PROGRAM_OPTION_VERBOSITY] = { 'd', "verbosity", 1 },
     [PROGRAM_OPTION_VERBOSE] = { '\0', "verbose", 0 },
+    [PROGRAM_OPTION_LOG_RING] = { '\0', "log-ring", 1 },
     [PROGRAM_OPTION_CONFIG] = { '\0', "config", 1 },
     [PROGRAM_OPTION_COMMAND] = { 'e', "command", 1 },
 };
@@ -64,6 +69,7 @@ static void print_usage(int exit_code)
             error                   only log errors\n\
             nothing                 log nothing\n\
         --verbose                   log everything\n\
+        --log-ring      SIZE        keep the log in memory, SIZE is in KiB\n\
         --config        FILE        set the path of the configuration\n\
         -e, --command   COMMAND     run a command within fensterchef\n",
         stderr);
@@ -122,9 +128,23 @@ static void handle_program_option(program_option_t option, char *value)
         log_severity = LOG_SEVERITY_ALL;
         break;
 
+    /* keep log lines in memory */
+    case PROGRAM_OPTION_LOG_RING: {
+        char *end;
+        unsigned long size;
+
+        size = strtoul(value, &end, 10);
+        if (end == value || end[0] != '\0' || size == 0) {
+            fprintf(stderr, "invalid log ring size: %s\n", value);
+            exit(EXIT_FAILURE);
+        }
+        start_log_ring(size * 1024);
+        break;
+    }
+
     /* set the configuration */
     case PROGRAM_OPTION_CONFIG:
-        free(Fensterchef_configuration);
+        xfree(Fensterchef_configuration);
         Fensterchef_configuration = xstrdup(value);
         break;
 
@@ -263,7 +283,7 @@ void parse_program_arguments(void)
     }
 }
 
-/* Open the next log file.
+/* Open the next log file and start writing to it in the background.
  *
  * @return ERROR if the log file could not be opened.
  */
@@ -271,8 +291,6 @@ static int open_next_log_file(void)
 {
     const char *xdg_state_home;
     LIST(char, path);
-    time_t current_time;
-    struct tm *tm;
 
     if (log_severity == LOG_SEVERITY_NOTHING) {
         return ERROR;
@@ -293,7 +311,7 @@ static int open_next_log_file(void)
     if (mkdir(path, 0755) == -1 && errno != EEXIST) {
         fprintf(stderr, "could not create log directory \"%s\": %s\n",
                 path, strerror(errno));
-        free(path);
+        xfree(path);
         return ERROR;
     }
 
@@ -303,32 +321,20 @@ static int open_next_log_file(void)
     if (mkdir(path, 0755) == -1 && errno != EEXIST) {
         fprintf(stderr, "could not create log directory \"%s\": %s\n",
                 path, strerror(errno));
-        free(path);
+        xfree(path);
         return ERROR;
     }
 
-    LIST_GROW(path, path_length + 64);
-    current_time = time(NULL);
-    tm = localtime(&current_time);
-    path_length += strftime(&path[path_length], 64, "/%F_%T.log", tm) + 1;
-
-    log_file = fopen(path, "w");
+    log_file = open_log_writer(path, LOG_FILE_MAXIMUM_SIZE,
+            LOG_FILE_RETENTION, &log_file_path);
+    xfree(path);
     if (log_file == NULL) {
-        fprintf(stderr, "could not open log file \"%s\": %s\n",
-                path, strerror(errno));
-        free(path);
         return ERROR;
-    } else {
-        LOG("parsed arguments, starting to log to %s\n",
-                path);
-
-        /* trim the memory */
-        REALLOCATE(path, path_length);
-
-        log_file_path = path;
-        setvbuf(log_file, NULL, _IOLBF, 0);
-        return OK;
     }
+
+    LOG("parsed arguments, starting to log to %s\n",
+            log_file_path);
+    return OK;
 }
 
 /* FENSTERCHEF main entry point. */
@@ -353,6 +359,7 @@ int main(int argc, char **argv)
         log_file = stderr;
     }
 #endif
+    prepare_crash_report();
 
     LOG("welcome to " COLOR(YELLOW) FENSTERCHEF_NAME " " COLOR(GREEN)
                 FENSTERCHEF_VERSION CLEAR_COLOR "\n");
@@ -370,6 +377,9 @@ int main(int argc, char **argv)
     /* try to take control of the window manager role */
     take_control();
 
+    /* listen for commands from other programs */
+    (void) start_ipc_server();
+
     /* initialize randr if possible and the initial monitors with their
      * root frames
      */
@@ -395,6 +405,9 @@ int main(int argc, char **argv)
     /* do an inital synchronization */
     synchronize_with_server();
 
+    /* show the bar if it is enabled */
+    update_bars();
+
     /* run the main event loop */
     run_event_loop();
 }
@@ -3,6 +3,7 @@
 
 #include <X11/extensions/Xrandr.h>
 
+#include "bar.h"
 #include "configuration.h"
 #include "frame.h"
 #include "log.h"
@@ -173,8 +174,8 @@ Monitor *query_monitors(void)
                     next->name, monitor->name);
 
             previous->next = next->next;
-            free(next->name);
-            free(next);
+            xfree(next->name);
+            xfree(next);
 
             next = previous;
         }
@@ -664,8 +665,8 @@ void merge_monitors(Monitor *monitors)
             stash_frame(monitor->frame);
             destroy_frame(monitor->frame);
         }
-        free(monitor->name);
-        free(monitor);
+        xfree(monitor->name);
+        xfree(monitor);
     }
 
     Monitor_first = monitors;
@@ -775,11 +776,13 @@ static void push_other_dock_windows(Monitor *monitor, FcWindow *window)
 void reconfigure_monitor_frames(void)
 {
     Monitor *monitor;
+    unsigned bar_height;
 
-    /* reset all struts before recomputing */
+    /* reset all struts before recomputing, the bar is at the top */
+    bar_height = get_bar_height();
     for (monitor = Monitor_first; monitor != NULL; monitor = monitor->next) {
         monitor->strut.left = 0;
-        monitor->strut.top = 0;
+        monitor->strut.top = bar_height;
         monitor->strut.right = 0;
         monitor->strut.bottom = 0;
     }
@@ -68,7 +68,7 @@ Notification *create_notification(void)
     ALLOCATE_ZERO(notification, 1);
 
     if (initialize_notification(notification) == ERROR) {
-        free(notification);
+        xfree(notification);
         return NULL;
     }
 
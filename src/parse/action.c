@@ -9,18 +9,63 @@
 #include "parse/utility.h"
 #include "utility/utility.h"
 
-/* Find a section in the action strings that match the string loaded into
- * @parser.
+/* the size of the action word table, it must be larger than the number of
+ * different first words of all actions
+ */
+#define PARSE_ACTION_WORD_TABLE_SIZE 128
+
+/* table of the first words of all actions */
+static struct parse_action_word {
+    /* the word within the action string, NULL if the slot is free */
+    const char *word;
+    /* the length of the word */
+    unsigned length;
+    /* the first and last (exclusive) action starting with this word */
+    action_type_t first_action, last_action;
+} action_word_table[PARSE_ACTION_WORD_TABLE_SIZE];
+
+/* the index of the first word of each action within the action word table */
+static unsigned char action_word_indexes[ACTION_SIMPLE_MAX];
+
+/* Get the index where the action word @word with @length is supposed to be. */
+static unsigned get_action_word_index(const char *word, unsigned length)
+{
+    unsigned hash = 1731;
+    unsigned probe = 0;
+    unsigned index;
+
+    for (unsigned i = 0; i < length; i++) {
+        hash = hash * 407 + (unsigned char) word[i];
+    }
+
+    do {
+        index = hash + (probe * probe + probe) / 2;
+        index %= PARSE_ACTION_WORD_TABLE_SIZE;
+        probe++;
+    } while (action_word_table[index].word != NULL &&
+            (action_word_table[index].length != length ||
+                memcmp(action_word_table[index].word, word, length) != 0));
+
+    return index;
+}
+
+/* Put the first words of all action strings into the action word table.
  *
- * @return ERROR if no action matches.
+ * The table only depends on the action strings so it is only made once.
  */
-static int resolve_action_word(Parser *parser, struct parse_action_block *block)
+static void initialize_action_word_table(void)
 {
-    action_type_t count = 0;
+    static bool is_initialized;
+
+    if (is_initialized) {
+        return;
+    }
+    is_initialized = true;
 
     for (action_type_t i = 0; i < ACTION_SIMPLE_MAX; i++) {
-        const char *action, *space;
-        unsigned skip_length;
+        const char *action;
+        unsigned length;
+        unsigned index;
 
         action = get_action_string(i);
         if (action == NULL) {
@@ -28,39 +73,60 @@ static int resolve_action_word(Parser *parser, struct parse_action_block *block)
             continue;
         }
 
-        /* get the end of the next action word of the action string */
-        space = strchr(action, ' ');
-        if (space == NULL) {
-            skip_length = strlen(action);
-            space = action + skip_length;
-        } else {
-            skip_length = space - action + 1;
+        for (length = 0; action[length] != ' ' && action[length] != '\0';
+                length++) {
+            /* nothing */
         }
 
-        if (parser->string_length == (size_t) (space - action) &&
-                memcmp(action, parser->string,
-                    parser->string_length) == 0) {
-            if (count == 0) {
-                block->first_action = i;
-            }
+        index = get_action_word_index(action, length);
+        if (action_word_table[index].word == NULL) {
+            action_word_table[index].word = action;
+            action_word_table[index].length = length;
+            action_word_table[index].first_action = i;
+        }
+        action_word_table[index].last_action = i + 1;
+        action_word_indexes[i] = index;
+    }
+}
+
+/* Find the actions whose first word is the string loaded into @parser.
+ *
+ * @return ERROR if no action matches.
+ */
+static int resolve_action_word(Parser *parser, struct parse_action_block *block)
+{
+    const struct parse_action_word *word;
+    unsigned index;
 
-            count++;
+    initialize_action_word_table();
 
-            block->last_action = i + 1;
+    index = get_action_word_index(parser->string, parser->string_length);
+    word = &action_word_table[index];
+    if (word->word == NULL) {
+        return ERROR;
+    }
 
-            block->actions[i].offset = skip_length;
+    block->first_action = word->first_action;
+    block->last_action = word->last_action;
 
-            /* prepare the data for filling if there was data previously */
-            block->actions[i].data_length = 0;
-        } else if (count > 0) {
-            /* optimization: no more will match because of the alphabetical
-             * sorting
-             */
-            break;
+    for (action_type_t i = word->first_action; i < word->last_action; i++) {
+        /* actions with the same first word should be next to each other, if
+         * one is not, it must be disregarded
+         */
+        if (action_word_indexes[i] != index ||
+                get_action_string(i) == NULL) {
+            block->actions[i].offset = -1;
+            continue;
         }
-    }
 
-    return count == 0 ? ERROR : OK;
+        /* skip over the word and the following space */
+        block->actions[i].offset = word->length +
+            (get_action_string(i)[word->length] == ' ');
+
+        /* prepare the data for filling if there was data previously */
+        block->actions[i].data_length = 0;
+    }
+    return OK;
 }
 
 /* Resolve the string within parser as a data point.
@@ -91,8 +157,8 @@ static bool resolve_data(Parser *parser, char identifier,
         break;
 
     case ACTION_DATA_TYPE_STRING:
-        LIST_COPY(parser->string, 0, parser->string_length + 1,
-                data->u.string);
+        /* only the string of the action that matches in the end is kept */
+        data->u.string = duplicate_temporary_string(parser);
         break;
 
     case ACTION_DATA_TYPE_RELATION:
@@ -156,7 +222,8 @@ static int read_and_resolve_next_action_word(Parser *parser,
                 block->actions[i].offset = -1;
                 continue;
             }
-            LIST_APPEND_VALUE(block->actions[i].data, data);
+            ARENA_LIST_APPEND_VALUE(&parser->arena, block->actions[i].data,
+                    data);
          /* try to match the next word if no data type is required */
         } else if (parser->string_length != (size_t) (space - action) ||
                 memcmp(action, parser->string,
@@ -250,7 +317,7 @@ static void print_action_possibilities(struct parse_action_block *block)
     fprintf(stderr, CLEAR_COLOR "\n");
 
     for (int i = 0; i < actual_count; i++) {
-        free(words[i]);
+        xfree(words[i]);
     }
 }
 
@@ -285,16 +352,20 @@ static void parse_next_action_part(Parser *parser,
             emit_parse_error(parser, "incomplete action");
             print_action_possibilities(block);
         } else {
-            LIST_APPEND(block->items, NULL, 1);
-            block->items[block->items_length - 1].type = type;
-            block->items[block->items_length - 1].data_count =
-                block->actions[type].data_length;
-            LIST_APPEND(block->data,
-                block->actions[type].data,
-                block->actions[type].data_length);
-
-            /* reset the count so the memory is not freed */
-            block->actions[type].data_length = 0;
+            struct action_block_item item;
+            struct action_data data;
+
+            item.type = type;
+            item.data_count = block->actions[type].data_length;
+            ARENA_LIST_APPEND_VALUE(&parser->arena, block->items, item);
+            for (size_t i = 0; i < block->actions[type].data_length; i++) {
+                data = block->actions[type].data[i];
+                /* move the string out of the arena */
+                if (data.type == ACTION_DATA_TYPE_STRING) {
+                    data.u.string = xstrdup(data.u.string);
+                }
+                ARENA_LIST_APPEND_VALUE(&parser->arena, block->data, data);
+            }
         }
     } else {
         if (read_and_resolve_next_action_word(parser, block) == ERROR) {
@@ -317,22 +388,14 @@ int continue_parsing_actions(Parser *parser, struct parse_action_block *block)
     }
 }
 
-/* Clear all memory within @block. */
+/* Clear the data within @block. */
 void clear_parse_action_block(struct parse_action_block *block)
 {
-    free(block->items);
     for (size_t i = 0; i < block->data_length; i++) {
         clear_action_data(&block->data[i]);
     }
-    free(block->data);
-
-    /* free the action parse data */
-    for (action_type_t i = 0; i < ACTION_SIMPLE_MAX; i++) {
-        for (size_t j = 0; j < block->actions[i].data_length; j++) {
-            clear_action_data(&block->actions[i].data[j]);
-        }
-        free(block->actions[i].data);
-    }
+    block->items_length = 0;
+    block->data_length = 0;
 }
 
 /* Make a real action block from a parser action block. */
@@ -345,8 +408,9 @@ ActionBlock *convert_parse_action_block(struct parse_action_block *parse)
     COPY(block->items, parse->items, parse->items_length);
     COPY(block->data, parse->data, parse->data_length);
 
-    LIST_CLEAR(parse->items);
-    LIST_CLEAR(parse->data);
+    /* the data is owned by the block now */
+    parse->items_length = 0;
+    parse->data_length = 0;
 
     return block;
 }
@@ -2,48 +2,61 @@
 #include "parse/alias.h"
 #include "parse/input.h"
 #include "parse/utility.h"
-#include "utility/list.h"
+#include "utility/hash_table.h"
 
-/* Do not put this macro in brackets! */
-#define PARSE_MAX_FILL_RATE 4/5
+/* map of all set aliases to their values */
+static HashTable alias_table;
 
-/* map of all set aliases */
-struct parse_alias {
-    /* the name of the alias */
-    char *name;
-    /* the value to resolve the alias to */
-    char *value;
-} alias_table[PARSE_MAX_ALIASES];
+/* Set the alias @name to @value. */
+void set_alias(const char *name, const char *value)
+{
+    struct hash_table_entry *entry;
 
-/* the number of elements in the alias table */
-int alias_table_count;
+    entry = find_hash_table_entry(&alias_table, name, strlen(name));
+    if (entry != NULL) {
+        LOG("overwriting alias %s = %s\n",
+                name, (char*) entry->value);
+        xfree(entry->value);
+        entry->value = xstrdup(value);
+    } else {
+        LOG("creating alias %s = %s\n",
+                name, value);
+        (void) add_hash_table_entry(&alias_table, name, strlen(name),
+                xstrdup(value));
+    }
+}
 
-/* Get the index where the alias with given name is supposed to be. */
-static int get_alias_index(const char *name)
+/* Get the number of aliases. */
+unsigned get_alias_count(void)
 {
-    unsigned hash = 1731;
-    unsigned probe = 0;
-    unsigned index;
+    return alias_table.entries_length;
+}
 
-    for (const char *i = name; i[0] != '\0'; i++) {
-        hash = hash * 407 + (unsigned char) i[0];
-    }
+/* Get the alias at @index within the alias table. */
+const char *get_alias_at(unsigned index, const char **value)
+{
+    *value = alias_table.entries[index].value;
+    return alias_table.entries[index].name;
+}
 
-    do {
-        index = hash + (probe * probe + probe) / 2;
-        index %= PARSE_MAX_ALIASES;
-        probe++;
-    } while (alias_table[index].name != NULL &&
-            strcmp(alias_table[index].name, name) != 0);
+/* Get a hash of all aliases and their values. */
+uint64_t get_alias_hash(void)
+{
+    uint64_t hash = 0;
+    const struct hash_table_entry *entry;
 
-    return index;
+    for (size_t i = 0; i < alias_table.entries_length; i++) {
+        entry = &alias_table.entries[i];
+        hash = hash * 31 + entry->hash;
+        hash = hash * 31 + get_hash(entry->value, strlen(entry->value));
+    }
+    return hash;
 }
 
 /* Parse all after the `alias` keyword. */
 void continue_parsing_alias(Parser *parser)
 {
-    struct parse_alias alias;
-    int index;
+    char *name;
 
     if (read_string_no_alias(parser) != OK) {
         emit_parse_error(parser, "expected alias name");
@@ -68,81 +81,53 @@ void continue_parsing_alias(Parser *parser)
     /* skip over '=' */
     get_stream_character(parser);
 
-    index = get_alias_index(parser->string);
-
-    alias.name = xstrdup(parser->string);
+    name = duplicate_temporary_string(parser);
 
     if (read_string(parser) != OK) {
-        free(alias.name);
         emit_parse_error(parser, "expected alias value");
         skip_statement(parser);
         return;
     }
 
-    if (alias_table[index].name == NULL &&
-            alias_table_count + 1 > PARSE_MAX_ALIASES * PARSE_MAX_FILL_RATE) {
-        free(alias.name);
-        emit_parse_error(parser, "there is no more space for aliases");
-        return;
-    }
-
-    alias.value = xstrdup(parser->string);
-
-    if (alias_table[index].name != NULL) {
-        LOG("overwriting alias %s = %s\n",
-                alias.name, alias_table[index].value);
-        free(alias_table[index].name);
-        free(alias_table[index].value);
-    } else {
-        LOG("creating alias %s = %s\n",
-                alias.name, alias.value);
-        alias_table_count++;
-    }
-
-    alias_table[index] = alias;
+    set_alias(name, duplicate_temporary_string(parser));
 }
 
 /* Parse all after the `unalias` keyword. */
 void continue_parsing_unalias(Parser *parser)
 {
+    struct hash_table_entry *entry;
+
     if (read_string_no_alias(parser) != OK) {
         emit_parse_error(parser, "expected alias name");
         skip_statement(parser);
     } else {
-        const int index = get_alias_index(parser->string);
-        if (alias_table[index].name != NULL) {
-            free(alias_table[index].name);
-            free(alias_table[index].value);
-            alias_table[index].name = NULL;
-            alias_table_count--;
+        entry = find_hash_table_entry(&alias_table, parser->string,
+                parser->string_length);
+        if (entry != NULL) {
+            xfree(entry->value);
+            remove_hash_table_entry(&alias_table, entry);
         }
     }
 }
 
 /* Check if given string is within the alias table. */
-const char *resolve_alias(const char *string)
+const char *resolve_alias(const char *string, size_t length)
 {
-    const int index = get_alias_index(string);
-    if (alias_table[index].name == NULL) {
+    const struct hash_table_entry *entry;
+
+    entry = find_hash_table_entry(&alias_table, string, length);
+    if (entry == NULL) {
         return NULL;
     } else {
-        return alias_table[index].value;
+        return entry->value;
     }
 }
 
 /* Clear all aliases the parser set. */
 void clear_all_aliases(void)
 {
-    for (unsigned i = 0; i < PARSE_MAX_ALIASES; i++) {
-        if (alias_table_count == 0) {
-            break;
-        }
-
-        if (alias_table[i].name != NULL) {
-            free(alias_table[i].name);
-            free(alias_table[i].value);
-            alias_table[i].name = NULL;
-            alias_table_count--;
-        }
+    for (size_t i = 0; i < alias_table.entries_length; i++) {
+        xfree(alias_table.entries[i].value);
     }
+    clear_hash_table(&alias_table);
 }
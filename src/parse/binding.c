@@ -82,7 +82,7 @@ int resolve_modifier(Parser *parser, unsigned *modifier)
         return ERROR;
     }
 
-    if (strcmp(string_to_modifier[index].string, parser->string) == 0) {
+    if (is_string_equal(parser, string_to_modifier[index].string)) {
         *modifier = string_to_modifier[index].modifier;
         return OK;
     } else {
@@ -127,15 +127,16 @@ static int resolve_button(Parser *parser)
     };
 
     int index = 0;
-    const char *string;
+    const char *string, *end;
 
     string = parser->string;
+    end = &string[parser->string_length];
     /* parse strings starting with "X" */
-    if (string[0] == 'X') {
+    if (string < end && string[0] == 'X') {
         int x_index = 0;
 
         string++;
-        while (isdigit(string[0])) {
+        while (string < end && isdigit(string[0])) {
             x_index *= 10;
             x_index += string[0] - '0';
             if (x_index >= BUTTON_MAX - BUTTON_X1) {
@@ -148,9 +149,10 @@ static int resolve_button(Parser *parser)
 
         index = BUTTON_X1 + x_index - 1;
     /* parse strings starting with "Button" */
-    } else if (strncmp(string, "Button", strlen("Button")) == 0) {
+    } else if (parser->string_length >= strlen("Button") &&
+            memcmp(string, "Button", strlen("Button")) == 0) {
         string += strlen("Button");
-        while (isdigit(string[0])) {
+        while (string < end && isdigit(string[0])) {
             index *= 10;
             index += string[0] - '0';
             if (index > UINT8_MAX) {
@@ -162,13 +164,13 @@ static int resolve_button(Parser *parser)
         }
     } else {
         for (unsigned i = 0; i < SIZE(button_strings); i++) {
-            if (strcmp(string, button_strings[i].name) == 0) {
+            if (is_string_equal(parser, button_strings[i].name)) {
                 return button_strings[i].button_index;
             }
         }
     }
 
-    if (string[0] != '\0') {
+    if (string != end) {
         index = BUTTON_NONE;
     }
 
@@ -181,7 +183,7 @@ static int continue_parsing_modifiers(Parser *parser,
 {
     int character;
 
-    if (strcmp(parser->string, "release") == 0) {
+    if (is_string_equal(parser, "release")) {
         if (read_string(parser) != OK) {
             emit_parse_error(parser,
                     "expected binding definition after 'release'");
@@ -192,7 +194,7 @@ static int continue_parsing_modifiers(Parser *parser,
         binding->has_modifiers = true;
     }
 
-    if (strcmp(parser->string, "transparent") == 0) {
+    if (is_string_equal(parser, "transparent")) {
         if (read_string(parser) != OK) {
             emit_parse_error(parser,
                     "expected binding definition after 'transparent'");
@@ -244,9 +246,12 @@ static int continue_parsing_modifiers(Parser *parser,
 static int resolve_button_or_key_symbol(Parser *parser,
         struct parse_binding *binding)
 {
+    char *name;
+
     binding->button_index = resolve_button(parser);
     if (binding->button_index == BUTTON_NONE) {
-        binding->key_symbol = XStringToKeysym(parser->string);
+        name = duplicate_temporary_string(parser);
+        binding->key_symbol = XStringToKeysym(name);
         if (binding->key_symbol == NoSymbol) {
             return ERROR;
         }
@@ -281,12 +286,12 @@ static void append_binding(Parser *parser, struct parse_action_block *block,
 
         item.type = ACTION_BUTTON_BINDING;
         item.data_count = 1;
-        LIST_APPEND_VALUE(block->items, item);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->items, item);
 
         data.flags = 0;
         data.type = ACTION_DATA_TYPE_BUTTON;
         data.u.button = button;
-        LIST_APPEND_VALUE(block->data, data);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->data, data);
     } else {
         struct key_binding key;
 
@@ -308,12 +313,12 @@ static void append_binding(Parser *parser, struct parse_action_block *block,
 
         item.type = ACTION_KEY_BINDING;
         item.data_count = 1;
-        LIST_APPEND_VALUE(block->items, item);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->items, item);
 
         data.flags = 0;
         data.type = ACTION_DATA_TYPE_KEY;
         data.u.key = key;
-        LIST_APPEND_VALUE(block->data, data);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->data, data);
     }
 }
 
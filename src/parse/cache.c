@@ -0,0 +1,692 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/action.h"
+#include "core/fensterchef.h"
+#include "core/log.h"
+#include "parse/alias.h"
+#include "parse/cache.h"
+#include "parse/group.h"
+#include "utility/attributes.h"
+#include "utility/list.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+/* the text at the start of every cache file, the number is the version of the
+ * format
+ */
+#define CACHE_MAGIC "fensterchef configuration cache 1\n"
+
+/* the value of a string length that stands for `NULL` */
+#define CACHE_NULL_STRING UINT32_MAX
+
+/* the header of the cache file */
+struct cache_header {
+    /* `CACHE_MAGIC` without the null terminator */
+    char magic[sizeof(CACHE_MAGIC) - 1];
+    /* hash of all action strings and data types */
+    uint64_t signature;
+    /* the time the cache was written */
+    int64_t creation_time;
+    /* the number of bytes after the header */
+    uint64_t size;
+    /* the hash of the bytes after the header */
+    uint64_t hash;
+};
+
+/* a growing buffer the cache is written to */
+struct cache_writer {
+    LIST(char, data);
+};
+
+/* a cursor within the cache file */
+struct cache_reader {
+    /* the data of the cache file after the header */
+    const char *data;
+    /* the number of bytes in `data` */
+    size_t size;
+    /* the current position within `data` */
+    size_t index;
+    /* if anything was read that makes no sense */
+    bool is_invalid;
+};
+
+/* Get a hash of all actions and data types so that a cache written by a
+ * fensterchef with a different set of actions is not used.
+ */
+static uint64_t get_signature(void)
+{
+    uint64_t signature = 0;
+    const char *string;
+    const char data_types[] = {
+#define X(identifier, type_name, short_name) \
+        short_name,
+        DEFINE_ALL_ACTION_DATA_TYPES
+#undef X
+    };
+
+    for (action_type_t type = 0; type < ACTION_MAX; type++) {
+        string = get_action_string(type);
+        if (string == NULL) {
+            string = "";
+        }
+        signature = signature * 31 + get_hash(string, strlen(string) + 1);
+    }
+    return signature * 31 + get_hash(data_types, sizeof(data_types));
+}
+
+/* Read the entire file at @path into memory.
+ *
+ * @return NULL if the file can not be read.
+ */
+static char *read_entire_file(const char *path, _Out size_t *size)
+{
+    FILE *file;
+    long length;
+    char *data;
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0 ||
+            fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    data = xmalloc(MAX(length, 1));
+    if (fread(data, 1, length, file) != (size_t) length) {
+        xfree(data);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+
+    *size = length;
+    return data;
+}
+
+/***********
+ * Writing *
+ ***********/
+
+/* Write @size bytes of @data. */
+static void write_bytes(struct cache_writer *writer, const void *data,
+        size_t size)
+{
+    LIST_APPEND(writer->data, data, size);
+}
+
+/* Write a 32 bit number. */
+static void write_u32(struct cache_writer *writer, uint32_t value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+/* Write a 64 bit number. */
+static void write_u64(struct cache_writer *writer, uint64_t value)
+{
+    write_bytes(writer, &value, sizeof(value));
+}
+
+/* Write a string that may be `NULL`. */
+static void write_string(struct cache_writer *writer, const char *string)
+{
+    size_t length;
+
+    if (string == NULL) {
+        write_u32(writer, CACHE_NULL_STRING);
+        return;
+    }
+
+    length = strlen(string);
+    write_u32(writer, length);
+    write_bytes(writer, string, length);
+}
+
+static void write_block(struct cache_writer *writer, const ActionBlock *block);
+
+/* Write a block that may be `NULL`. */
+static void write_nullable_block(struct cache_writer *writer,
+        const ActionBlock *block)
+{
+    write_u32(writer, block != NULL);
+    if (block != NULL) {
+        write_block(writer, block);
+    }
+}
+
+/* Write a single data point. */
+static void write_data(struct cache_writer *writer,
+        const struct action_data *data)
+{
+    write_u32(writer, data->flags);
+    write_u32(writer, data->type);
+    switch (data->type) {
+    case ACTION_DATA_TYPE_INTEGER:
+        write_u64(writer, (int64_t) data->u.integer);
+        break;
+
+    case ACTION_DATA_TYPE_STRING:
+        write_string(writer, data->u.string);
+        break;
+
+    case ACTION_DATA_TYPE_RELATION:
+        write_string(writer, data->u.relation.instance_pattern);
+        write_string(writer, data->u.relation.class_pattern);
+        write_nullable_block(writer, data->u.relation.actions);
+        break;
+
+    case ACTION_DATA_TYPE_BUTTON:
+        write_u32(writer, data->u.button.is_release);
+        write_u32(writer, data->u.button.is_transparent);
+        write_u32(writer, data->u.button.modifiers);
+        write_u32(writer, data->u.button.button);
+        write_nullable_block(writer, data->u.button.actions);
+        break;
+
+    case ACTION_DATA_TYPE_KEY:
+        write_u32(writer, data->u.key.is_release);
+        write_u32(writer, data->u.key.modifiers);
+        write_u64(writer, data->u.key.key_symbol);
+        write_u32(writer, data->u.key.key_code);
+        write_nullable_block(writer, data->u.key.actions);
+        break;
+
+    case ACTION_DATA_TYPE_MAX:
+        /* nothing */
+        break;
+    }
+}
+
+/* Write an action block with all its items and data. */
+static void write_block(struct cache_writer *writer, const ActionBlock *block)
+{
+    size_t data_count = 0;
+
+    for (size_t i = 0; i < block->number_of_items; i++) {
+        data_count += block->items[i].data_count;
+    }
+
+    write_u64(writer, block->number_of_items);
+    write_u64(writer, data_count);
+    for (size_t i = 0; i < block->number_of_items; i++) {
+        write_u32(writer, block->items[i].type);
+        write_u32(writer, block->items[i].data_count);
+    }
+    for (size_t i = 0; i < data_count; i++) {
+        write_data(writer, &block->data[i]);
+    }
+}
+
+/* Write the configuration cache. */
+void save_configuration_cache(const Parser *parser,
+        const ActionBlock *actions)
+{
+    struct cache_writer writer;
+    struct cache_header header;
+    char *path, *temporary_path;
+    FILE *file;
+    const char *name, *value;
+    ActionBlock *group_actions;
+
+    if (parser->files_length == 0) {
+        /* only files can be cached */
+        return;
+    }
+
+    path = get_cache_file("configuration");
+    if (path == NULL) {
+        return;
+    }
+
+    ZERO(&writer, 1);
+
+    write_u32(&writer, parser->files_length);
+    for (size_t i = 0; i < parser->files_length; i++) {
+        write_string(&writer, parser->files[i].path);
+        write_u64(&writer, parser->files[i].modification_time);
+        write_u64(&writer, parser->files[i].size);
+        write_u64(&writer, parser->files[i].hash);
+    }
+
+    write_u32(&writer, get_alias_count());
+    for (unsigned i = 0; i < get_alias_count(); i++) {
+        name = get_alias_at(i, &value);
+        write_string(&writer, name);
+        write_string(&writer, value);
+    }
+
+    write_u32(&writer, get_group_count());
+    for (unsigned i = 0; i < get_group_count(); i++) {
+        name = get_group_at(i, &group_actions);
+        write_string(&writer, name);
+        write_nullable_block(&writer, group_actions);
+    }
+
+    write_block(&writer, actions);
+
+    /* zero the padding bytes as well */
+    ZERO(&header, 1);
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.signature = get_signature();
+    header.creation_time = time(NULL);
+    header.size = writer.data_length;
+    header.hash = get_hash(writer.data, writer.data_length);
+
+    temporary_path = xasprintf("%s.new", path);
+    file = fopen(temporary_path, "wb");
+    if (file == NULL ||
+            fwrite(&header, sizeof(header), 1, file) != 1 ||
+            fwrite(writer.data, 1, writer.data_length, file) !=
+                writer.data_length ||
+            fclose(file) != 0 ||
+            rename(temporary_path, path) == -1) {
+        LOG_ERROR("could not write the configuration cache %s: %s\n",
+                path, strerror(errno));
+        remove(temporary_path);
+    }
+
+    xfree(temporary_path);
+    xfree(path);
+    xfree(writer.data);
+}
+
+/***********
+ * Reading *
+ ***********/
+
+/* Read @size bytes.
+ *
+ * @return NULL if there are not enough bytes left.
+ */
+static const char *read_bytes(struct cache_reader *reader, size_t size)
+{
+    const char *bytes;
+
+    if (reader->is_invalid || size > reader->size - reader->index) {
+        reader->is_invalid = true;
+        return NULL;
+    }
+
+    bytes = &reader->data[reader->index];
+    reader->index += size;
+    return bytes;
+}
+
+/* Read a 32 bit number. */
+static uint32_t read_u32(struct cache_reader *reader)
+{
+    const char *bytes;
+    uint32_t value = 0;
+
+    bytes = read_bytes(reader, sizeof(value));
+    if (bytes != NULL) {
+        memcpy(&value, bytes, sizeof(value));
+    }
+    return value;
+}
+
+/* Read a 64 bit number. */
+static uint64_t read_u64(struct cache_reader *reader)
+{
+    const char *bytes;
+    uint64_t value = 0;
+
+    bytes = read_bytes(reader, sizeof(value));
+    if (bytes != NULL) {
+        memcpy(&value, bytes, sizeof(value));
+    }
+    return value;
+}
+
+/* Read a string that may be `NULL`.
+ *
+ * @return an allocated string or NULL.
+ */
+static char *read_string(struct cache_reader *reader)
+{
+    uint32_t length;
+    const char *bytes;
+
+    length = read_u32(reader);
+    if (length == CACHE_NULL_STRING) {
+        return NULL;
+    }
+
+    bytes = read_bytes(reader, length);
+    if (bytes == NULL || memchr(bytes, '\0', length) != NULL) {
+        reader->is_invalid = true;
+        return NULL;
+    }
+    return xstrndup(bytes, length);
+}
+
+/* Check if the data types in @data match what the action @type expects. */
+static bool is_valid_item(action_type_t type, const struct action_data *data,
+        unsigned data_count)
+{
+    const char *word, *space;
+    size_t length;
+    unsigned index = 0;
+    action_data_type_t data_type;
+
+    word = get_action_string(type);
+    if (word == NULL) {
+        return false;
+    }
+
+    while (true) {
+        space = strchr(word, ' ');
+        length = space == NULL ? strlen(word) : (size_t) (space - word);
+        if (length == 1) {
+            data_type = get_action_data_type_from_identifier(word[0]);
+            if (data_type != ACTION_DATA_TYPE_MAX) {
+                if (index >= data_count || data[index].type != data_type) {
+                    return false;
+                }
+                index++;
+            }
+        }
+        if (space == NULL) {
+            break;
+        }
+        word = &space[1];
+    }
+    return index == data_count;
+}
+
+static ActionBlock *read_block(struct cache_reader *reader, unsigned depth);
+
+/* Read a block that may be `NULL`. */
+static ActionBlock *read_nullable_block(struct cache_reader *reader,
+        unsigned depth)
+{
+    switch (read_u32(reader)) {
+    case 0:
+        return NULL;
+    case 1:
+        return read_block(reader, depth);
+    }
+    reader->is_invalid = true;
+    return NULL;
+}
+
+/* Read a single data point into @data. */
+static void read_data(struct cache_reader *reader, struct action_data *data,
+        unsigned depth)
+{
+    uint32_t type;
+
+    data->flags = read_u32(reader);
+    type = read_u32(reader);
+    if (type >= ACTION_DATA_TYPE_MAX) {
+        reader->is_invalid = true;
+        return;
+    }
+
+    /* the value is zero until it is read, which is safe to clear */
+    data->type = type;
+    switch (data->type) {
+    case ACTION_DATA_TYPE_INTEGER:
+        data->u.integer = (int64_t) read_u64(reader);
+        break;
+
+    case ACTION_DATA_TYPE_STRING:
+        data->u.string = read_string(reader);
+        if (data->u.string == NULL) {
+            reader->is_invalid = true;
+        }
+        break;
+
+    case ACTION_DATA_TYPE_RELATION:
+        data->u.relation.instance_pattern = read_string(reader);
+        data->u.relation.class_pattern = read_string(reader);
+        data->u.relation.actions = read_nullable_block(reader, depth + 1);
+        break;
+
+    case ACTION_DATA_TYPE_BUTTON:
+        data->u.button.is_release = read_u32(reader);
+        data->u.button.is_transparent = read_u32(reader);
+        data->u.button.modifiers = read_u32(reader);
+        data->u.button.button = read_u32(reader);
+        data->u.button.actions = read_nullable_block(reader, depth + 1);
+        break;
+
+    case ACTION_DATA_TYPE_KEY:
+        data->u.key.is_release = read_u32(reader);
+        data->u.key.modifiers = read_u32(reader);
+        data->u.key.key_symbol = read_u64(reader);
+        data->u.key.key_code = read_u32(reader);
+        data->u.key.actions = read_nullable_block(reader, depth + 1);
+        break;
+
+    case ACTION_DATA_TYPE_MAX:
+        /* nothing */
+        break;
+    }
+}
+
+/* Read an action block with all its items and data.
+ *
+ * @return NULL if the block is invalid.
+ */
+static ActionBlock *read_block(struct cache_reader *reader, unsigned depth)
+{
+    uint64_t item_count, data_count, total_count = 0;
+    size_t remaining;
+    ActionBlock *block;
+    struct action_data *data;
+
+    item_count = read_u64(reader);
+    data_count = read_u64(reader);
+    /* each item and data point takes up at least 8 bytes */
+    remaining = (reader->size - reader->index) / 8;
+    if (reader->is_invalid || depth > MAX_BLOCK_CALL_DEPTH ||
+            item_count > remaining || data_count > remaining) {
+        reader->is_invalid = true;
+        return NULL;
+    }
+
+    block = create_empty_action_block(item_count, data_count);
+    for (size_t i = 0; i < item_count; i++) {
+        block->items[i].type = read_u32(reader);
+        block->items[i].data_count = read_u32(reader);
+        if (block->items[i].type >= ACTION_MAX) {
+            reader->is_invalid = true;
+        }
+        total_count += block->items[i].data_count;
+    }
+
+    if (reader->is_invalid || total_count != data_count) {
+        /* the items do not describe the data, do not let the data be cleared
+         * by going over the items
+         */
+        block->number_of_items = 0;
+        reader->is_invalid = true;
+        dereference_action_block(block);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < data_count; i++) {
+        read_data(reader, &block->data[i], depth);
+    }
+
+    data = block->data;
+    for (size_t i = 0; i < item_count && !reader->is_invalid; i++) {
+        if (!is_valid_item(block->items[i].type, data,
+                    block->items[i].data_count)) {
+            reader->is_invalid = true;
+        }
+        data += block->items[i].data_count;
+    }
+
+    if (reader->is_invalid) {
+        dereference_action_block(block);
+        return NULL;
+    }
+    return block;
+}
+
+/* Check if all files in the cache are unchanged and the first file is
+ * @path.
+ *
+ * The files are appended to @files.
+ */
+static bool are_files_unchanged(struct cache_reader *reader, const char *path,
+        int64_t creation_time, struct parse_file **files,
+        size_t *number_of_files)
+{
+    uint32_t count;
+    struct parse_file file;
+    bool is_unchanged = true;
+
+    count = read_u32(reader);
+    if (count == 0) {
+        return false;
+    }
+
+    /* each file takes up at least 28 bytes */
+    if (count > (reader->size - reader->index) / 28) {
+        reader->is_invalid = true;
+        return false;
+    }
+    ALLOCATE(*files, count);
+
+    for (uint32_t i = 0; i < count && !reader->is_invalid; i++) {
+        file.path = read_string(reader);
+        file.modification_time = (int64_t) read_u64(reader);
+        file.size = read_u64(reader);
+        file.hash = read_u64(reader);
+        if (file.path == NULL) {
+            reader->is_invalid = true;
+        } else if (is_unchanged) {
+            if (i == 0 && strcmp(file.path, path) != 0) {
+                is_unchanged = false;
+            } else {
+                is_unchanged = is_parse_file_unchanged(&file, creation_time);
+                if (!is_unchanged) {
+                    LOG("%s changed since the configuration was cached\n",
+                            file.path);
+                }
+            }
+        }
+        if (file.path != NULL) {
+            (*files)[(*number_of_files)++] = file;
+        }
+    }
+    return is_unchanged && !reader->is_invalid;
+}
+
+/* Read all aliases and groups and set them. */
+static void read_aliases_and_groups(struct cache_reader *reader)
+{
+    uint32_t count;
+    char *name, *value;
+    ActionBlock *actions;
+
+    count = read_u32(reader);
+    for (uint32_t i = 0; i < count && !reader->is_invalid; i++) {
+        name = read_string(reader);
+        value = read_string(reader);
+        if (name == NULL || value == NULL) {
+            reader->is_invalid = true;
+        } else {
+            set_alias(name, value);
+        }
+        xfree(name);
+        xfree(value);
+    }
+
+    count = read_u32(reader);
+    for (uint32_t i = 0; i < count && !reader->is_invalid; i++) {
+        name = read_string(reader);
+        actions = read_nullable_block(reader, 0);
+        if (name == NULL || reader->is_invalid) {
+            dereference_action_block(actions);
+            reader->is_invalid = true;
+        } else {
+            set_group(name, actions);
+        }
+        xfree(name);
+    }
+}
+
+/* Load the cached configuration for the configuration file at @path. */
+ActionBlock *load_configuration_cache(const char *path,
+        struct parse_file **files, size_t *number_of_files)
+{
+    char *cache_path;
+    char *data;
+    size_t size;
+    struct cache_header header;
+    struct cache_reader reader;
+    ActionBlock *actions = NULL;
+
+    *files = NULL;
+    *number_of_files = 0;
+
+    cache_path = get_cache_file("configuration");
+    if (cache_path == NULL) {
+        return NULL;
+    }
+    data = read_entire_file(cache_path, &size);
+    xfree(cache_path);
+    if (data == NULL) {
+        return NULL;
+    }
+
+    if (size < sizeof(header)) {
+        xfree(data);
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    reader.data = &data[sizeof(header)];
+    reader.size = size - sizeof(header);
+    reader.index = 0;
+    reader.is_invalid = false;
+
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.signature != get_signature() ||
+            header.size != reader.size ||
+            header.hash != get_hash(reader.data, reader.size)) {
+        LOG("ignoring the outdated configuration cache\n");
+        xfree(data);
+        return NULL;
+    }
+
+    if (are_files_unchanged(&reader, path, header.creation_time,
+                files, number_of_files)) {
+        read_aliases_and_groups(&reader);
+        actions = read_block(&reader, 0);
+        if (reader.is_invalid || reader.index != reader.size) {
+            LOG_ERROR("the configuration cache is corrupted\n");
+            dereference_action_block(actions);
+            actions = NULL;
+            /* do not leave half of the aliases and groups behind */
+            clear_all_aliases();
+            clear_all_groups();
+            free_parse_files(*files, *number_of_files);
+            *files = NULL;
+            *number_of_files = 0;
+        } else {
+            LOG("using the cached configuration of %s\n",
+                    path);
+        }
+    }
+
+    if (actions == NULL) {
+        free_parse_files(*files, *number_of_files);
+        *files = NULL;
+        *number_of_files = 0;
+    }
+
+    xfree(data);
+    return actions;
+}
@@ -6,60 +6,35 @@
 #include "parse/group.h"
 #include "parse/top.h"
 #include "parse/utility.h"
+#include "utility/hash_table.h"
 
-/* Do not put this macro in brackets! */
-#define PARSE_MAX_FILL_RATE 4/5
+/* map of all set groups to their actions */
+static HashTable group_table;
 
-/* map of all set groups */
-struct parse_group group_table[PARSE_MAX_GROUPS];
-
-/* the number of elements in the group table */
-unsigned group_table_count;
-
-/* Get the index where the group with given name is supposed to be. */
-static unsigned get_group_index(const char *name)
-{
-    unsigned hash = 1731;
-    unsigned probe = 0;
-    unsigned index;
-
-    for (const char *i = name; i[0] != '\0'; i++) {
-        hash = hash * 407 + (unsigned char) i[0];
-    }
-
-    do {
-        index = hash + (probe * probe + probe) / 2;
-        index %= PARSE_MAX_GROUPS;
-        probe++;
-    } while (group_table[index].name != NULL &&
-            strcmp(group_table[index].name, name) != 0);
-
-    return index;
-}
+/* the number of times a group was set or the groups were cleared */
+static unsigned group_change_count;
 
 /* Find the group by given name. */
-struct parse_group *find_group(const char *name)
+ActionBlock *find_group(const char *name)
 {
-    unsigned index;
+    const struct hash_table_entry *entry;
 
-    index = get_group_index(name);
-    if (group_table[index].name == NULL) {
+    entry = find_hash_table_entry(&group_table, name, strlen(name));
+    if (entry == NULL) {
         return NULL;
     } else {
-        return &group_table[index];
+        return entry->value;
     }
 }
 
 /* Run counter actions that undo anything that the group did. */
-void undo_group(const struct parse_group *group)
+void undo_group(const ActionBlock *actions)
 {
-    const ActionBlock *actions;
     const struct action_data *data;
     struct button_binding button;
     struct key_binding key;
     struct window_relation relation;
 
-    actions = group->actions;
     data = actions->data;
     /* find all binding actions and make an unbind action to counter it */
     for (size_t i = 0; i < actions->number_of_items; i++) {
@@ -85,66 +60,76 @@ void undo_group(const struct parse_group *group)
 /* Clear all groups the parser set. */
 void clear_all_groups(void)
 {
-    for (unsigned i = 0; i < PARSE_MAX_GROUPS; i++) {
-        if (group_table_count == 0) {
-            break;
-        }
+    for (size_t i = 0; i < group_table.entries_length; i++) {
+        dereference_action_block(group_table.entries[i].value);
+    }
+    clear_hash_table(&group_table);
+    group_change_count++;
+}
 
-        if (group_table[i].name != NULL) {
-            free(group_table[i].name);
-            dereference_action_block(group_table[i].actions);
-            group_table[i].name = NULL;
-            group_table_count--;
-        }
+/* Set the group @name to @actions. */
+void set_group(const char *name, ActionBlock *actions)
+{
+    struct hash_table_entry *entry;
+
+    entry = find_hash_table_entry(&group_table, name, strlen(name));
+    if (entry != NULL) {
+        LOG("overwriting group %s\n",
+                name);
+        dereference_action_block(entry->value);
+        entry->value = actions;
+    } else {
+        LOG("creating group %s\n",
+                name);
+        (void) add_hash_table_entry(&group_table, name, strlen(name),
+                actions);
     }
+    group_change_count++;
+}
+
+/* Get the number of times the groups changed. */
+unsigned get_group_change_count(void)
+{
+    return group_change_count;
+}
+
+/* Get the number of groups. */
+unsigned get_group_count(void)
+{
+    return group_table.entries_length;
+}
+
+/* Get the group at @index within the group table. */
+const char *get_group_at(unsigned index, ActionBlock **actions)
+{
+    *actions = group_table.entries[index].value;
+    return group_table.entries[index].name;
 }
 
 /* Parse all after a `group` keyword. */
 void continue_parsing_group(Parser *parser)
 {
     struct parse_action_block sub_block;
-    unsigned index;
-    struct parse_group group;
+    char *name;
+    ActionBlock *actions;
 
     if (read_string(parser) != OK) {
         emit_parse_error(parser, "expected name after group keyword\n");
         return;
     }
 
-    group.name = xstrdup(parser->string);
+    name = duplicate_temporary_string(parser);
 
     ZERO(&sub_block, 1);
     if (parse_top(parser, &sub_block) != OK) {
-        free(group.name);
-        clear_parse_action_block(&sub_block);
-        return;
-    }
-
-    index = get_group_index(group.name);
-
-    if (group_table[index].name == NULL &&
-            group_table_count + 1 > PARSE_MAX_GROUPS * PARSE_MAX_FILL_RATE) {
         clear_parse_action_block(&sub_block);
-        free(group.name);
-        emit_parse_error(parser, "there is no more space for groups");
         return;
     }
 
-    group.actions = convert_parse_action_block(&sub_block);
+    actions = convert_parse_action_block(&sub_block);
     clear_parse_action_block(&sub_block);
 
-    if (group_table[index].name != NULL) {
-        LOG("overwriting group %s\n",
-                group.name);
-        free(group_table[index].name);
-        dereference_action_block(group_table[index].actions);
-    } else {
-        LOG("creating group %s\n",
-                group.name);
-        group_table_count++;
-    }
-
-    group_table[index] = group;
+    set_group(name, actions);
 }
 
 /* Parse all after a `ungroup` keyword. */
@@ -161,10 +146,10 @@ void continue_parsing_ungroup(Parser *parser, struct parse_action_block *block)
 
     item.type = ACTION_UNGROUP;
     item.data_count = 1;
-    LIST_APPEND_VALUE(block->items, item);
+    ARENA_LIST_APPEND_VALUE(&parser->arena, block->items, item);
 
     data.flags = 0;
     data.type = ACTION_DATA_TYPE_STRING;
-    data.u.string = xstrdup(parser->string);
-    LIST_APPEND_VALUE(block->data, data);
+    data.u.string = duplicate_string(parser);
+    ARENA_LIST_APPEND_VALUE(&parser->arena, block->data, data);
 }
@@ -1,5 +1,6 @@
 #include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "parse/parse.h"
@@ -102,83 +103,136 @@ int peek_stream_character(Parser *parser)
     return get_or_peek_stream_character(parser, false);
 }
 
+/* Get the index after the line end at @index. */
+static size_t skip_line_end(const Parser *parser, size_t index)
+{
+    const int character = (unsigned char) parser->input[index];
+    int other;
+
+    index++;
+    if (index < parser->length) {
+        other = (unsigned char) parser->input[index];
+        /* put \r\n and \n\r together */
+        if ((other == '\n' && character == '\r') ||
+                (other == '\r' && character == '\n')) {
+            index++;
+        }
+    }
+    return index;
+}
+
+/* Find the start of all lines within the input of @parser. */
+static void build_line_index(Parser *parser)
+{
+    struct parse_line line;
+    size_t index = 0;
+    int character;
+
+    if (parser->lines_length > 0) {
+        return;
+    }
+
+    line.start = 0;
+    line.is_plain = true;
+    while (index < parser->length) {
+        character = (unsigned char) parser->input[index];
+        if (islineend(character)) {
+            ARENA_LIST_APPEND_VALUE(&parser->arena, parser->lines, line);
+            index = skip_line_end(parser, index);
+            line.start = index;
+            line.is_plain = true;
+        } else {
+            if (!isprint(character)) {
+                line.is_plain = false;
+            }
+            index++;
+        }
+    }
+    ARENA_LIST_APPEND_VALUE(&parser->arena, parser->lines, line);
+}
+
+/* Get the index of the line that contains @index. */
+static unsigned find_line(const Parser *parser, size_t index)
+{
+    size_t low = 0, high = parser->lines_length, middle;
+
+    /* find the last line starting at or before @index */
+    while (high - low > 1) {
+        middle = low + (high - low) / 2;
+        if (parser->lines[middle].start <= index) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
 /* Get the column and line of @index within the active stream. */
-void get_stream_position(const Parser *parser, size_t index,
+void get_stream_position(Parser *parser, size_t index,
         unsigned *line, unsigned *column)
 {
-    unsigned current_line = 0, current_column = 0;
+    const struct parse_line *parse_line;
+    unsigned current_column = 0;
     int character;
     wchar_t wide_character;
+    int result, width;
+
+    build_line_index(parser);
 
     index = MIN(index, parser->length);
-    for (size_t i = 0; i < index; i++) {
+    *line = find_line(parser, index);
+    parse_line = &parser->lines[*line];
+    if (parse_line->is_plain) {
+        *column = index - parse_line->start;
+        return;
+    }
+
+    for (size_t i = parse_line->start; i < index; i++) {
         character = (unsigned char) parser->input[i];
+        if (islineend(character)) {
+            break;
+        }
+
         if (isprint(character)) {
             current_column++;
-        } else if (islineend(character)) {
-            current_column = 0;
-            current_line++;
-            if (i + 1 < index) {
-                const int other = (unsigned char) parser->input[i + 1];
-                /* put \r\n and \n\r together */
-                if ((other == '\n' && character == '\r') ||
-                        (other == '\r' && character == '\n')) {
-                    i++;
-                }
-            }
         } else if (character == '\t') {
-            current_column = current_column - current_column % PARSE_TAB_SIZE;
+            current_column += PARSE_TAB_SIZE - current_column % PARSE_TAB_SIZE;
         } else if (character < ' ') {
             /* these characters are printed as ? */
             current_column++;
         } else {
-            const int result = mbtowc(&wide_character,
-                    &parser->input[i], parser->length - i);
-            if (result == -1) {
+            result = mbtowc(&wide_character, &parser->input[i],
+                    parser->length - i);
+            if (result <= 0) {
                 /* these characters are printed as ? */
                 current_column++;
             } else {
-                index += result - 1;
-                current_column += wcwidth(wide_character);
+                i += result - 1;
+                width = wcwidth(wide_character);
+                current_column += MAX(width, 0);
             }
         }
     }
-
-    *line = current_line;
     *column = current_column;
 }
 
 /* Get the beginning of the line at given line index. */
-const char *get_stream_line(const Parser *parser, unsigned line,
+const char *get_stream_line(Parser *parser, unsigned line,
         unsigned *length)
 {
-    size_t line_index = 0, end_line_index;
-    size_t index = 0;
-    int character;
+    size_t start, end;
 
-    while (index < parser->length) {
-        end_line_index = index;
+    build_line_index(parser);
 
-        character = (unsigned char) parser->input[index];
-        index++;
-        if (islineend(character)) {
-            if (index + 1 < parser->length) {
-                const int other = (unsigned char) parser->input[index + 1];
-                /* put \r\n and \n\r together */
-                if ((other == '\n' && character == '\r') ||
-                        (other == '\r' && character == '\n')) {
-                    index++;
-                }
-            }
-            if (line == 0) {
-                index = end_line_index;
-                break;
-            }
-            line_index = index;
-            line--;
-        }
+    line = MIN(line, parser->lines_length - 1);
+    start = parser->lines[line].start;
+    end = start;
+    while (end < parser->length &&
+            !islineend((unsigned char) parser->input[end])) {
+        end++;
     }
 
-    *length = index - line_index;
-    return &parser->input[line_index];
+    *length = end - start;
+    return &parser->input[start];
 }
@@ -39,7 +39,7 @@ static int resolve_boolean(Parser *parser, _Out bool *boolean)
         return ERROR;
     }
 
-    if (strcmp(string_to_boolean[index].string, parser->string) == 0) {
+    if (is_string_equal(parser, string_to_boolean[index].string)) {
         *boolean = string_to_boolean[index].boolean;
         return OK;
     } else {
@@ -52,7 +52,7 @@ int resolve_integer(Parser *parser,
         unsigned *flags,
         action_integer_t *output_integer)
 {
-    char *word;
+    const char *word, *end;
     int error = ERROR;
     action_integer_t sign = 1, integer = 0;
     bool boolean;
@@ -63,15 +63,19 @@ int resolve_integer(Parser *parser,
     }
 
     word = parser->string;
+    end = &word[parser->string_length];
     *flags = 0;
-    if ((word[0] == '-' && isdigit(word[1])) || isdigit(word[0])) {
+    if (word == end) {
+        /* empty quoted strings were rejected above */
+    } else if ((word[0] == '-' && &word[1] < end && isdigit(word[1])) ||
+            isdigit(word[0])) {
         if (word[0] == '-') {
             sign = -1;
             word++;
         }
         integer = word[0] - '0';
         word++;
-        while (isdigit(word[0])) {
+        while (word < end && isdigit(word[0])) {
             integer *= 10;
             integer += word[0] - '0';
             word++;
@@ -79,27 +83,27 @@ int resolve_integer(Parser *parser,
             if (integer > PARSE_INTEGER_LIMIT) {
                 emit_parse_error(parser, "integer overflows "
                         STRINGIFY(PARSE_INTEGER_LIMIT));
-                do {
+                while (word < end && isdigit(word[0])) {
                     word++;
-                } while (isdigit(word[0]));
+                }
 
                 break;
             }
         }
 
-        if (word[0] == '%') {
+        if (word < end && word[0] == '%') {
             *flags |= ACTION_DATA_FLAGS_IS_PERCENT;
             word++;
         }
 
-        if (word[0] == '\0') {
+        if (word == end) {
             error = OK;
         }
     } else if (word[0] == '#') {
         int count = 0;
 
         word++;
-        for (; isxdigit(word[0]); word++) {
+        for (; word < end && isxdigit(word[0]); word++) {
             count++;
             integer <<= 4;
             integer += isdigit(word[0]) ?
@@ -115,7 +119,7 @@ int resolve_integer(Parser *parser,
             integer |= 0xff << 24;
         }
 
-        if (word[0] == '\0') {
+        if (word == end) {
             error = OK;
         }
     } else if (resolve_boolean(parser, &boolean) == OK) {
@@ -1,8 +1,13 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <stdarg.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "core/log.h"
 #include "core/relation.h"
+#include "core/trace.h"
 #include "core/window.h"
 #include "parse/action.h"
 #include "parse/input.h"
@@ -47,7 +52,7 @@ void emit_parse_error(Parser *parser, const char *format, ...)
 
         fprintf(log_file, "In file included from " COLOR(GREEN) "%s" CLEAR_COLOR,
                 upper->file_path);
-        get_stream_position(parser, upper->start_index, &line, &column);
+        get_stream_position(upper, upper->start_index, &line, &column);
         fprintf(log_file, ":" COLOR(GREEN) "%u" CLEAR_COLOR,
                 line + 1);
 
@@ -56,7 +61,7 @@ void emit_parse_error(Parser *parser, const char *format, ...)
             fprintf(log_file, ",\n                 from ");
             fprintf(log_file, COLOR(GREEN) "%s" CLEAR_COLOR,
                     upper->file_path);
-            get_stream_position(parser, upper->start_index, &line, &column);
+            get_stream_position(upper, upper->start_index, &line, &column);
             fprintf(log_file, ":" COLOR(GREEN) "%u" CLEAR_COLOR,
                     line + 1);
         }
@@ -78,61 +83,150 @@ void emit_parse_error(Parser *parser, const char *format, ...)
     fputs("        ^\n", log_file);
 }
 
+/* Read all of @descriptor into an allocated buffer.
+ *
+ * @size is only a hint, the file might change while reading or report no size
+ * at all (like files within `/proc`).
+ *
+ * @return NULL if reading failed.
+ */
+static utf8_t *read_file(int descriptor, size_t size, _Out size_t *length)
+{
+    utf8_t *data;
+    size_t capacity;
+    ssize_t count;
+
+    capacity = size + 1;
+    ALLOCATE(data, capacity);
+    *length = 0;
+    while (count = read(descriptor, &data[*length], capacity - *length),
+            count != 0) {
+        if (count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            xfree(data);
+            return NULL;
+        }
+        *length += count;
+        if (*length == capacity) {
+            capacity *= 2;
+            REALLOCATE(data, capacity);
+        }
+    }
+    return data;
+}
+
 /* Initialize a parse object to parse file at given path. */
 Parser *create_file_parser(const utf8_t *path)
 {
-    FILE *file;
-    long size;
+    int file;
+    struct stat status;
     Parser *parser;
+    utf8_t *input;
+    size_t length;
+    struct parse_file record;
 
-    file = fopen(path, "r");
-    if (file == NULL) {
+    file = open(path, O_RDONLY);
+    if (file == -1) {
         return NULL;
     }
 
-    fseek(file, 0, SEEK_END);
-    size = ftell(file);
+    if (fstat(file, &status) == -1) {
+        close(file);
+        return NULL;
+    }
 
-    parser = xmalloc(sizeof(*parser) + size);
-    memset(parser, 0, sizeof(*parser));
+    /* the file is read and not mapped: a mapping would fault when the file is
+     * truncated while parsing, for example when an editor saves in place
+     */
+    input = read_file(file, status.st_size, &length);
+    close(file);
+    if (input == NULL) {
+        return NULL;
+    }
 
+    ALLOCATE_ZERO(parser, 1);
     parser->file_path = xstrdup(path);
+    parser->input = input;
+    parser->length = length;
+
+    /* remember the file so a cache can tell if it changed */
+    record.path = xstrdup(path);
+    record.modification_time = status.st_mtime;
+    record.size = length;
+    record.hash = get_hash(input, length);
+    LIST_APPEND_VALUE(parser->files, record);
 
-    parser->length = size;
+    return parser;
+}
 
-    fseek(file, 0, SEEK_SET);
-    fread(parser->input, 1, size, file);
+/* Check if the file recorded in @file is unchanged. */
+bool is_parse_file_unchanged(const struct parse_file *file, long long since)
+{
+    struct stat status;
+    int descriptor;
+    utf8_t *data;
+    size_t length;
+    bool is_unchanged;
+
+    if (stat(file->path, &status) == -1 ||
+            (S_ISREG(status.st_mode) &&
+                (size_t) status.st_size != file->size)) {
+        return false;
+    }
 
-    fclose(file);
+    if ((long long) status.st_mtime == file->modification_time &&
+            file->modification_time < since) {
+        return true;
+    }
 
-    return parser;
+    descriptor = open(file->path, O_RDONLY);
+    if (descriptor == -1) {
+        return false;
+    }
+    data = read_file(descriptor, file->size, &length);
+    close(descriptor);
+    if (data == NULL) {
+        return false;
+    }
+    is_unchanged = length == file->size &&
+        get_hash(data, length) == file->hash;
+    xfree(data);
+    return is_unchanged;
 }
 
 /* Initialize a parse object to parse a given string. */
 Parser *create_string_parser(const utf8_t *string)
 {
-    size_t size;
     Parser *parser;
 
-    size = strlen(string);
-
-    parser = xmalloc(sizeof(*parser) + size);
-    memset(parser, 0, sizeof(*parser));
-
-    parser->length = size;
-
-    COPY(parser->input, string, size);
+    ALLOCATE_ZERO(parser, 1);
+    parser->length = strlen(string);
+    parser->input = xstrdup(string);
     return parser;
 }
 
+/* Free the paths of @number_of_files files and @files itself. */
+void free_parse_files(struct parse_file *files, size_t number_of_files)
+{
+    for (size_t i = 0; i < number_of_files; i++) {
+        xfree(files[i].path);
+    }
+    xfree(files);
+}
+
 /* Destroy a previously allocated parser object. */
 void destroy_parser(Parser *parser)
 {
     if (parser != NULL) {
-        free(parser->file_path);
-        free(parser->string);
-        free(parser->first_error_file);
-        free(parser);
+        xfree((utf8_t*) parser->input);
+        free_parse_files(parser->files, parser->files_length);
+        xfree(parser->file_path);
+        xfree(parser->string_buffer);
+        xfree(parser->first_error_file);
+        clear_arena(&parser->arena);
+        xfree(parser);
     }
 }
 
@@ -159,12 +253,14 @@ int test_parser(Parser *parser)
     return parser->error_count > 0 ? ERROR : OK;
 }
 
-/* Parse the currently active stream and run all actions. */
-int parse_and_run_actions(Parser *parser)
+/* Parse the currently active stream. */
+ActionBlock *parse_actions(Parser *parser)
 {
     struct parse_action_block block;
     ActionBlock *actions;
 
+    begin_trace_span("parse", "parse actions");
+
     ZERO(&block, 1);
     while (parse_top(parser, &block) == OK) {
         /* nothing */
@@ -173,18 +269,36 @@ int parse_and_run_actions(Parser *parser)
     if (parser->error_count > 0) {
         /* clear all parsed thus far */
         clear_parse_action_block(&block);
-        return ERROR;
+        actions = NULL;
+    } else {
+        actions = convert_parse_action_block(&block);
+        clear_parse_action_block(&block);
     }
 
-    /* do the startup actions */
-    actions = convert_parse_action_block(&block);
+    end_trace_span();
+    return actions;
+}
+
+/* Run actions that were parsed by `parse_actions()`. */
+void run_parsed_actions(ActionBlock *actions)
+{
     LOG_DEBUG("running actions: %A\n",
             actions);
     Window_selected = Window_focus;
     run_action_block(actions);
+}
 
-    dereference_action_block(actions);
-    clear_parse_action_block(&block);
+/* Parse the currently active stream and run all actions. */
+int parse_and_run_actions(Parser *parser)
+{
+    ActionBlock *actions;
 
+    actions = parse_actions(parser);
+    if (actions == NULL) {
+        return ERROR;
+    }
+
+    run_parsed_actions(actions);
+    dereference_action_block(actions);
     return OK;
 }
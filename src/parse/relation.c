@@ -11,7 +11,7 @@ static void read_class_string(Parser *parser,
 {
     utf8_t *pattern;
 
-    pattern = xstrdup(parser->string);
+    pattern = duplicate_string(parser);
 
     skip_blanks(parser);
     if (peek_stream_character(parser) == ',') {
@@ -23,7 +23,7 @@ static void read_class_string(Parser *parser,
                     "expected class name");
             relation->class_pattern = NULL;
         } else {
-            relation->class_pattern = xstrdup(parser->string);
+            relation->class_pattern = duplicate_string(parser);
         }
 
         relation->instance_pattern = pattern;
@@ -55,8 +55,8 @@ void continue_parsing_relation(Parser *parser,
         emit_parse_error(parser,
                 "expected actions after relation pattern");
         clear_parse_action_block(&sub_block);
-        free(relation.instance_pattern);
-        free(relation.class_pattern);
+        xfree(relation.instance_pattern);
+        xfree(relation.class_pattern);
         return;
     }
 
@@ -65,12 +65,12 @@ void continue_parsing_relation(Parser *parser,
 
     item.type = ACTION_RELATION;
     item.data_count = 1;
-    LIST_APPEND_VALUE(block->items, item);
+    ARENA_LIST_APPEND_VALUE(&parser->arena, block->items, item);
 
     data.flags = 0;
     data.type = ACTION_DATA_TYPE_RELATION;
     data.u.relation = relation;
-    LIST_APPEND_VALUE(block->data, data);
+    ARENA_LIST_APPEND_VALUE(&parser->arena, block->data, data);
 }
 
 /* Parse all after an `unrelate` keyword. */
@@ -85,18 +85,18 @@ void continue_parsing_unrelate(Parser *parser,
         /* `unrelate` without a following string */
         item.type = ACTION_UNRELATE;
         item.data_count = 0;
-        LIST_APPEND_VALUE(block->items, item);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->items, item);
     } else {
         read_class_string(parser, &relation);
         relation.actions = NULL;
 
         item.type = ACTION_RELATION;
         item.data_count = 1;
-        LIST_APPEND_VALUE(block->items, item);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->items, item);
 
         data.flags = 0;
         data.type = ACTION_DATA_TYPE_RELATION;
         data.u.relation = relation;
-        LIST_APPEND_VALUE(block->data, data);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->data, data);
     }
 }
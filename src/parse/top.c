@@ -1,4 +1,5 @@
 #include <errno.h>
+#include <time.h>
 
 #include "core/log.h"
 #include "core/window.h"
@@ -11,6 +12,122 @@
 #include "parse/top.h"
 #include "parse/utility.h"
 
+/* a sourced file that was parsed before */
+struct parsed_source {
+    /* the path the file was sourced with */
+    char *path;
+    /* the hash of the aliases when the file was parsed */
+    uint64_t alias_hash;
+    /* the time the file was parsed */
+    long long parse_time;
+    /* the file followed by all files it sourced */
+    LIST(struct parse_file, files);
+    /* the parsed actions */
+    ActionBlock *actions;
+};
+
+/* All sourced files that were parsed without errors and without setting any
+ * aliases or groups.  These do not need to be parsed again as long as they and
+ * the aliases stay the same.
+ */
+static struct {
+    LIST(struct parsed_source, sources);
+} source_cache;
+
+/* Append a deep copy of @actions to @block. */
+static void append_actions(Parser *parser, struct parse_action_block *block,
+        const ActionBlock *actions)
+{
+    size_t data_count = 0;
+    struct action_data data;
+
+    ARENA_LIST_APPEND(&parser->arena, block->items, actions->items,
+            actions->number_of_items);
+    for (size_t i = 0; i < actions->number_of_items; i++) {
+        data_count += actions->items[i].data_count;
+    }
+    for (size_t i = 0; i < data_count; i++) {
+        data = actions->data[i];
+        duplicate_action_data(&data);
+        ARENA_LIST_APPEND_VALUE(&parser->arena, block->data, data);
+    }
+}
+
+/* Find the cached parse result of the file at @path.
+ *
+ * @return NULL if there is none or it is outdated.
+ */
+static struct parsed_source *find_parsed_source(Parser *parser,
+        const char *path)
+{
+    struct parsed_source *source = NULL;
+    Parser *upper;
+
+    for (size_t i = 0; i < source_cache.sources_length; i++) {
+        if (strcmp(source_cache.sources[i].path, path) == 0) {
+            source = &source_cache.sources[i];
+            break;
+        }
+    }
+
+    if (source == NULL || source->alias_hash != get_alias_hash()) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < source->files_length; i++) {
+        /* the file might now source one of the upper files */
+        for (upper = parser; upper != NULL; upper = upper->upper_parser) {
+            if (upper->file_path != NULL &&
+                    strcmp(upper->file_path, source->files[i].path) == 0) {
+                return NULL;
+            }
+        }
+
+        if (!is_parse_file_unchanged(&source->files[i], source->parse_time)) {
+            return NULL;
+        }
+    }
+    return source;
+}
+
+/* Remember the parse result of @sub_parser. */
+static void cache_parsed_source(const char *path, uint64_t alias_hash,
+        long long parse_time, const Parser *sub_parser, ActionBlock *actions)
+{
+    struct parsed_source *source = NULL;
+    struct parse_file file;
+
+    for (size_t i = 0; i < source_cache.sources_length; i++) {
+        if (strcmp(source_cache.sources[i].path, path) == 0) {
+            source = &source_cache.sources[i];
+            break;
+        }
+    }
+
+    if (source == NULL) {
+        LIST_APPEND(source_cache.sources, NULL, 1);
+        source = &source_cache.sources[source_cache.sources_length - 1];
+        ZERO(source, 1);
+        source->path = xstrdup(path);
+    } else {
+        free_parse_files(source->files, source->files_length);
+        source->files = NULL;
+        source->files_length = 0;
+        source->files_capacity = 0;
+        dereference_action_block(source->actions);
+    }
+
+    source->alias_hash = alias_hash;
+    source->parse_time = parse_time;
+    for (size_t i = 0; i < sub_parser->files_length; i++) {
+        file = sub_parser->files[i];
+        file.path = xstrdup(file.path);
+        LIST_APPEND_VALUE(source->files, file);
+    }
+    reference_action_block(actions);
+    source->actions = actions;
+}
+
 /* Parse all after a `source` keyword. */
 static void continue_parsing_source(Parser *parser,
         struct parse_action_block *block)
@@ -18,35 +135,62 @@ static void continue_parsing_source(Parser *parser,
     Parser *upper;
     Parser *sub_parser;
     struct parse_action_block sub_block;
+    char *path;
+    const struct parsed_source *source;
+    struct parse_file file;
+    uint64_t alias_hash;
+    unsigned group_change_count;
+    long long parse_time;
+    ActionBlock *actions;
 
     if (read_string(parser) != OK) {
         emit_parse_error(parser, "expected file string");
         return;
     }
 
+    path = duplicate_temporary_string(parser);
+
     /* Check for a recursive sourcing.  This simple check always works
      * because sourcing is not conditional, it always happens.
      */
     for (upper = parser; upper != NULL; upper = upper->upper_parser) {
         if (upper->file_path != NULL &&
-                strcmp(upper->file_path, parser->string) == 0) {
+                strcmp(upper->file_path, path) == 0) {
             break;
         }
     }
     if (upper != NULL) {
         emit_parse_error(parser, "sourcing file \"%s\" recursively",
-                parser->string);
+                path);
+        return;
+    }
+
+    /* splice in the actions of an unchanged file without parsing it again */
+    source = find_parsed_source(parser, path);
+    if (source != NULL) {
+        LOG_DEBUG("using the parsed actions of %s\n",
+                path);
+        append_actions(parser, block, source->actions);
+        for (size_t i = 0; i < source->files_length; i++) {
+            file = source->files[i];
+            file.path = xstrdup(file.path);
+            LIST_APPEND_VALUE(parser->files, file);
+        }
         return;
     }
 
-    sub_parser = create_file_parser(parser->string);
+    sub_parser = create_file_parser(path);
     if (sub_parser == NULL) {
         emit_parse_error(parser, "can not source \"%s\": %s",
-                parser->string, strerror(errno));
+                path, strerror(errno));
         return;
     }
     sub_parser->upper_parser = parser;
 
+    alias_hash = get_alias_hash();
+    group_change_count = get_group_change_count();
+    parse_time = time(NULL);
+
     ZERO(&sub_block, 1);
     while (parse_top(sub_parser, &sub_block) == OK) {
         /* nothing */
@@ -54,14 +198,22 @@ static void continue_parsing_source(Parser *parser,
 
     /* if parsing succeeds, append the parsed items */
     if (sub_parser->error_count == 0) {
-        LIST_APPEND(block->items,
-                sub_block.items,
-                sub_block.items_length);
+        actions = convert_parse_action_block(&sub_block);
+        append_actions(parser, block, actions);
 
-        LIST_APPEND(block->data,
-                sub_block.data,
-                sub_block.data_length);
+        /* a file setting aliases or groups must be parsed every time */
+        if (alias_hash == get_alias_hash() &&
+                group_change_count == get_group_change_count()) {
+            cache_parsed_source(path, alias_hash, parse_time, sub_parser,
+                    actions);
+        }
+        dereference_action_block(actions);
     }
+    clear_parse_action_block(&sub_block);
+
+    /* the sourced files are part of the upper file */
+    LIST_APPEND(parser->files, sub_parser->files, sub_parser->files_length);
+    sub_parser->files_length = 0;
 
     parser->error_count += sub_parser->error_count;
 
@@ -125,21 +277,21 @@ int parse_top(Parser *parser, struct parse_action_block *block)
         (void) get_stream_character(parser);
         /* start from the top */
         return parse_top(parser, block);
-    } else if (strcmp(parser->string, "alias") == 0) {
+    } else if (is_string_equal(parser, "alias")) {
         continue_parsing_alias(parser);
-    } else if (strcmp(parser->string, "group") == 0) {
+    } else if (is_string_equal(parser, "group")) {
         continue_parsing_group(parser);
-    } else if (strcmp(parser->string, "relate") == 0) {
+    } else if (is_string_equal(parser, "relate")) {
         continue_parsing_relation(parser, block);
-    } else if (strcmp(parser->string, "unrelate") == 0) {
+    } else if (is_string_equal(parser, "unrelate")) {
         continue_parsing_unrelate(parser, block);
-    } else if (strcmp(parser->string, "source") == 0) {
+    } else if (is_string_equal(parser, "source")) {
         continue_parsing_source(parser, block);
-    } else if (strcmp(parser->string, "unalias") == 0) {
+    } else if (is_string_equal(parser, "unalias")) {
         continue_parsing_unalias(parser);
-    } else if (strcmp(parser->string, "unbind") == 0) {
+    } else if (is_string_equal(parser, "unbind")) {
         continue_parsing_unbind(parser, block);
-    } else if (strcmp(parser->string, "ungroup") == 0) {
+    } else if (is_string_equal(parser, "ungroup")) {
         continue_parsing_ungroup(parser, block);
     } else {
         if (continue_parsing_actions(parser, block) != OK) {
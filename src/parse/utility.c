@@ -117,10 +117,41 @@ static bool is_word_character(int character)
     return true;
 }
 
+/* Append @character to the string that is being read.
+ *
+ * @index is the position of @character within the input.  As long as all
+ * characters follow each other within the input, the string is only a pointer
+ * into the input.
+ */
+static void append_string_character(Parser *parser, size_t index,
+        int character, size_t *start_index, bool *is_buffered)
+{
+    if (!*is_buffered) {
+        if (parser->string_length == 0) {
+            *start_index = index;
+        }
+        if (index == *start_index + parser->string_length &&
+                (unsigned char) parser->input[index] == character) {
+            parser->string_length++;
+            return;
+        }
+
+        /* the string differs from the input from here on */
+        parser->string_buffer_length = 0;
+        LIST_APPEND(parser->string_buffer, &parser->input[*start_index],
+                parser->string_length);
+        *is_buffered = true;
+    }
+    LIST_APPEND_VALUE(parser->string_buffer, character);
+    parser->string_length++;
+}
+
 /* Read a string/word but do not resolve as an alias. */
 int read_string_no_alias(Parser *parser)
 {
     int character;
+    size_t start_index = 0;
+    bool is_buffered = false;
 
     skip_blanks(parser);
 
@@ -139,16 +170,20 @@ int read_string_no_alias(Parser *parser)
                 character != quote && character != EOF && character != '\n') {
             /* escape any characters following \ */
             if (character == '\\') {
+                const size_t backslash_index = parser->index - 1;
+
                 character = get_stream_character(parser);
                 /* keep the \ for pattern characters */
                 if (is_pattern_character(character)) {
-                    LIST_APPEND_VALUE(parser->string, '\\');
+                    append_string_character(parser, backslash_index, '\\',
+                            &start_index, &is_buffered);
                 }
                 if (character == EOF || character == '\n') {
                     break;
                 }
             }
-            LIST_APPEND_VALUE(parser->string, character);
+            append_string_character(parser, parser->index - 1, character,
+                    &start_index, &is_buffered);
         }
 
         if (character != quote) {
@@ -163,16 +198,20 @@ int read_string_no_alias(Parser *parser)
 
             /* escape any characters following \ */
             if (character == '\\') {
+                const size_t backslash_index = parser->index - 1;
+
                 character = get_stream_character(parser);
                 /* keep the \ for pattern characters */
                 if (is_pattern_character(character)) {
-                    LIST_APPEND_VALUE(parser->string, '\\');
+                    append_string_character(parser, backslash_index, '\\',
+                            &start_index, &is_buffered);
                 }
                 if (character == EOF || character == '\n') {
                     break;
                 }
             }
-            LIST_APPEND_VALUE(parser->string, character);
+            append_string_character(parser, parser->index - 1, character,
+                    &start_index, &is_buffered);
         }
 
         if (parser->string_length == 0) {
@@ -180,9 +219,11 @@ int read_string_no_alias(Parser *parser)
         }
     }
 
-    LIST_APPEND_VALUE(parser->string, '\0');
-    parser->string_length--;
-
+    if (is_buffered) {
+        parser->string = parser->string_buffer;
+    } else {
+        parser->string = &parser->input[start_index];
+    }
     return OK;
 }
 
@@ -194,14 +235,35 @@ int read_string(Parser *parser)
     }
 
     if (!parser->is_string_quoted) {
-        const char *const alias = resolve_alias(parser->string);
+        const char *const alias = resolve_alias(parser->string,
+                parser->string_length);
         if (alias != NULL) {
-            LOG_DEBUG("resolved %s to %s\n",
-                    parser->string, alias);
+            LOG_DEBUG("resolved %.*s to %s\n",
+                    (int) parser->string_length, parser->string, alias);
 
-            LIST_SET(parser->string, 0, alias, strlen(alias) + 1);
-            parser->string_length--;
+            parser->string = alias;
+            parser->string_length = strlen(alias);
         }
     }
     return OK;
 }
+
+/* Check if the last read string is equal to @string. */
+bool is_string_equal(const Parser *parser, const char *string)
+{
+    return strlen(string) == parser->string_length &&
+        memcmp(parser->string, string, parser->string_length) == 0;
+}
+
+/* Duplicate the last read string into a null-terminated string. */
+char *duplicate_string(const Parser *parser)
+{
+    return xstrndup(parser->string, parser->string_length);
+}
+
+/* Duplicate the last read string into the arena of @parser. */
+char *duplicate_temporary_string(Parser *parser)
+{
+    return duplicate_arena_string(&parser->arena, parser->string,
+            parser->string_length);
+}
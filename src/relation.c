@@ -1,28 +1,104 @@
+#include <stdint.h>
+
 #include "relation.h"
 #include "log.h"
 #include "window.h"
+#include "utility/hash_table.h"
+#include "utility/intern.h"
 #include "utility/list.h"
 
 /* the window relations */
 LIST(struct window_relation, window_relations);
 
-/* These two are needed to add/remove relations while relations are
- * running.  There would otherwise be numerous issues like base pointer changes,
- * index shifts.  These are all cleanly handled by these variables.
+/* The index of the currently running relation.  Together with the
+ * candidates of the relation matcher, this is needed to add/remove relations
+ * while relations are running.
  *
  * See below in run_window_relations() on how they are used.
  */
+static size_t running_relation;
+
+/* the kind of a pattern */
+typedef enum {
+    /* the pattern matches exactly one string */
+    PATTERN_LITERAL,
+    /* the pattern is a literal followed by a single '*' */
+    PATTERN_PREFIX,
+    /* anything else */
+    PATTERN_GLOB,
+} pattern_kind_t;
+
+/* a list of indexes into `window_relations` */
+struct relation_indexes {
+    LIST(size_t, indexes);
+};
+
+/* the remembered matching relations of a window instance and class */
+struct relation_memo_entry {
+    /* references to the interned instance and class */
+    const char *instance, *class;
+    /* the matching relations */
+    struct relation_indexes matches;
+};
+
+/* a node within a trie of prefixes */
+struct prefix_node {
+    /* the relations whose prefix ends at this node */
+    struct relation_indexes relations;
+    /* the nodes following this one */
+    LIST(struct prefix_edge {
+        /* the next character of the prefix */
+        unsigned char character;
+        /* the index of the node within the trie */
+        size_t node;
+    }, edges);
+};
 
-/* the number of relations before starting to match relations */
-size_t old_window_relations_length;
-/* the index of the currently running relation */
-size_t running_relation;
+/* the index of relations by one of their patterns */
+struct relation_side {
+    /* literal patterns to `struct relation_indexes` */
+    HashTable literals;
+    /* the trie of prefix patterns, the first node is the root */
+    LIST(struct prefix_node, nodes);
+};
+
+/* An index over all relations to quickly find the ones that may match a
+ * window.
+ *
+ * Each relation is put into exactly one place: the literals or the prefixes
+ * of its class pattern or, if that is a glob, of its instance pattern.  If
+ * both patterns are globs, the relation goes into the residual list.
+ *
+ * After any relation changed, the index is built again on the next match.
+ */
+static struct {
+    /* the relations by their instance and class pattern joined by a null
+     * byte, the values are the indexes within `window_relations`
+     */
+    HashTable patterns;
+    /* if the index below must be built again */
+    bool is_outdated;
+    /* the index by class and by instance pattern */
+    struct relation_side class, instance;
+    /* the relations with no literal part to index */
+    struct relation_indexes residual;
+    /* the matching relations of windows by the pointers of their interned
+     * instance and class to `struct relation_memo_entry`, the entries keep a
+     * reference to the strings so the pointers are not reused while they are
+     * in here
+     */
+    HashTable memo;
+    /* the relations that may match the window in the current run */
+    struct relation_indexes candidates;
+    /* the index of the candidate that runs */
+    size_t running_candidate;
+} relation_matcher;
 
 /* Clear the memory occupied by the window relation. */
 void clear_window_relation(struct window_relation *relation)
 {
-    free(relation->instance_pattern);
-    free(relation->class_pattern);
+    xfree(relation->instance_pattern);
+    xfree(relation->class_pattern);
     dereference_action_block(relation->actions);
 }
 
@@ -34,9 +110,358 @@ void duplicate_window_relation(struct window_relation *relation)
     reference_action_block(relation->actions);
 }
 
+/* Join @instance and @class with a null byte in between to use them as key.
+ *
+ * NULL is joined as empty string.
+ *
+ * @return the allocated key of @length bytes.
+ */
+static char *get_instance_class_key(const char *instance, const char *class,
+        _Out size_t *length)
+{
+    size_t instance_length, class_length;
+    char *key;
+
+    if (instance == NULL) {
+        instance = "";
+    }
+    if (class == NULL) {
+        class = "";
+    }
+
+    instance_length = strlen(instance);
+    class_length = strlen(class);
+    *length = instance_length + 1 + class_length;
+    key = xmalloc(*length);
+    memcpy(key, instance, instance_length + 1);
+    memcpy(&key[instance_length + 1], class, class_length);
+    return key;
+}
+
+/* Get the key of @relation within the table of patterns.
+ *
+ * @return the allocated key of @length bytes.
+ */
+static char *get_patterns_key(const struct window_relation *relation,
+        _Out size_t *length)
+{
+    return get_instance_class_key(relation->instance_pattern,
+            relation->class_pattern, length);
+}
+
+/* Put the relation at @index into the table of patterns. */
+static void add_relation_patterns(size_t index)
+{
+    char *key;
+    size_t length;
+
+    key = get_patterns_key(&window_relations[index], &length);
+    (void) add_hash_table_entry(&relation_matcher.patterns, key, length,
+            (void*) (uintptr_t) index);
+    xfree(key);
+}
+
+/* Find the index of the relation with the same patterns as @relation.
+ *
+ * @return `window_relations_length` if there is none.
+ */
+static size_t find_window_relation(const struct window_relation *relation)
+{
+    const struct hash_table_entry *entry;
+    char *key;
+    size_t length;
+
+    key = get_patterns_key(relation, &length);
+    entry = find_hash_table_entry(&relation_matcher.patterns, key, length);
+    xfree(key);
+    if (entry == NULL) {
+        return window_relations_length;
+    }
+    return (uintptr_t) entry->value;
+}
+
+/* Get the kind of @pattern.
+ *
+ * @literal is filled with the literal part of the pattern and must have space
+ *          for as many bytes as @pattern has.
+ * @length is set to the length of @literal.
+ */
+static pattern_kind_t get_pattern_kind(const char *pattern,
+        _Out char *literal, _Out size_t *length)
+{
+    *length = 0;
+    for (; pattern[0] != '\0'; pattern++) {
+        switch (pattern[0]) {
+        case '*':
+            /* an empty prefix matches anything, it is not worth indexing */
+            if (pattern[1] == '\0' && *length > 0) {
+                return PATTERN_PREFIX;
+            }
+            return PATTERN_GLOB;
+
+        case '?':
+        case '[':
+            return PATTERN_GLOB;
+
+        case '\\':
+            /* escaped special characters are literal */
+            if (pattern[1] == '\\' || pattern[1] == '?' ||
+                    pattern[1] == '*' || pattern[1] == '[') {
+                pattern++;
+            }
+            break;
+        }
+        literal[(*length)++] = pattern[0];
+    }
+    return PATTERN_LITERAL;
+}
+
+/* Get the node following @node with @character within the trie of @side.
+ *
+ * @return 0 if there is none as the root can not follow any node.
+ */
+static size_t get_next_prefix_node(const struct relation_side *side,
+        size_t node, unsigned char character)
+{
+    const struct prefix_node *const prefix_node = &side->nodes[node];
+
+    for (size_t i = 0; i < prefix_node->edges_length; i++) {
+        if (prefix_node->edges[i].character == character) {
+            return prefix_node->edges[i].node;
+        }
+    }
+    return 0;
+}
+
+/* Put the relation at @index into the trie of @side with @prefix. */
+static void add_relation_prefix(struct relation_side *side,
+        const char *prefix, size_t length, size_t index)
+{
+    struct prefix_edge edge;
+    size_t node = 0, next;
+
+    if (side->nodes_length == 0) {
+        LIST_APPEND(side->nodes, NULL, 1);
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        next = get_next_prefix_node(side, node, prefix[i]);
+        if (next == 0) {
+            next = side->nodes_length;
+            LIST_APPEND(side->nodes, NULL, 1);
+            edge.character = prefix[i];
+            edge.node = next;
+            LIST_APPEND_VALUE(side->nodes[node].edges, edge);
+        }
+        node = next;
+    }
+    LIST_APPEND_VALUE(side->nodes[node].relations.indexes, index);
+}
+
+/* Put the relation at @index into the literals of @side. */
+static void add_relation_literal(struct relation_side *side,
+        const char *literal, size_t length, size_t index)
+{
+    struct hash_table_entry *entry;
+    struct relation_indexes *relations;
+
+    entry = find_hash_table_entry(&side->literals, literal, length);
+    if (entry == NULL) {
+        ALLOCATE_ZERO(relations, 1);
+        entry = add_hash_table_entry(&side->literals, literal, length,
+                relations);
+    }
+    relations = entry->value;
+    LIST_APPEND_VALUE(relations->indexes, index);
+}
+
+/* Put the relation at @index into @side if @pattern has a literal part.
+ *
+ * @return if the relation was put into @side.
+ */
+static bool index_relation(struct relation_side *side, const char *pattern,
+        size_t index)
+{
+    char *literal;
+    size_t length;
+    pattern_kind_t kind;
+
+    literal = xmalloc(strlen(pattern) + 1);
+    kind = get_pattern_kind(pattern, literal, &length);
+    if (kind == PATTERN_LITERAL) {
+        add_relation_literal(side, literal, length, index);
+    } else if (kind == PATTERN_PREFIX) {
+        add_relation_prefix(side, literal, length, index);
+    }
+    xfree(literal);
+    return kind != PATTERN_GLOB;
+}
+
+/* Free all memory of @side. */
+static void clear_relation_side(struct relation_side *side)
+{
+    struct relation_indexes *relations;
+
+    for (size_t i = 0; i < side->literals.entries_length; i++) {
+        relations = side->literals.entries[i].value;
+        LIST_CLEAR(relations->indexes);
+        xfree(relations);
+    }
+    clear_hash_table(&side->literals);
+
+    for (size_t i = 0; i < side->nodes_length; i++) {
+        LIST_CLEAR(side->nodes[i].relations.indexes);
+        LIST_CLEAR(side->nodes[i].edges);
+    }
+    LIST_CLEAR(side->nodes);
+}
+
+/* Forget all memoized matches. */
+static void clear_relation_memo(void)
+{
+    struct relation_memo_entry *memo;
+
+    for (size_t i = 0; i < relation_matcher.memo.entries_length; i++) {
+        memo = relation_matcher.memo.entries[i].value;
+        release_string(memo->instance);
+        release_string(memo->class);
+        LIST_CLEAR(memo->matches.indexes);
+        xfree(memo);
+    }
+    clear_hash_table(&relation_matcher.memo);
+}
+
+/* Build the index of all relations again. */
+static void build_relation_matcher(void)
+{
+    struct window_relation *relation;
+
+    clear_relation_memo();
+    clear_relation_side(&relation_matcher.class);
+    clear_relation_side(&relation_matcher.instance);
+    relation_matcher.residual.indexes_length = 0;
+
+    for (size_t i = 0; i < window_relations_length; i++) {
+        relation = &window_relations[i];
+        if (!index_relation(&relation_matcher.class,
+                    relation->class_pattern, i) &&
+                !index_relation(&relation_matcher.instance,
+                    relation->instance_pattern, i)) {
+            LIST_APPEND_VALUE(relation_matcher.residual.indexes, i);
+        }
+    }
+
+    relation_matcher.is_outdated = false;
+}
+
+/* Append @relations to the candidates. */
+static void add_candidates(const struct relation_indexes *relations)
+{
+    LIST_APPEND(relation_matcher.candidates.indexes, relations->indexes,
+            relations->indexes_length);
+}
+
+/* Add all relations of @side that might match @string to the candidates. */
+static void collect_candidates(const struct relation_side *side,
+        const char *string)
+{
+    const struct hash_table_entry *entry;
+    size_t node = 0;
+
+    if (string == NULL) {
+        string = "";
+    }
+
+    entry = find_hash_table_entry(&side->literals, string, strlen(string));
+    if (entry != NULL) {
+        add_candidates(entry->value);
+    }
+
+    if (side->nodes_length == 0) {
+        return;
+    }
+
+    /* go along the trie and collect all prefixes of @string */
+    do {
+        add_candidates(&side->nodes[node].relations);
+        if (string[0] == '\0') {
+            break;
+        }
+        node = get_next_prefix_node(side, node, string[0]);
+        string++;
+    } while (node != 0);
+}
+
+/* Compare two relation indexes. */
+static int compare_indexes(const void *a, const void *b)
+{
+    const size_t index_a = *(const size_t*) a;
+    const size_t index_b = *(const size_t*) b;
+
+    return index_a < index_b ? -1 : index_a > index_b;
+}
+
+/* Get the indexes of all relations matching @instance and @class in the order
+ * they were set.
+ *
+ * @instance and @class must be interned.
+ *
+ * The result is memoized until the relations change.
+ */
+static const struct relation_indexes *find_matching_relations(
+        const char *instance, const char *class)
+{
+    struct relation_indexes *const candidates = &relation_matcher.candidates;
+    const char *const key[2] = { instance, class };
+    struct relation_memo_entry *memo;
+    const struct hash_table_entry *entry;
+    const struct window_relation *relation;
+
+    if (relation_matcher.is_outdated) {
+        build_relation_matcher();
+    }
+
+    /* interned strings are equal exactly when their pointers are */
+    entry = find_hash_table_entry(&relation_matcher.memo,
+            (const char*) key, sizeof(key));
+    if (entry != NULL) {
+        memo = entry->value;
+        return &memo->matches;
+    }
+
+    /* find all relations that might match */
+    candidates->indexes_length = 0;
+    collect_candidates(&relation_matcher.class, class);
+    collect_candidates(&relation_matcher.instance, instance);
+    add_candidates(&relation_matcher.residual);
+    /* keep the order in which the relations were set */
+    SORT(candidates->indexes, candidates->indexes_length, compare_indexes);
+
+    ALLOCATE_ZERO(memo, 1);
+    memo->instance = reference_string(instance);
+    memo->class = reference_string(class);
+    for (size_t i = 0; i < candidates->indexes_length; i++) {
+        relation = &window_relations[candidates->indexes[i]];
+        if (matches_pattern(relation->instance_pattern, instance) &&
+                matches_pattern(relation->class_pattern, class)) {
+            LIST_APPEND_VALUE(memo->matches.indexes, candidates->indexes[i]);
+        }
+    }
+
+    /* windows with ever new names should not grow the memo forever */
+    if (relation_matcher.memo.entries_length >= MAX_RELATION_MEMO_SIZE) {
+        clear_relation_memo();
+    }
+    (void) add_hash_table_entry(&relation_matcher.memo,
+            (const char*) key, sizeof(key), memo);
+    return &memo->matches;
+}
+
 /* Remove the window relation at given index. */
 static void remove_window_relation(size_t index)
 {
+    size_t *candidate;
+
     LOG_DEBUG("removing window relation %s,%s\n",
             window_relations[index].instance_pattern,
             window_relations[index].class_pattern);
@@ -50,8 +475,24 @@ static void remove_window_relation(size_t index)
         running_relation--;
     }
 
-    /* tell run_window_relations() to check one less relation */
-    old_window_relations_length--;
+    /* shift the indexes of the candidates that still need to run */
+    for (size_t i = relation_matcher.running_candidate + 1;
+            i < relation_matcher.candidates.indexes_length;
+            i++) {
+        candidate = &relation_matcher.candidates.indexes[i];
+        if (*candidate == index) {
+            *candidate = SIZE_MAX;
+        } else if (*candidate > index && *candidate != SIZE_MAX) {
+            (*candidate)--;
+        }
+    }
+
+    /* all following indexes moved */
+    clear_hash_table(&relation_matcher.patterns);
+    for (size_t i = 0; i < window_relations_length; i++) {
+        add_relation_patterns(i);
+    }
+    relation_matcher.is_outdated = true;
 }
 
 /* Remove the currently running window relation. */
@@ -65,18 +506,9 @@ void remove_current_window_relation(void)
 /* Set a relation from window instance/class name to actions. */
 void set_window_relation(const struct window_relation *relation)
 {
-    size_t i = 0;
-
-    for (; i < window_relations_length; i++) {
-        struct window_relation *const existing_relation = &window_relations[i];
-        if (strcmp(existing_relation->instance_pattern,
-                    relation->instance_pattern) == 0 &&
-                strcmp(existing_relation->class_pattern,
-                    relation->class_pattern) == 0) {
-            break;
-        }
-    }
+    size_t i;
 
+    i = find_window_relation(relation);
     if (i == window_relations_length) {
         if (relation->actions != NULL) {
             struct window_relation new_relation;
@@ -87,10 +519,13 @@ void set_window_relation(const struct window_relation *relation)
             new_relation = *relation;
             duplicate_window_relation(&new_relation);
             LIST_APPEND_VALUE(window_relations, new_relation);
+            add_relation_patterns(i);
+            relation_matcher.is_outdated = true;
         }
     } else if (relation->actions == NULL) {
         remove_window_relation(i);
     } else {
+        /* the patterns stay the same so the index is still valid */
         clear_window_relation(&window_relations[i]);
         window_relations[i] = *relation;
         duplicate_window_relation(&window_relations[i]);
@@ -107,6 +542,8 @@ void unset_window_relations(void)
     }
 
     LIST_CLEAR(window_relations);
+    clear_hash_table(&relation_matcher.patterns);
+    relation_matcher.is_outdated = true;
 }
 
 /* Run all actions within an assocation after selecting @window. */
@@ -124,32 +561,37 @@ static inline void run_window_relation(FcWindow *window,
 bool run_window_relations(FcWindow *window)
 {
     bool has_match = false;
-    struct window_relation *relation;
+    const char *const instance = window->properties.instance;
+    const char *const class = window->properties.class;
+    struct relation_indexes *const candidates = &relation_matcher.candidates;
+    const struct relation_indexes *matches;
+    size_t index;
 
-    old_window_relations_length = window_relations_length;
+    /* copy the matches as relations may change while running, relations
+     * added while running are not considered
+     */
+    matches = find_matching_relations(instance, class);
+    candidates->indexes_length = 0;
+    add_candidates(matches);
 
-    /* find all relations that match the window */
-    for (size_t i = 0; i < old_window_relations_length; i++) {
-        relation = &window_relations[i];
-        if (matches_pattern(relation->instance_pattern,
-                    window->properties.class.res_name) &&
-                matches_pattern(relation->class_pattern,
-                        window->properties.class.res_class)) {
-            /* set back and forth in case the index changes because a
-             * relation was removed
-             */
-            running_relation = i;
-            run_window_relation(window, relation);
-            i = running_relation;
-
-            has_match = true;
+    for (relation_matcher.running_candidate = 0;
+            relation_matcher.running_candidate < candidates->indexes_length;
+            relation_matcher.running_candidate++) {
+        index = candidates->indexes[relation_matcher.running_candidate];
+        /* the relation was removed by a previous relation */
+        if (index == SIZE_MAX) {
+            continue;
         }
+
+        running_relation = index;
+        run_window_relation(window, &window_relations[index]);
+        has_match = true;
     }
+    candidates->indexes_length = 0;
 
     if (!has_match) {
         LOG_DEBUG("no relation for %s,%s\n",
-                window->properties.class.res_name,
-                window->properties.class.res_class);
+                instance, class);
     }
 
     return has_match;
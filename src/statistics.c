@@ -0,0 +1,182 @@
+#define _POSIX_C_SOURCE 200809L /* clock_gettime() */
+
+#include <inttypes.h>
+#include <time.h>
+
+#include <X11/X.h>
+
+#include "log.h"
+#include "statistics.h"
+
+/* the number of buckets for the round-trips per cycle */
+#define CYCLE_BUCKETS 12
+
+/* the names of the round-trip kinds */
+static const char *round_trip_names[ROUND_TRIP_MAX] = {
+    [ROUND_TRIP_GET_WINDOW_PROPERTY] = "XGetWindowProperty",
+    [ROUND_TRIP_GET_WINDOW_ATTRIBUTES] = "XGetWindowAttributes",
+    [ROUND_TRIP_GET_GEOMETRY] = "XGetGeometry",
+    [ROUND_TRIP_QUERY_POINTER] = "XQueryPointer",
+    [ROUND_TRIP_QUERY_TREE] = "XQueryTree",
+    [ROUND_TRIP_SYNC] = "XSync",
+};
+
+/* all counted statistics */
+static struct {
+    /* the events by type, extension events go into the last slot */
+    struct latency_histogram events[LASTEvent + 1];
+    /* the actions by type */
+    struct latency_histogram actions[ACTION_MAX];
+    /* the total number of round-trips of each kind */
+    size_t round_trips[ROUND_TRIP_MAX];
+    /* the number of round-trips within the current cycle */
+    size_t cycle_round_trips;
+    /* the number of ended cycles */
+    size_t cycle_count;
+    /* the most round-trips within a single cycle */
+    size_t maximum_cycle_round_trips;
+    /* the number of cycles by their round-trips: 0, 1, 2-3, 4-7 and so on */
+    size_t cycle_buckets[CYCLE_BUCKETS];
+} statistics;
+
+/* Get the bucket for @value: 0 for 0, 1 for 1, 2 for 2-3, 3 for 4-7 etc. */
+static unsigned get_bucket(uint64_t value, unsigned number_of_buckets)
+{
+    unsigned bucket = 0;
+
+    while (value > 0 && bucket + 1 < number_of_buckets) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/* Get the current time in nanoseconds to measure a latency. */
+uint64_t get_statistics_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/* Add the time since @start to @histogram. */
+static void add_latency(struct latency_histogram *histogram, uint64_t start)
+{
+    uint64_t latency;
+
+    latency = get_statistics_time() - start;
+    histogram->count++;
+    histogram->total += latency;
+    histogram->maximum = MAX(histogram->maximum, latency);
+    histogram->buckets[get_bucket(latency / 1000, LATENCY_BUCKETS)]++;
+}
+
+/* Count the handling of an event of @type that started at @start. */
+void count_event(int type, uint64_t start)
+{
+    if (type < 0 || type >= LASTEvent) {
+        type = LASTEvent;
+    }
+    add_latency(&statistics.events[type], start);
+}
+
+/* Count running an action of @type that started at @start. */
+void count_action(action_type_t type, uint64_t start)
+{
+    add_latency(&statistics.actions[type], start);
+}
+
+/* Count a request of kind @round_trip that waits for a reply. */
+void count_round_trip(round_trip_t round_trip)
+{
+    statistics.round_trips[round_trip]++;
+    statistics.cycle_round_trips++;
+}
+
+/* End the current cycle of the event loop. */
+void end_statistics_cycle(void)
+{
+    const size_t count = statistics.cycle_round_trips;
+
+    statistics.cycle_count++;
+    statistics.maximum_cycle_round_trips =
+        MAX(statistics.maximum_cycle_round_trips, count);
+    statistics.cycle_buckets[get_bucket(count, CYCLE_BUCKETS)]++;
+    statistics.cycle_round_trips = 0;
+}
+
+/* Write @histogram with given @name into @file. */
+static void write_histogram(FILE *file, const char *name,
+        const struct latency_histogram *histogram)
+{
+    if (histogram->count == 0) {
+        return;
+    }
+
+    fprintf(file, "%s: %zu calls, %" PRIu64 "us mean, %" PRIu64 "us max\n",
+            name, histogram->count,
+            histogram->total / histogram->count / 1000,
+            histogram->maximum / 1000);
+
+    /* only write the buckets that have something */
+    fputs(" ", file);
+    for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+        if (histogram->buckets[i] == 0) {
+            continue;
+        }
+        if (i + 1 == LATENCY_BUCKETS) {
+            fprintf(file, " >=%" PRIu64 "us:%zu",
+                    (uint64_t) 1 << (i - 1), histogram->buckets[i]);
+        } else {
+            fprintf(file, " <%" PRIu64 "us:%zu",
+                    (uint64_t) 1 << i, histogram->buckets[i]);
+        }
+    }
+    fputc('\n', file);
+}
+
+/* Write all statistics into @file. */
+void write_statistics(FILE *file)
+{
+    const char *name;
+
+    fputs("[Events]:\n", file);
+    for (int i = 0; i <= LASTEvent; i++) {
+        name = i == LASTEvent ? "extension" : event_to_string(i);
+        if (name != NULL) {
+            write_histogram(file, name, &statistics.events[i]);
+        }
+    }
+
+    fputs("[Actions]:\n", file);
+    for (action_type_t i = 0; i < ACTION_MAX; i++) {
+        write_histogram(file, get_action_string(i), &statistics.actions[i]);
+    }
+
+    fputs("[Round-trips]:\n", file);
+    for (round_trip_t i = 0; i < ROUND_TRIP_MAX; i++) {
+        fprintf(file, "%s: %zu\n",
+                round_trip_names[i], statistics.round_trips[i]);
+    }
+
+    fprintf(file, "per cycle: %zu cycles, %zu max\n ",
+            statistics.cycle_count, statistics.maximum_cycle_round_trips);
+    for (unsigned i = 0; i < CYCLE_BUCKETS; i++) {
+        if (statistics.cycle_buckets[i] == 0) {
+            continue;
+        }
+        if (i <= 1) {
+            fprintf(file, " %u:%zu",
+                    i, statistics.cycle_buckets[i]);
+        } else if (i + 1 == CYCLE_BUCKETS) {
+            fprintf(file, " >=%u:%zu",
+                    1u << (i - 1), statistics.cycle_buckets[i]);
+        } else {
+            fprintf(file, " %u-%u:%zu",
+                    1u << (i - 1), (1u << i) - 1,
+                    statistics.cycle_buckets[i]);
+        }
+    }
+    fputc('\n', file);
+}
@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200809L /* clock_gettime() */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "log.h"
+#include "trace.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+/* a recorded span */
+struct trace_span {
+    /* the category of the span */
+    const char *category;
+    /* the name of the span */
+    const char *name;
+    /* when the span began and ended in nanoseconds since tracing started, the
+     * end is 0 while the span is open
+     */
+    uint64_t begin, end;
+};
+
+/* the recorded spans */
+static struct {
+    /* if spans are recorded */
+    bool is_tracing;
+    /* when tracing started */
+    struct timespec start;
+    /* all recorded spans */
+    struct trace_span *spans;
+    /* the number of recorded spans */
+    size_t number_of_spans;
+    /* the number of spans that did not fit */
+    size_t dropped_count;
+    /* the indexes of the open spans or `SIZE_MAX` for dropped ones */
+    size_t open[TRACE_MAXIMUM_DEPTH];
+    /* the number of open spans, this can be more than the maximum depth */
+    unsigned depth;
+} trace;
+
+/* Get the nanoseconds since tracing started. */
+static uint64_t get_trace_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) (now.tv_sec - trace.start.tv_sec) * 1000000000 +
+        now.tv_nsec - trace.start.tv_nsec;
+}
+
+/* Check if spans are recorded. */
+bool is_tracing(void)
+{
+    return trace.is_tracing;
+}
+
+/* Start recording spans. */
+void start_trace(void)
+{
+    if (trace.is_tracing) {
+        return;
+    }
+
+    if (trace.spans == NULL) {
+        ALLOCATE(trace.spans, TRACE_MAXIMUM_SPANS);
+    }
+    trace.number_of_spans = 0;
+    trace.dropped_count = 0;
+    trace.depth = 0;
+    clock_gettime(CLOCK_MONOTONIC, &trace.start);
+    trace.is_tracing = true;
+}
+
+/* Write @nanoseconds as microseconds. */
+static void write_microseconds(FILE *file, uint64_t nanoseconds)
+{
+    fprintf(file, "%" PRIu64 ".%03u",
+            nanoseconds / 1000, (unsigned) (nanoseconds % 1000));
+}
+
+/* Stop recording spans and write them to the file at @path. */
+int stop_trace(const char *path)
+{
+    FILE *file;
+    uint64_t now;
+    const struct trace_span *span;
+
+    if (!trace.is_tracing) {
+        return OK;
+    }
+
+    now = get_trace_time();
+    trace.is_tracing = false;
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        return ERROR;
+    }
+
+    fputs("{\"traceEvents\":[\n", file);
+    for (size_t i = 0; i < trace.number_of_spans; i++) {
+        span = &trace.spans[i];
+        fprintf(file, "{\"cat\":\"%s\",\"name\":\"%s\",\"ph\":\"X\",\"ts\":",
+                span->category, span->name);
+        write_microseconds(file, span->begin);
+        fputs(",\"dur\":", file);
+        /* spans still open are ended now */
+        write_microseconds(file,
+                (span->end == 0 ? now : span->end) - span->begin);
+        fputs(",\"pid\":1,\"tid\":1},\n", file);
+    }
+    /* the last event without a trailing comma */
+    fprintf(file, "{\"name\":\"dropped spans\",\"ph\":\"i\",\"s\":\"g\","
+                "\"ts\":0,\"pid\":1,\"tid\":1,"
+                "\"args\":{\"count\":%zu}}\n",
+            trace.dropped_count);
+    fputs("],\"displayTimeUnit\":\"ns\"}\n", file);
+
+    LOG("wrote %zu trace spans to %s\n",
+            trace.number_of_spans, path);
+
+    /* the memory is not needed until the next trace */
+    xfree(trace.spans);
+    trace.spans = NULL;
+    trace.number_of_spans = 0;
+    return fclose(file) == 0 ? OK : ERROR;
+}
+
+/* Begin a span within the current span. */
+void begin_trace_span(const char *category, const char *name)
+{
+    struct trace_span *span;
+    size_t index;
+
+    if (!trace.is_tracing) {
+        return;
+    }
+
+    if (trace.depth >= TRACE_MAXIMUM_DEPTH) {
+        trace.dropped_count++;
+    } else if (trace.number_of_spans == TRACE_MAXIMUM_SPANS) {
+        trace.dropped_count++;
+        trace.open[trace.depth] = SIZE_MAX;
+    } else {
+        index = trace.number_of_spans++;
+        span = &trace.spans[index];
+        span->category = category;
+        span->name = name;
+        span->begin = get_trace_time();
+        span->end = 0;
+        trace.open[trace.depth] = index;
+    }
+    trace.depth++;
+}
+
+/* End the span last begun. */
+void end_trace_span(void)
+{
+    size_t index;
+
+    /* the span might have begun before tracing started */
+    if (!trace.is_tracing || trace.depth == 0) {
+        return;
+    }
+
+    trace.depth--;
+    if (trace.depth < TRACE_MAXIMUM_DEPTH) {
+        index = trace.open[trace.depth];
+        /* make sure an ended span is never taken as open */
+        if (index != SIZE_MAX) {
+            trace.spans[index].end = MAX(get_trace_time(), 1);
+        }
+    }
+}
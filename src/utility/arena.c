@@ -0,0 +1,93 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "utility/arena.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+/* a chunk of memory within an arena */
+struct arena_chunk {
+    /* the previous chunk */
+    struct arena_chunk *previous;
+    /* the number of bytes in `memory` */
+    size_t size;
+    /* the number of bytes in `memory` that are used */
+    size_t used;
+    /* the memory handed out */
+    union maximum_alignment memory[];
+};
+
+/* Allocate @size bytes within @arena. */
+void *allocate_arena_memory(Arena *arena, size_t size)
+{
+    struct arena_chunk *chunk;
+    void *pointer;
+
+    size = ALIGN_SIZE(MAX(size, 1));
+
+    chunk = arena->chunk;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        const size_t chunk_size = MAX(size, ARENA_CHUNK_SIZE);
+
+        chunk = xmalloc(sizeof(*chunk) + chunk_size);
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        chunk->previous = arena->chunk;
+        arena->chunk = chunk;
+    }
+
+    pointer = (unsigned char*) chunk->memory + chunk->used;
+    chunk->used += size;
+    arena->last_allocation = pointer;
+    return pointer;
+}
+
+/* Grow a region of @old_size bytes at @pointer within @arena to @new_size
+ * bytes.
+ */
+void *reallocate_arena_memory(Arena *arena, void *pointer,
+        size_t old_size, size_t new_size)
+{
+    struct arena_chunk *const chunk = arena->chunk;
+    void *new_pointer;
+
+    if (pointer != NULL && pointer == arena->last_allocation) {
+        const size_t start = (unsigned char*) pointer -
+            (unsigned char*) chunk->memory;
+
+        if (chunk->size - start >= new_size) {
+            chunk->used = start + ALIGN_SIZE(MAX(new_size, 1));
+            return pointer;
+        }
+    }
+
+    new_pointer = allocate_arena_memory(arena, new_size);
+    if (pointer != NULL) {
+        memcpy(new_pointer, pointer, MIN(old_size, new_size));
+    }
+    return new_pointer;
+}
+
+/* Copy @length bytes of @string into @arena and null-terminate it. */
+char *duplicate_arena_string(Arena *arena, const char *string, size_t length)
+{
+    char *duplicate;
+
+    duplicate = allocate_arena_memory(arena, length + 1);
+    memcpy(duplicate, string, length);
+    duplicate[length] = '\0';
+    return duplicate;
+}
+
+/* Free all memory of @arena. */
+void clear_arena(Arena *arena)
+{
+    struct arena_chunk *chunk, *previous;
+
+    for (chunk = arena->chunk; chunk != NULL; chunk = previous) {
+        previous = chunk->previous;
+        xfree(chunk);
+    }
+    arena->chunk = NULL;
+    arena->last_allocation = NULL;
+}
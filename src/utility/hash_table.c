@@ -0,0 +1,153 @@
+#include <stdlib.h>
+
+#include "utility/hash_table.h"
+#include "utility/xalloc.h"
+
+/* the number of slots a table starts with */
+#define HASH_TABLE_INITIAL_SLOTS 16
+
+/* Check if @entry has @name of @length bytes with given @hash. */
+static inline bool is_entry_named(const struct hash_table_entry *entry,
+        uint64_t hash, const char *name, size_t length)
+{
+    return entry->hash == hash && entry->length == length &&
+        memcmp(entry->name, name, length) == 0;
+}
+
+/* Get the slot the entry at @index is in. */
+static size_t get_entry_slot(const HashTable *table, size_t index)
+{
+    const size_t mask = table->number_of_slots - 1;
+    size_t slot;
+
+    slot = table->entries[index].hash & mask;
+    while (table->slots[slot] != index + 1) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/* Put the entry at @index into the first free slot for its hash. */
+static void insert_slot(HashTable *table, size_t index)
+{
+    const size_t mask = table->number_of_slots - 1;
+    size_t slot;
+
+    slot = table->entries[index].hash & mask;
+    while (table->slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    table->slots[slot] = index + 1;
+}
+
+/* Double the number of slots and put all entries into them again. */
+static void grow_slots(HashTable *table)
+{
+    if (table->number_of_slots == 0) {
+        table->number_of_slots = HASH_TABLE_INITIAL_SLOTS;
+    } else {
+        table->number_of_slots *= 2;
+    }
+
+    xfree(table->slots);
+    ALLOCATE_ZERO(table->slots, table->number_of_slots);
+    for (size_t i = 0; i < table->entries_length; i++) {
+        insert_slot(table, i);
+    }
+}
+
+/* Find the entry with @name of @length bytes. */
+struct hash_table_entry *find_hash_table_entry(const HashTable *table,
+        const char *name, size_t length)
+{
+    size_t mask, slot;
+    uint64_t hash;
+    struct hash_table_entry *entry;
+
+    if (table->entries_length == 0) {
+        return NULL;
+    }
+
+    hash = get_hash(name, length);
+    mask = table->number_of_slots - 1;
+    for (slot = hash & mask; table->slots[slot] != 0;
+            slot = (slot + 1) & mask) {
+        entry = &table->entries[table->slots[slot] - 1];
+        if (is_entry_named(entry, hash, name, length)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Add an entry with @name of @length bytes and @value. */
+struct hash_table_entry *add_hash_table_entry(HashTable *table,
+        const char *name, size_t length, void *value)
+{
+    struct hash_table_entry entry;
+
+    entry.hash = get_hash(name, length);
+    entry.name = xmalloc(length + 1);
+    memcpy(entry.name, name, length);
+    entry.name[length] = '\0';
+    entry.length = length;
+    entry.value = value;
+    LIST_APPEND_VALUE(table->entries, entry);
+
+    /* keep the fill rate of the slots below 3/4 */
+    if (table->entries_length * 4 > table->number_of_slots * 3) {
+        grow_slots(table);
+    } else {
+        insert_slot(table, table->entries_length - 1);
+    }
+    return &table->entries[table->entries_length - 1];
+}
+
+/* Remove @entry from the table. */
+void remove_hash_table_entry(HashTable *table,
+        struct hash_table_entry *entry)
+{
+    const size_t mask = table->number_of_slots - 1;
+    const size_t index = entry - table->entries;
+    const size_t last = table->entries_length - 1;
+    size_t slot, next, home;
+
+    /* empty the slot and shift following entries back that would otherwise
+     * not be found anymore
+     */
+    slot = get_entry_slot(table, index);
+    table->slots[slot] = 0;
+    for (next = (slot + 1) & mask; table->slots[next] != 0;
+            next = (next + 1) & mask) {
+        home = table->entries[table->slots[next] - 1].hash & mask;
+        /* move the entry if its home slot is not between the empty slot
+         * (exclusive) and its current slot (inclusive)
+         */
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            table->slots[slot] = table->slots[next];
+            table->slots[next] = 0;
+            slot = next;
+        }
+    }
+
+    xfree(entry->name);
+
+    /* fill the gap in the entries with the last entry */
+    if (index != last) {
+        table->slots[get_entry_slot(table, last)] = index + 1;
+        table->entries[index] = table->entries[last];
+    }
+    table->entries_length--;
+}
+
+/* Remove all entries from the table and free its memory. */
+void clear_hash_table(HashTable *table)
+{
+    for (size_t i = 0; i < table->entries_length; i++) {
+        xfree(table->entries[i].name);
+    }
+    LIST_CLEAR(table->entries);
+    xfree(table->slots);
+    table->slots = NULL;
+    table->number_of_slots = 0;
+}
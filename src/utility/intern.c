@@ -0,0 +1,76 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "utility/hash_table.h"
+#include "utility/intern.h"
+#include "utility/utility.h"
+
+/* the pool of interned strings mapping to their reference count */
+static HashTable intern_pool;
+
+/* Find the pool entry of the interned @string. */
+static struct hash_table_entry *find_interned_string(const char *string)
+{
+    struct hash_table_entry *entry;
+
+    entry = find_hash_table_entry(&intern_pool, string, strlen(string));
+    /* the string must be the interned one and not just an equal one */
+    if (entry == NULL || entry->name != string) {
+        return NULL;
+    }
+    return entry;
+}
+
+/* Get the interned version of @string of @length bytes. */
+const char *intern_string(const char *string, size_t length)
+{
+    struct hash_table_entry *entry;
+
+    entry = find_hash_table_entry(&intern_pool, string, length);
+    if (entry == NULL) {
+        entry = add_hash_table_entry(&intern_pool, string, length,
+                (void*) (uintptr_t) 1);
+    } else {
+        entry->value = (void*) ((uintptr_t) entry->value + 1);
+    }
+    return entry->name;
+}
+
+/* Add another reference to the interned @string. */
+const char *reference_string(const char *string)
+{
+    struct hash_table_entry *entry;
+
+    if (string == NULL) {
+        return NULL;
+    }
+
+    entry = find_interned_string(string);
+    ASSERT(entry != NULL, "the string is not interned");
+    entry->value = (void*) ((uintptr_t) entry->value + 1);
+    return string;
+}
+
+/* Release a reference to the interned @string. */
+void release_string(const char *string)
+{
+    struct hash_table_entry *entry;
+
+    if (string == NULL) {
+        return;
+    }
+
+    entry = find_interned_string(string);
+    ASSERT(entry != NULL, "the string is not interned");
+    if ((uintptr_t) entry->value <= 1) {
+        remove_hash_table_entry(&intern_pool, entry);
+    } else {
+        entry->value = (void*) ((uintptr_t) entry->value - 1);
+    }
+}
+
+/* Get the number of distinct strings in the pool. */
+size_t get_interned_string_count(void)
+{
+    return intern_pool.entries_length;
+}
@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "utility/pool.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+#ifdef __SANITIZE_ADDRESS__
+#include <sanitizer/asan_interface.h>
+/* Tell the address sanitizer that the object at @pointer of @size bytes is
+ * free so that accessing it is reported like with `xfree()`.
+ */
+#define POISON_OBJECT(pointer, size) ASAN_POISON_MEMORY_REGION(pointer, size)
+/* Tell the address sanitizer that the object at @pointer of @size bytes can be
+ * used again.
+ */
+#define UNPOISON_OBJECT(pointer, size) \
+    ASAN_UNPOISON_MEMORY_REGION(pointer, size)
+#else
+#define POISON_OBJECT(pointer, size) ((void) (pointer), (void) (size))
+#define UNPOISON_OBJECT(pointer, size) ((void) (pointer), (void) (size))
+#endif
+
+/* a slab of objects within a pool */
+struct pool_slab {
+    /* the previous slab */
+    struct pool_slab *previous;
+    /* the objects */
+    union maximum_alignment objects[];
+};
+
+/* Allocate a new slab for @pool and put its objects onto the free list. */
+static void add_pool_slab(ObjectPool *pool)
+{
+    const size_t size = ALIGN_SIZE(pool->object_size);
+    struct pool_slab *slab;
+    unsigned char *object;
+
+    slab = xmalloc(sizeof(*slab) + size * pool->objects_per_slab);
+    slab->previous = pool->slab;
+    pool->slab = slab;
+    pool->number_of_slabs++;
+
+    /* link the objects so that the first one is handed out first */
+    object = (unsigned char*) slab->objects + size * pool->objects_per_slab;
+    for (size_t i = 0; i < pool->objects_per_slab; i++) {
+        object -= size;
+        *(void**) object = pool->free_object;
+        pool->free_object = object;
+        POISON_OBJECT(object, size);
+    }
+}
+
+/* Get a zeroed object from @pool. */
+void *allocate_pool_object(ObjectPool *pool)
+{
+    const size_t size = ALIGN_SIZE(pool->object_size);
+    void *object;
+
+    if (pool->free_object == NULL) {
+        add_pool_slab(pool);
+    }
+
+    object = pool->free_object;
+    UNPOISON_OBJECT(object, size);
+    pool->free_object = *(void**) object;
+    memset(object, 0, pool->object_size);
+
+    pool->used_count++;
+    pool->peak_used_count = MAX(pool->peak_used_count, pool->used_count);
+    pool->allocation_count++;
+    return object;
+}
+
+/* Put @object back into @pool so it can be handed out again. */
+void free_pool_object(ObjectPool *pool, void *object)
+{
+    *(void**) object = pool->free_object;
+    pool->free_object = object;
+    POISON_OBJECT(object, ALIGN_SIZE(pool->object_size));
+    pool->used_count--;
+}
+
+/* Free all slabs of @pool. */
+void clear_object_pool(ObjectPool *pool)
+{
+    struct pool_slab *slab, *previous;
+
+    for (slab = pool->slab; slab != NULL; slab = previous) {
+        previous = slab->previous;
+        UNPOISON_OBJECT(slab->objects,
+                ALIGN_SIZE(pool->object_size) * pool->objects_per_slab);
+        xfree(slab);
+    }
+    pool->slab = NULL;
+    pool->number_of_slabs = 0;
+    pool->free_object = NULL;
+}
+
+/* Print the statistics of @pool as a single line into @file. */
+void print_object_pool(const ObjectPool *pool, FILE *file)
+{
+    fprintf(file, "%s %zu/%zu used, %zu peak, %zu allocations, %zu slabs\n",
+            pool->name, pool->used_count,
+            pool->number_of_slabs * pool->objects_per_slab,
+            pool->peak_used_count, pool->allocation_count,
+            pool->number_of_slabs);
+}
@@ -1,3 +1,8 @@
+/* needed for `kill()` */
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h> /* fcntl() */
+#include <signal.h> /* kill(), SIGKILL */
 #include <stdlib.h> /* malloc() */
 #include <string.h> /* memchr(), memcpy() */
 #include <sys/wait.h> /* waitpid() */
@@ -111,3 +116,53 @@ char *run_shell_and_get_output(const char *command)
     output[count] = '\0';
     return output;
 }
+
+/* Run @command within a shell and get a file descriptor to read its output. */
+int run_shell_with_output(const char *command, pid_t *process_id)
+{
+    int pipe_descriptors[2];
+
+    if (pipe(pipe_descriptors) < 0) {
+        return -1;
+    }
+
+    *process_id = fork();
+    switch (*process_id) {
+    /* fork failed */
+    case -1:
+        close(pipe_descriptors[0]);
+        close(pipe_descriptors[1]);
+        return -1;
+
+    /* child process */
+    case 0:
+        /* make a new process group so that all processes the shell starts can
+         * be stopped together
+         */
+        (void) setsid();
+        close(pipe_descriptors[0]);
+        if (pipe_descriptors[1] != STDOUT_FILENO) {
+            dup2(pipe_descriptors[1], STDOUT_FILENO);
+            close(pipe_descriptors[1]);
+        }
+        (void) execl("/bin/sh", "sh", "-c", command, (char*) NULL);
+        _exit(EXIT_FAILURE);
+        break;
+    }
+
+    /* parent process */
+    close(pipe_descriptors[1]);
+
+    /* the output is read whenever it is available, never wait for it */
+    (void) fcntl(pipe_descriptors[0], F_SETFL, O_NONBLOCK);
+    (void) fcntl(pipe_descriptors[0], F_SETFD, FD_CLOEXEC);
+    return pipe_descriptors[0];
+}
+
+/* Stop a shell started by `run_shell_with_output()`. */
+void stop_shell(pid_t process_id)
+{
+    /* killing the process group also stops the processes the shell started */
+    (void) kill(-process_id, SIGKILL);
+    (void) waitpid(process_id, NULL, 0);
+}
@@ -0,0 +1,119 @@
+#include <string.h>
+
+#include "utility/search.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+/* Get the bit corresponding to the trigram at the start of @string. */
+static inline uint64_t get_trigram_bit(const utf8_t *string)
+{
+    const unsigned char *const bytes = (const unsigned char*) string;
+
+    return (uint64_t) 1 << ((bytes[0] * 31 * 31 + bytes[1] * 31 + bytes[2]) %
+            64);
+}
+
+/* Set @key to the lower case concatenation of given @strings. */
+void set_search_key(SearchKey *key, const char *const *strings,
+        unsigned number_of_strings)
+{
+    size_t length = 0, index = 0;
+
+    for (unsigned i = 0; i < number_of_strings; i++) {
+        if (strings[i] != NULL) {
+            length += strlen(strings[i]) + 1;
+        }
+    }
+
+    xfree(key->string);
+    ALLOCATE(key->string, length + 1);
+    key->trigrams = 0;
+
+    for (unsigned i = 0; i < number_of_strings; i++) {
+        if (strings[i] == NULL) {
+            continue;
+        }
+
+        for (const char *string = strings[i]; string[0] != '\0'; string++) {
+            key->string[index] = get_search_character(string[0]);
+            if (index >= 2) {
+                key->trigrams |= get_trigram_bit(&key->string[index - 2]);
+            }
+            index++;
+        }
+        key->string[index++] = '\n';
+    }
+    key->string[index] = '\0';
+}
+
+/* Free the resources occupied by @key. */
+void clear_search_key(SearchKey *key)
+{
+    xfree(key->string);
+    key->string = NULL;
+    key->trigrams = 0;
+}
+
+/* Convert @character to the form it is compared with. */
+utf8_t get_search_character(utf8_t character)
+{
+    /* only ascii is made lower case */
+    if (character >= 'A' && character <= 'Z') {
+        character += 'a' - 'A';
+    }
+    return character;
+}
+
+/* Get the bit set of all trigrams within the first @length bytes. */
+uint64_t get_search_trigrams(const utf8_t *search, size_t length)
+{
+    uint64_t trigrams = 0;
+
+    for (size_t i = 2; i < length; i++) {
+        if (search[i - 2] != ' ' && search[i - 1] != ' ' && search[i] != ' ') {
+            trigrams |= get_trigram_bit(&search[i - 2]);
+        }
+    }
+    return trigrams;
+}
+
+/* Check if @word with given @length is contained in @string. */
+static bool contains_word(const utf8_t *string, const utf8_t *word,
+        size_t length)
+{
+    for (; (string = strchr(string, word[0])) != NULL; string++) {
+        if (strncmp(string, word, length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Check if @key matches the first @length bytes of @search. */
+bool does_search_match(const SearchKey *key, const utf8_t *search,
+        size_t length, uint64_t trigrams)
+{
+    size_t word_length;
+
+    if ((key->trigrams & trigrams) != trigrams) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i += word_length) {
+        word_length = 0;
+        while (i + word_length < length && search[i + word_length] != ' ') {
+            word_length++;
+        }
+
+        if (word_length == 0) {
+            word_length = 1;
+            continue;
+        }
+
+        if (key->string == NULL ||
+                !contains_word(key->string, &search[i], word_length)) {
+            return false;
+        }
+    }
+    return true;
+}
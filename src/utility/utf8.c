@@ -0,0 +1,141 @@
+#include <string.h>
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#elif defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
+#include "utility/utf8.h"
+
+/* Widen the ascii bytes at @bytes into @codepoints as long as they are ascii.
+ *
+ * @return the number of bytes that were ascii.
+ */
+static inline size_t decode_ascii_run(const unsigned char *bytes,
+        size_t length, uint32_t *codepoints)
+{
+    size_t index = 0;
+
+#if defined(__AVX2__)
+    for (; index + 32 <= length; index += 32) {
+        const __m256i block =
+            _mm256_loadu_si256((const __m256i*) &bytes[index]);
+        if (_mm256_movemask_epi8(block) != 0) {
+            break;
+        }
+        for (size_t i = 0; i < 32; i += 8) {
+            const __m128i eight =
+                _mm_loadl_epi64((const __m128i*) &bytes[index + i]);
+            _mm256_storeu_si256((__m256i*) &codepoints[index + i],
+                    _mm256_cvtepu8_epi32(eight));
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; index + 16 <= length; index += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*) &bytes[index]);
+        if (_mm_movemask_epi8(block) != 0) {
+            break;
+        }
+        const __m128i low = _mm_unpacklo_epi8(block, zero);
+        const __m128i high = _mm_unpackhi_epi8(block, zero);
+        _mm_storeu_si128((__m128i*) &codepoints[index],
+                _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128((__m128i*) &codepoints[index + 4],
+                _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128((__m128i*) &codepoints[index + 8],
+                _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128((__m128i*) &codepoints[index + 12],
+                _mm_unpackhi_epi16(high, zero));
+    }
+#endif
+
+    /* check the rest 8 bytes at a time */
+    for (; index + 8 <= length; index += 8) {
+        uint64_t block;
+
+        memcpy(&block, &bytes[index], sizeof(block));
+        if ((block & UINT64_C(0x8080808080808080)) != 0) {
+            break;
+        }
+        for (size_t i = 0; i < 8; i++) {
+            codepoints[index + i] = bytes[index + i];
+        }
+    }
+
+    /* the ascii bytes before the first non ascii byte */
+    for (; index < length && bytes[index] < 0x80; index++) {
+        codepoints[index] = bytes[index];
+    }
+    return index;
+}
+
+/* Decode the multi byte sequence at the start of @bytes.
+ *
+ * @return the number of bytes consumed, at least 1.
+ */
+static inline size_t decode_sequence(const unsigned char *bytes, size_t length,
+        uint32_t *codepoint)
+{
+    const unsigned char first = bytes[0];
+    size_t count;
+    uint32_t value, minimum;
+
+    if (first >= 0xc2 && first <= 0xdf) {
+        count = 2;
+        value = first & 0x1f;
+        minimum = 0x80;
+    } else if (first >= 0xe0 && first <= 0xef) {
+        count = 3;
+        value = first & 0x0f;
+        minimum = 0x800;
+    } else if (first >= 0xf0 && first <= 0xf4) {
+        count = 4;
+        value = first & 0x07;
+        minimum = 0x10000;
+    } else {
+        /* stray continuation byte or a byte never used in UTF-8 */
+        *codepoint = UTF8_REPLACEMENT_CHARACTER;
+        return 1;
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        if (i >= length || (bytes[i] & 0xc0) != 0x80) {
+            /* truncated sequence, continue at the unexpected byte */
+            *codepoint = UTF8_REPLACEMENT_CHARACTER;
+            return i;
+        }
+        value = (value << 6) | (bytes[i] & 0x3f);
+    }
+
+    if (value < minimum || value > 0x10ffff ||
+            (value >= 0xd800 && value <= 0xdfff)) {
+        value = UTF8_REPLACEMENT_CHARACTER;
+    }
+    *codepoint = value;
+    return count;
+}
+
+/* Decode the UTF-8 string @utf8 of @length bytes into @codepoints. */
+size_t decode_utf8(const utf8_t *utf8, size_t length, uint32_t *codepoints)
+{
+    const unsigned char *const bytes = (const unsigned char*) utf8;
+    size_t index = 0, count = 0;
+
+    while (index < length) {
+        const size_t ascii_count = decode_ascii_run(&bytes[index],
+                length - index, &codepoints[count]);
+        index += ascii_count;
+        count += ascii_count;
+        if (index == length) {
+            break;
+        }
+
+        index += decode_sequence(&bytes[index], length - index,
+                &codepoints[count]);
+        count++;
+    }
+    return count;
+}
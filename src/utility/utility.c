@@ -1,4 +1,5 @@
 #include <ctype.h> /* tolower() */
+#include <stdint.h> /* uint64_t */
 #include <string.h> /* memchr(), memcpy() */
 
 /* Check if a character is a line ending character. */
@@ -34,3 +35,16 @@ int strcasecmp(const char *string1, const char *string2)
     }
     return result;
 }
+
+/* Get a 64 bit FNV-1a hash of @size bytes at @data. */
+uint64_t get_hash(const void *data, size_t size)
+{
+    const unsigned char *const bytes = data;
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
@@ -1,15 +1,201 @@
 #include <errno.h> /* errno */
 #include <stdarg.h> /* va_list, va_start(), va_end() */
-#include <stdint.h> /* SIZE_MAX */
+#include <stdint.h> /* SIZE_MAX, uintptr_t */
 #include <string.h> /* strerror() */
 
-#include "utility/utility.h" /* ASSERT(), UNLIKELY() */
+#include "utility/utility.h" /* ASSERT(), UNLIKELY(), SIZE() */
+
+/* Multiply @number_of_elements by @size and abort if the product overflows. */
+static size_t multiply_sizes(size_t number_of_elements, size_t size)
+{
+    size_t byte_count;
+
+#if __has_builtin(__builtin_mul_overflow)
+    ASSERT(!__builtin_mul_overflow(number_of_elements, size, &byte_count),
+            "unsigned integer overflow");
+#else
+    if (number_of_elements == 0 || size == 0) {
+        byte_count = 0;
+    } else {
+        ASSERT(SIZE_MAX / number_of_elements >= size,
+                "unsigned integer overflow");
+        byte_count = number_of_elements * size;
+    }
+#endif
+    return byte_count;
+}
+
+#ifdef ALLOCATION_ACCOUNTING
+
+/* the header in front of each allocation */
+union allocation_header {
+    struct {
+        /* the site the allocation is counted for */
+        struct allocation_site *site;
+        /* the number of requested bytes */
+        size_t size;
+    } block;
+    /* keep the memory after the header aligned for any type */
+    long double long_double_alignment;
+    long long long_long_alignment;
+    void *pointer_alignment;
+};
+
+/* the allocations of each source file */
+static struct {
+    /* the sites hashed by the address of their file name, the last site counts
+     * all files that do not fit
+     */
+    struct allocation_site sites[MAX_ALLOCATION_SITES + 1];
+    /* the number of used sites */
+    size_t number_of_sites;
+    /* the number of allocations of all sites */
+    size_t allocation_count;
+} allocation_statistics = {
+    .sites[MAX_ALLOCATION_SITES].file = "other",
+};
+
+/* Get the site allocations within @file are counted for. */
+static struct allocation_site *get_allocation_site(const char *file)
+{
+    const size_t mask = MAX_ALLOCATION_SITES - 1;
+    struct allocation_site *site;
+    size_t slot;
+
+    /* `__FILE__` is the same string literal within a source file, so
+     * comparing the address is enough
+     */
+    slot = ((uintptr_t) file >> 4) & mask;
+    site = &allocation_statistics.sites[slot];
+    while (site->file != file && site->file != NULL) {
+        slot = (slot + 1) & mask;
+        site = &allocation_statistics.sites[slot];
+    }
+
+    if (site->file == NULL) {
+        /* keep slots free so the search above ends */
+        if (allocation_statistics.number_of_sites >=
+                MAX_ALLOCATION_SITES * 3 / 4) {
+            site = &allocation_statistics.sites[MAX_ALLOCATION_SITES];
+        } else {
+            site->file = file;
+            allocation_statistics.number_of_sites++;
+        }
+    }
+    return site;
+}
+
+/* Count @header as allocation within @file and get the memory after it. */
+static void *count_allocation(const char *file,
+        union allocation_header *header, size_t size)
+{
+    struct allocation_site *site;
+
+    site = get_allocation_site(file);
+    site->allocation_count++;
+    site->live_bytes += size;
+    site->peak_bytes = MAX(site->peak_bytes, site->live_bytes);
+    allocation_statistics.allocation_count++;
+
+    header->block.site = site;
+    header->block.size = size;
+    return &header[1];
+}
+
+/* Get the size of an allocation including its header. */
+static size_t get_block_size(size_t size)
+{
+    ASSERT(size <= SIZE_MAX - sizeof(union allocation_header),
+            "unsigned integer overflow");
+    return sizeof(union allocation_header) + size;
+}
+
+/* Get the allocation statistics of all source files. */
+const struct allocation_site *get_allocation_sites(size_t *number_of_sites)
+{
+    *number_of_sites = SIZE(allocation_statistics.sites);
+    return allocation_statistics.sites;
+}
+
+/* Get the number of allocations made so far by all source files. */
+size_t get_allocation_count(void)
+{
+    return allocation_statistics.allocation_count;
+}
+
+/* Free memory allocated by any of the xalloc functions. */
+void xfree(void *pointer)
+{
+    union allocation_header *header;
+
+    if (pointer == NULL) {
+        return;
+    }
+    header = &((union allocation_header*) pointer)[-1];
+    header->block.site->live_bytes -= header->block.size;
+    free(header);
+}
+
+/* Allocate a minimum of @size bytes of memory. */
+void *_xmalloc(const char *file, size_t size)
+{
+    union allocation_header *header;
+
+    if (UNLIKELY(size == 0)) {
+        return NULL;
+    }
+    header = malloc(get_block_size(size));
+    ASSERT(header != NULL, strerror(errno));
+    return count_allocation(file, header, size);
+}
+
+/* Allocate @number_of_elements number of elements with each element being
+ * @size_per_element large.
+ */
+void *_xcalloc(const char *file, size_t number_of_elements,
+        size_t size_per_element)
+{
+    union allocation_header *header;
+    size_t size;
+
+    size = multiply_sizes(number_of_elements, size_per_element);
+    if (UNLIKELY(size == 0)) {
+        return NULL;
+    }
+    header = calloc(1, get_block_size(size));
+    ASSERT(header != NULL, strerror(errno));
+    return count_allocation(file, header, size);
+}
+
+/* Grow or shrink a previously allocated memory region. */
+void *_xrealloc(const char *file, void *pointer, size_t size)
+{
+    union allocation_header *header;
+
+    if (size == 0) {
+        xfree(pointer);
+        return NULL;
+    }
+    if (pointer == NULL) {
+        return _xmalloc(file, size);
+    }
+
+    header = &((union allocation_header*) pointer)[-1];
+    /* take the old size off, the new size is counted for @file */
+    header->block.site->live_bytes -= header->block.size;
+    header = realloc(header, get_block_size(size));
+    ASSERT(header != NULL, strerror(errno));
+    return count_allocation(file, header, size);
+}
+
+#else
 
 /* Allocate a minimum of @size bytes of memory. */
-void *xmalloc(size_t size)
+void *_xmalloc(const char *file, size_t size)
 {
     void *pointer;
 
+    (void) file;
     if (UNLIKELY(size == 0)) {
         pointer = NULL;
     } else {
@@ -22,10 +208,12 @@ void *xmalloc(size_t size)
 /* Allocate @number_of_elements number of elements with each element being
  * @size_per_element large.
  */
-void *xcalloc(size_t number_of_elements, size_t size_per_element)
+void *_xcalloc(const char *file, size_t number_of_elements,
+        size_t size_per_element)
 {
     void *pointer;
 
+    (void) file;
     if (UNLIKELY(number_of_elements == 0 || size_per_element == 0)) {
         pointer = NULL;
     } else {
@@ -36,8 +224,9 @@ void *xcalloc(size_t number_of_elements, size_t size_per_element)
 }
 
 /* Grow or shrink a previously allocated memory region. */
-void *xrealloc(void *pointer, size_t size)
+void *_xrealloc(const char *file, void *pointer, size_t size)
 {
+    (void) file;
     if (size == 0) {
         free(pointer);
         pointer = NULL;
@@ -48,45 +237,31 @@ void *xrealloc(void *pointer, size_t size)
     return pointer;
 }
 
+#endif
+
 /* Same as `xrealloc()` but instead of using bytes as argument, use
  * @number_of_elements * @size_per_element.
  */
-void *xreallocarray(void *pointer, size_t number_of_elements, size_t size)
+void *_xreallocarray(const char *file, void *pointer,
+        size_t number_of_elements, size_t size)
 {
-    size_t byte_count;
-
-#if __has_builtin(__builtin_mul_overflow)
-    ASSERT(!__builtin_mul_overflow(number_of_elements, size, &byte_count),
-            "unsigned integer overflow");
-#else
-    if (number_of_elements == 0 || size == 0) {
-        byte_count = 0;
-    } else {
-        ASSERT(SIZE_MAX / number_of_elements >= size,
-                "unsigned integer overflow");
-        byte_count = number_of_elements * size;
-    }
-#endif
-    return xrealloc(pointer, byte_count);
+    return _xrealloc(file, pointer, multiply_sizes(number_of_elements, size));
 }
 
 /* Combination of `xmalloc()` and `memcpy()`. */
-void *xmemdup(const void *pointer, size_t size)
+void *_xmemdup(const char *file, const void *pointer, size_t size)
 {
     char *duplicate;
 
-    if (size == 0) {
-        duplicate = NULL;
-    } else {
-        duplicate = malloc(size);
-        ASSERT(duplicate != NULL, strerror(errno));
+    duplicate = _xmalloc(file, size);
+    if (duplicate != NULL) {
         (void) memcpy(duplicate, pointer, size);
     }
     return duplicate;
 }
 
 /* Duplicates the null-terminated @string pointer by creating a copy. */
-char *xstrdup(const char *string)
+char *_xstrdup(const char *file, const char *string)
 {
     size_t length;
     char *result;
@@ -96,7 +271,7 @@ char *xstrdup(const char *string)
     } else {
         /* +1 for the null terminator */
         length = strlen(string) + 1;
-        result = xmalloc(length);
+        result = _xmalloc(file, length);
         (void) memcpy(result, string, length);
     }
     return result;
@@ -105,19 +280,19 @@ char *xstrdup(const char *string)
 /* Like `xstrdup()` but stop at @length when the null-terminator is not yet
  * encountered.
  */
-char *xstrndup(const char *string, size_t length)
+char *_xstrndup(const char *file, const char *string, size_t length)
 {
     char *result;
 
     length = strnlen(string, length);
     /* +1 for the null terminator */
-    result = xmalloc(length + 1);
+    result = _xmalloc(file, length + 1);
     result[length] = '\0';
     return memcpy(result, string, length);
 }
 
 /* Combination of `xmalloc()` and `sprintf()`. */
-char *xasprintf(const char *format, ...)
+char *_xasprintf(const char *file, const char *format, ...)
 {
     va_list list;
     int total_size;
@@ -132,7 +307,7 @@ char *xasprintf(const char *format, ...)
 
     va_start(list, format);
     /* +1 for the null terminator */
-    result = xmalloc((size_t) total_size + 1);
+    result = _xmalloc(file, (size_t) total_size + 1);
     (void) vsprintf(result, format, list);
     va_end(list);
 
@@ -6,13 +6,15 @@
 
 #include "relation.h"
 #include "binding.h"
+#include "chooser.h"
 #include "event.h"
 #include "frame.h"
 #include "log.h"
 #include "monitor.h"
 #include "parse/parse.h"
+#include "statistics.h"
+#include "utility/intern.h"
 #include "window.h"
-#include "window_list.h"
 #include "x11/display.h"
 
 /* the number of all windows within the linked list */
@@ -42,6 +44,9 @@ FcWindow *Window_pressed;
 /* the selected window used for actions */
 FcWindow *Window_selected;
 
+/* the pool all windows are allocated from */
+ObjectPool Window_pool = OBJECT_POOL(FcWindow, 32);
+
 /*********************
  * Window properties *
  *********************/
@@ -130,22 +135,65 @@ void remove_window_states(FcWindow *window, Atom *states,
             (unsigned char*) window->properties.states, effective_count);
 }
 
+/* Update the search key of @window after its name or class changed. */
+static void update_window_search_key(FcWindow *window)
+{
+    const char *strings[3];
+
+    strings[0] = window->properties.name;
+    strings[1] = window->properties.instance;
+    strings[2] = window->properties.class;
+    set_search_key(&window->search, strings, SIZE(strings));
+}
+
+/* Get the interned version of @string which may be NULL. */
+static const utf8_t *intern_class_string(const char *string)
+{
+    if (string == NULL) {
+        return NULL;
+    }
+    return intern_string(string, strlen(string));
+}
+
+/* Update the instance and class of @window. */
+static void update_window_class(FcWindow *window)
+{
+    XClassHint class = { NULL, NULL };
+    const utf8_t *instance_string, *class_string;
+
+    count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
+    XGetClassHint(display, window->reference.id, &class);
+    instance_string = intern_class_string(class.res_name);
+    class_string = intern_class_string(class.res_class);
+    XFree(class.res_name);
+    XFree(class.res_class);
+
+    release_string(window->properties.instance);
+    release_string(window->properties.class);
+    /* interned strings are equal exactly when their pointers are */
+    if (instance_string == window->properties.instance &&
+            class_string == window->properties.class) {
+        return;
+    }
+    window->properties.instance = instance_string;
+    window->properties.class = class_string;
+    update_window_search_key(window);
+}
+
 /* Update the property within @window corresponding to given atom. */
 bool cache_window_property(FcWindow *window, Atom atom)
 {
     if (atom == XA_WM_NAME || atom == ATOM(_NET_WM_NAME)) {
-        free(window->properties.name);
+        xfree(window->properties.name);
         window->properties.name =
             get_window_name_property(window->reference.id);
+        update_window_search_key(window);
     } else if (atom == XA_WM_CLASS) {
-        XFree(window->properties.class.res_name);
-        XFree(window->properties.class.res_class);
-        window->properties.class.res_name = NULL;
-        window->properties.class.res_class = NULL;
-        XGetClassHint(display, window->reference.id, &window->properties.class);
+        update_window_class(window);
     } else if (atom == XA_WM_NORMAL_HINTS) {
         long supplied;
 
+        count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
         XGetWMNormalHints(display, window->reference.id,
                 &window->properties.size_hints, &supplied);
         /* clip the window to new potential size hints */
@@ -154,6 +202,7 @@ bool cache_window_property(FcWindow *window, Atom atom)
     } else if (atom == XA_WM_HINTS) {
         XWMHints *wm_hints;
 
+        count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
         wm_hints = XGetWMHints(display, window->reference.id);
         if (wm_hints == NULL) {
             window->properties.hints.flags = 0;
@@ -165,10 +214,11 @@ bool cache_window_property(FcWindow *window, Atom atom)
             atom == ATOM(_NET_WM_STRUT_PARTIAL)) {
         get_strut_property(window->reference.id, &window->properties.strut);
     } else if (atom == XA_WM_TRANSIENT_FOR) {
+        count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
         XGetTransientForHint(display, window->reference.id,
                 &window->properties.transient_for);
     } else if (atom == ATOM(WM_PROTOCOLS)) {
-        free(window->properties.protocols);
+        xfree(window->properties.protocols);
         window->properties.protocols =
             get_protocols_property(window->reference.id);
     } else if (atom == ATOM(_NET_WM_FULLSCREEN_MONITORS)) {
@@ -252,7 +302,7 @@ static void initialize_window_properties(FcWindow *window)
 
     window->properties.states = states;
 
-    free(types);
+    xfree(types);
 
     XFree(atoms);
 
@@ -276,7 +326,7 @@ inline void dereference_window(FcWindow *window)
 {
     window->reference_count--;
     if (window->reference_count == 0) {
-        free(window);
+        free_pool_object(&Window_pool, window);
     }
 }
 
@@ -350,6 +400,7 @@ FcWindow *create_window(Window id)
     FcWindow *previous;
     XWindowChanges changes;
 
+    count_round_trip(ROUND_TRIP_GET_WINDOW_ATTRIBUTES);
     if (XGetWindowAttributes(display, id, &attributes) == 0) {
         /* the window got invalid because it was abruptly destroyed */
         LOG_DEBUG("window %#lx abruptly disappeared\n",
@@ -374,7 +425,7 @@ FcWindow *create_window(Window id)
             (void) parse_and_run_actions(parser);
             destroy_parser(parser);
 
-            free(command);
+            xfree(command);
 
             /* signal to the window that we executed its command and it can go
              * now
@@ -391,10 +442,11 @@ FcWindow *create_window(Window id)
     XChangeWindowAttributes(display, id, CWBorderPixel | CWEventMask,
             &set_attributes);
 
+    count_round_trip(ROUND_TRIP_GET_GEOMETRY);
     XGetGeometry(display, id, &root, &x, &y, &width, &height, &border_width,
             &depth);
 
-    ALLOCATE_ZERO(window, 1);
+    window = allocate_pool_object(&Window_pool);
 
     window->reference_count = 1;
     window->reference.id = id;
@@ -454,10 +506,10 @@ FcWindow *create_window(Window id)
         Window_server_top->server_above = window;
         Window_server_top = window;
 
-        /* if the window list is open, put it below it */
-        if (WindowList.reference.is_mapped) {
+        /* if the chooser is open, put it below it */
+        if (Chooser.reference.is_mapped) {
             changes.stack_mode = Below;
-            changes.sibling = WindowList.reference.id;
+            changes.sibling = Chooser.reference.id;
             XConfigureWindow(display, id, CWStackMode | CWSibling, &changes);
         }
 
@@ -550,11 +602,12 @@ void destroy_window(FcWindow *window)
 
     /* setting the id to None marks the window as destroyed */
     window->reference.id = None;
-    free(window->properties.name);
-    XFree(window->properties.class.res_name);
-    XFree(window->properties.class.res_class);
-    free(window->properties.protocols);
-    free(window->properties.states);
+    xfree(window->properties.name);
+    release_string(window->properties.instance);
+    release_string(window->properties.class);
+    xfree(window->properties.protocols);
+    xfree(window->properties.states);
+    clear_search_key(&window->search);
 
     dereference_window(window);
 }
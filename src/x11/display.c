@@ -3,7 +3,9 @@
 #include <X11/Xproto.h>
 
 #include "fensterchef.h"
+#include "flight_recorder.h"
 #include "log.h"
+#include "statistics.h"
 #include "window.h"
 #include "x11/ewmh.h"
 
@@ -104,6 +106,16 @@ static int x_error_handler(Display *display, XErrorEvent *error)
     return 0;
 }
 
+/* Write a crash report when the connection to the X server is lost, Xlib exits
+ * after this returns.  No requests may be made here, the display is dead.
+ */
+static int x_io_error_handler(Display *display)
+{
+    (void) display;
+    write_crash_report("lost the connection to the X server");
+    return 0;
+}
+
 /* Try to take control of the window manager role. */
 void take_control(void)
 {
@@ -129,10 +141,12 @@ void take_control(void)
             &attributes);
 
     /* wait until we get a reply to our request, it must succeed */
+    count_round_trip(ROUND_TRIP_SYNC);
     XSync(display, False);
 
     /* set an error handler so that further errors do not abort fensterchef */
     XSetErrorHandler(x_error_handler);
+    XSetIOErrorHandler(x_io_error_handler);
 
     /* intern all atoms into the X server so we receive special identifiers */
     XInternAtoms(display, (char**) x_atom_names, ATOM_MAX, False, x_atom_ids);
@@ -155,6 +169,7 @@ void query_existing_windows(void)
 
     /* get a list of child windows of the root in bottom-to-top stacking order
      */
+    count_round_trip(ROUND_TRIP_QUERY_TREE);
     XQueryTree(display, DefaultRootWindow(display), &root, &parent, &children,
             &number_of_children);
 
@@ -2,6 +2,7 @@
 
 #include "fensterchef.h"
 #include "log.h"
+#include "statistics.h"
 #include "x11/display.h"
 #include "x11/ewmh.h"
 
@@ -39,6 +40,7 @@ long *get_long_property(Window window, Atom property,
     unsigned long bytes_after;
     unsigned char *property_result;
 
+    count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
     XGetWindowProperty(display, window, property, 0, expected_item_count, False,
             AnyPropertyType, &type, &format, &item_count, &bytes_after,
             &property_result);
@@ -62,6 +64,7 @@ char *get_text_property(Window window, Atom property,
     unsigned long bytes_after;
     unsigned char *property_result;
 
+    count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
     XGetWindowProperty(display, window, property, 0, 1024, False,
             AnyPropertyType, &type, &format, length,
             &bytes_after, &property_result);
@@ -90,6 +93,7 @@ Atom *get_atom_list_property(Window window, Atom property)
     Atom *atoms;
 
     /* get up to 32 atoms from this property */
+    count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
     XGetWindowProperty(display, window, property, 0, 32, False,
             XA_ATOM, &type, &format, &count,
             &bytes_after, &raw_property);
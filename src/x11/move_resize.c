@@ -1,6 +1,7 @@
 #include "cursor.h"
 #include "frame.h"
 #include "log.h"
+#include "statistics.h"
 #include "window.h"
 #include "x11/display.h"
 
@@ -47,6 +48,7 @@ bool initiate_window_move_resize(FcWindow *window,
         int window_y;
         unsigned int mask;
 
+        count_round_trip(ROUND_TRIP_QUERY_POINTER);
         XQueryPointer(display, root, &other_root, &child,
                 &start_x, &start_y, /* root_x, root_y */
                 &window_x, &window_y, &mask);
@@ -1,11 +1,12 @@
 #include <X11/Xatom.h>
 
 #include "binding.h"
+#include "chooser.h"
 #include "cursor.h"
 #include "frame.h"
 #include "log.h"
+#include "trace.h"
 #include "window.h"
-#include "window_list.h"
 #include "x11/display.h"
 
 /* Synchronize the window stacking order with the server. */
@@ -175,6 +176,8 @@ void synchronize_with_server(void)
     Atom atoms[2];
     FcWindow *window;
 
+    begin_trace_span("synchronize", "synchronize with server");
+
     cursor = load_cursor(CURSOR_ROOT, NULL);
     if (cursor != root_cursor) {
         XDefineCursor(display, DefaultRootWindow(display), cursor);
@@ -184,7 +187,9 @@ void synchronize_with_server(void)
     /* since the strut of a monitor might have changed because a window with
      * strut got hidden or shown, we need to recompute those
      */
+    begin_trace_span("synchronize", "reconfigure monitors");
     reconfigure_monitor_frames();
+    end_trace_span();
 
     /* update the focused state of all windows */
     for (window = Window_first; window != NULL; window = window->next) {
@@ -195,11 +200,16 @@ void synchronize_with_server(void)
         }
     }
 
+    begin_trace_span("synchronize", "stacking order");
     synchronize_window_stacking_order();
+    end_trace_span();
 
+    begin_trace_span("synchronize", "client list");
     synchronize_client_list();
+    end_trace_span();
 
     /* configure all visible windows and map them */
+    begin_trace_span("synchronize", "configure windows");
     for (window = Window_top; window != NULL; window = window->below) {
         uint32_t new_border_color;
         unsigned new_border_size;
@@ -257,8 +267,10 @@ void synchronize_with_server(void)
 
         map_client(&window->reference);
     }
+    end_trace_span();
 
     /* unmap all invisible windows */
+    begin_trace_span("synchronize", "unmap windows");
     for (FcWindow *window = Window_bottom;
             window != NULL;
             window = window->above) {
@@ -284,13 +296,16 @@ void synchronize_with_server(void)
 
         unmap_client(&window->reference);
     }
+    end_trace_span();
 
-    /* if the window list is open, let it keep the focus */
-    if (!WindowList.reference.is_mapped &&
+    /* if the chooser is open, let it keep the focus */
+    if (!Chooser.reference.is_mapped &&
             Window_server_focus != Window_focus) {
         set_input_focus(Window_focus);
         Window_server_focus = Window_focus;
     }
+
+    end_trace_span();
 }
 
 /**********************
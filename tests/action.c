@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/action.h"
+#include "core/configuration.h"
+#include "core/statistics.h"
+#include "parse/group.h"
+#include "parse/parse.h"
+#include "test.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+/* Parse @string and set @actions to the result.
+ *
+ * @return ERROR if the string does not parse.
+ */
+static int parse_string(const char *string, ActionBlock **actions)
+{
+    Parser *parser;
+
+    parser = create_string_parser(string);
+    *actions = parse_actions(parser);
+    destroy_parser(parser);
+    return *actions == NULL ? ERROR : OK;
+}
+
+/* Get how often the call action ran according to the statistics. */
+static size_t get_call_count(void)
+{
+    static char content[16 * 1024];
+    FILE *file;
+    size_t length;
+    const char *line;
+    size_t count = 0;
+
+    file = tmpfile();
+    if (file == NULL) {
+        return 0;
+    }
+    write_statistics(file);
+    rewind(file);
+    length = fread(content, 1, sizeof(content) - 1, file);
+    content[length] = '\0';
+    fclose(file);
+
+    line = strstr(content, "\ncall S: ");
+    if (line != NULL) {
+        (void) sscanf(line, "\ncall S: %zu", &count);
+    }
+    return count;
+}
+
+int run_called_groups(void)
+{
+    ActionBlock *actions, *redefinition;
+    int result = 0;
+
+    if (parse_string(
+                "group inner ( border size 7 )\n"
+                "group outer ( call inner\n text padding 3 )\n"
+                "call outer\n",
+                &actions) != OK) {
+        LOG_ERROR("the groups do not parse\n");
+        return 1;
+    }
+
+    run_action_block(actions);
+    if (configuration.border_size != 7 || configuration.text_padding != 3) {
+        LOG_ERROR("the called groups did not run\n");
+        result = 1;
+    }
+
+    /* the compiled block must notice that the group changed */
+    if (result == 0 &&
+            parse_string("group inner ( border size 9 )", &redefinition) ==
+                OK) {
+        dereference_action_block(redefinition);
+        run_action_block(actions);
+        if (configuration.border_size != 9) {
+            LOG_ERROR("the old group ran after it was redefined\n");
+            result = 1;
+        }
+    }
+
+    dereference_action_block(actions);
+    clear_all_groups();
+    return result;
+}
+
+int run_large_and_recursive_groups(void)
+{
+    ActionBlock *actions;
+    char *string, *next;
+    int result = 0;
+
+    /* a group too large to be inlined */
+    string = xstrdup("group large (");
+    for (int i = 0; i < MAX_INLINED_INSTRUCTIONS * 2; i++) {
+        next = xasprintf("%s\n text padding %d", string, i);
+        xfree(string);
+        string = next;
+    }
+    next = xasprintf("%s )\ngroup loop ( call loop )\n"
+            "call large\ncall loop\n", string);
+    xfree(string);
+    string = next;
+
+    if (parse_string(string, &actions) != OK) {
+        LOG_ERROR("the groups do not parse\n");
+        xfree(string);
+        return 1;
+    }
+    xfree(string);
+
+    /* the recursive call must stop at the call depth limit */
+    run_action_block(actions);
+    if (configuration.text_padding != MAX_INLINED_INSTRUCTIONS * 2 - 1) {
+        LOG_ERROR("the large group did not run\n");
+        result = 1;
+    }
+
+    dereference_action_block(actions);
+    clear_all_groups();
+    return result;
+}
+
+int count_inlined_calls(void)
+{
+    ActionBlock *actions;
+    size_t call_count;
+    int result = 0;
+
+    if (parse_string(
+                "group inner ( border size 7 )\n"
+                "group outer ( call inner\n text padding 3 )\n"
+                "call outer\n",
+                &actions) != OK) {
+        LOG_ERROR("the groups do not parse\n");
+        return 1;
+    }
+
+    /* both calls are inlined but must still be counted */
+    call_count = get_call_count();
+    run_action_block(actions);
+    if (get_call_count() != call_count + 2) {
+        LOG_ERROR("expected 2 more calls but got %zu\n",
+                get_call_count() - call_count);
+        result = 1;
+    }
+
+    dereference_action_block(actions);
+    clear_all_groups();
+    return result;
+}
+
+int main(void)
+{
+    add_test(run_called_groups);
+    add_test(run_large_and_recursive_groups);
+    add_test(count_inlined_calls);
+    return run_tests("Running actions");
+}
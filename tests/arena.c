@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "utility/arena.h"
+
+int arena_allocates(void)
+{
+    Arena arena;
+    char *strings[1000];
+    char string[32];
+    int length;
+
+    ZERO(&arena, 1);
+    /* enough strings to fill a few chunks */
+    for (int i = 0; i < (int) SIZE(strings); i++) {
+        length = snprintf(string, sizeof(string), "string number %d", i);
+        strings[i] = duplicate_arena_string(&arena, string, length);
+        if ((uintptr_t) strings[i] % sizeof(long double) != 0) {
+            LOG_ERROR("allocation %d is not aligned\n",
+                    i);
+            clear_arena(&arena);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < (int) SIZE(strings); i++) {
+        snprintf(string, sizeof(string), "string number %d", i);
+        if (strcmp(strings[i], string) != 0) {
+            LOG_ERROR("string %d was overwritten\n",
+                    i);
+            clear_arena(&arena);
+            return 1;
+        }
+    }
+
+    clear_arena(&arena);
+    return 0;
+}
+
+int arena_lists_grow(void)
+{
+    Arena arena;
+    struct {
+        LIST(int, first);
+        LIST(int, second);
+    } lists;
+
+    ZERO(&arena, 1);
+    ZERO(&lists, 1);
+
+    /* grow both lists in turns so only some growths are in place */
+    for (int i = 0; i < ARENA_CHUNK_SIZE; i++) {
+        ARENA_LIST_APPEND_VALUE(&arena, lists.first, i);
+        if (i % 3 == 0) {
+            ARENA_LIST_APPEND(&arena, lists.second, &i, 1);
+        }
+    }
+
+    for (int i = 0; i < ARENA_CHUNK_SIZE; i++) {
+        if (lists.first[i] != i ||
+                (i % 3 == 0 && lists.second[i / 3] != i)) {
+            LOG_ERROR("list item %d is wrong\n",
+                    i);
+            clear_arena(&arena);
+            return 1;
+        }
+    }
+
+    clear_arena(&arena);
+    return 0;
+}
+
+int main(void)
+{
+    add_test(arena_allocates);
+    add_test(arena_lists_grow);
+    return run_tests("Arena");
+}
@@ -0,0 +1,74 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/flight_recorder.h"
+#include "test.h"
+
+int recorder_keeps_last_entries(void)
+{
+    static char result[64 * 1024];
+    struct action_data data;
+    XEvent event;
+    FILE *file;
+    size_t length;
+    unsigned line_count = 0;
+    const char *last_line;
+    time_t now;
+    char date[32];
+
+    /* the date is written in UTC */
+    now = time(NULL);
+    strftime(date, sizeof(date), "[%F ", gmtime(&now));
+
+    ZERO(&event, 1);
+    event.type = KeymapNotify;
+    data.type = ACTION_DATA_TYPE_STRING;
+    data.flags = 0;
+    data.u.string = (utf8_t*) "/tmp/layout";
+    for (unsigned i = 0; i < FLIGHT_RECORDER_SIZE + 10; i++) {
+        record_event(&event);
+        record_action(i % 2 == 0 ? ACTION_EMPTY : ACTION_DUMP_LAYOUT, &data);
+    }
+
+    file = tmpfile();
+    if (file == NULL) {
+        return 1;
+    }
+    write_flight_recorder(fileno(file));
+    rewind(file);
+    length = fread(result, 1, sizeof(result) - 1, file);
+    result[length] = '\0';
+    fclose(file);
+
+    last_line = result;
+    for (const char *line = result; line[0] != '\0';
+            line = strchr(line, '\n') + 1) {
+        last_line = line;
+        line_count++;
+    }
+
+    if (line_count != FLIGHT_RECORDER_SIZE) {
+        LOG_ERROR("expected %u entries but got %u\n",
+                FLIGHT_RECORDER_SIZE, line_count);
+        return 1;
+    }
+
+    if (strncmp(last_line, date, strlen(date)) != 0 ||
+            strstr(result, "KeymapNotify") == NULL ||
+            strstr(last_line, "dump layout S (/tmp/layout)") == NULL ||
+            strstr(result, "action empty\n") == NULL) {
+        LOG_ERROR("the entries are wrong:\n%s\n",
+                result);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    add_test(recorder_keeps_last_entries);
+    return run_tests("Flight recorder");
+}
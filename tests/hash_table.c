@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "utility/hash_table.h"
+
+/* the number of entries to fill the table with, enough for it to grow a few
+ * times
+ */
+#define NUMBER_OF_ENTRIES 5000
+
+int hash_table_grows(void)
+{
+    HashTable table;
+    char name[32];
+    struct hash_table_entry *entry;
+    int length;
+
+    ZERO(&table, 1);
+    for (size_t i = 0; i < NUMBER_OF_ENTRIES; i++) {
+        length = snprintf(name, sizeof(name), "name%zu", i);
+        add_hash_table_entry(&table, name, length, (void*) (i + 1));
+    }
+
+    for (size_t i = 0; i < NUMBER_OF_ENTRIES; i++) {
+        length = snprintf(name, sizeof(name), "name%zu", i);
+        entry = find_hash_table_entry(&table, name, length);
+        if (entry == NULL || entry->value != (void*) (i + 1) ||
+                strcmp(entry->name, name) != 0) {
+            LOG_ERROR("entry %s was not found\n",
+                    name);
+            clear_hash_table(&table);
+            return 1;
+        }
+    }
+
+    /* names do not need to be null-terminated */
+    if (find_hash_table_entry(&table, "name12", 5) !=
+            find_hash_table_entry(&table, "name1", 5) ||
+            find_hash_table_entry(&table, "name", 4) != NULL) {
+        LOG_ERROR("lookup by length is wrong\n");
+        clear_hash_table(&table);
+        return 1;
+    }
+
+    clear_hash_table(&table);
+    return 0;
+}
+
+int hash_table_removes(void)
+{
+    HashTable table;
+    char name[32];
+    struct hash_table_entry *entry;
+    int length;
+
+    ZERO(&table, 1);
+    for (size_t i = 0; i < NUMBER_OF_ENTRIES; i++) {
+        length = snprintf(name, sizeof(name), "name%zu", i);
+        add_hash_table_entry(&table, name, length, (void*) (i + 1));
+    }
+
+    /* remove every third entry */
+    for (size_t i = 0; i < NUMBER_OF_ENTRIES; i += 3) {
+        length = snprintf(name, sizeof(name), "name%zu", i);
+        entry = find_hash_table_entry(&table, name, length);
+        if (entry == NULL) {
+            LOG_ERROR("entry %s vanished before it was removed\n",
+                    name);
+            clear_hash_table(&table);
+            return 1;
+        }
+        remove_hash_table_entry(&table, entry);
+    }
+
+    for (size_t i = 0; i < NUMBER_OF_ENTRIES; i++) {
+        length = snprintf(name, sizeof(name), "name%zu", i);
+        entry = find_hash_table_entry(&table, name, length);
+        if (i % 3 == 0 ? entry != NULL :
+                entry == NULL || entry->value != (void*) (i + 1)) {
+            LOG_ERROR("entry %s is wrong after removing\n",
+                    name);
+            clear_hash_table(&table);
+            return 1;
+        }
+    }
+
+    if (table.entries_length !=
+            NUMBER_OF_ENTRIES - (NUMBER_OF_ENTRIES + 2) / 3) {
+        LOG_ERROR("wrong number of entries after removing\n");
+        clear_hash_table(&table);
+        return 1;
+    }
+
+    clear_hash_table(&table);
+    return 0;
+}
+
+int main(void)
+{
+    add_test(hash_table_grows);
+    add_test(hash_table_removes);
+    return run_tests("Hash table");
+}
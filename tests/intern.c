@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "utility/intern.h"
+
+int equal_strings_are_shared(void)
+{
+    const char *first, *second, *other;
+
+    first = intern_string("firefox", 7);
+    /* the string does not need to be null-terminated */
+    second = intern_string("firefox-esr", 7);
+    other = intern_string("Navigator", 9);
+    if (first != second || first == other || strcmp(first, "firefox") != 0) {
+        LOG_ERROR("equal strings are not shared\n");
+        return 1;
+    }
+
+    if (get_interned_string_count() != 2) {
+        LOG_ERROR("expected 2 interned strings but got %zu\n",
+                get_interned_string_count());
+        return 1;
+    }
+
+    release_string(first);
+    release_string(second);
+    release_string(other);
+    return 0;
+}
+
+int strings_are_released(void)
+{
+    const char *string;
+
+    string = intern_string("st-256color", 11);
+    (void) reference_string(string);
+    release_string(string);
+    if (get_interned_string_count() != 1) {
+        LOG_ERROR("the string was released too early\n");
+        return 1;
+    }
+
+    release_string(string);
+    release_string(NULL);
+    if (get_interned_string_count() != 0) {
+        LOG_ERROR("the string was not released\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    add_test(equal_strings_are_shared);
+    add_test(strings_are_released);
+    return run_tests("String interning");
+}
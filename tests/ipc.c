@@ -0,0 +1,141 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "core/ipc.h"
+#include "test.h"
+
+/* Connect to the socket of the server.
+ *
+ * @return -1 if the connection failed.
+ */
+static int connect_to_server(void)
+{
+    struct sockaddr_un address;
+    char *path;
+    int file_descriptor;
+
+    path = get_ipc_socket_path();
+    if (path == NULL) {
+        return -1;
+    }
+    ZERO(&address, 1);
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    xfree(path);
+
+    file_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(file_descriptor, (struct sockaddr*) &address,
+                sizeof(address)) == -1) {
+        close(file_descriptor);
+        return -1;
+    }
+    return file_descriptor;
+}
+
+/* Run the server until @count reply lines were read into @replies from
+ * @file_descriptor.
+ *
+ * @return ERROR if the replies did not come.
+ */
+static int wait_for_replies(int file_descriptor, char *replies, size_t size,
+        unsigned count)
+{
+    fd_set read_set, write_set;
+    struct timeval timeout;
+    size_t length = 0;
+    ssize_t result;
+    unsigned line_count = 0;
+
+    for (unsigned cycle = 0; cycle < 100 && line_count < count; cycle++) {
+        FD_ZERO(&read_set);
+        FD_ZERO(&write_set);
+        FD_SET(file_descriptor, &read_set);
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 10000;
+        if (select(MAX(set_ipc_file_descriptors(&read_set, &write_set),
+                        file_descriptor) + 1,
+                    &read_set, &write_set, NULL, &timeout) <= 0) {
+            continue;
+        }
+        handle_ipc_file_descriptors(&read_set, &write_set);
+
+        if (FD_ISSET(file_descriptor, &read_set)) {
+            result = read(file_descriptor, &replies[length],
+                    size - 1 - length);
+            if (result <= 0) {
+                break;
+            }
+            for (ssize_t i = 0; i < result; i++) {
+                if (replies[length + i] == '\n') {
+                    line_count++;
+                }
+            }
+            length += result;
+        }
+    }
+    replies[length] = '\0';
+    return line_count == count ? OK : ERROR;
+}
+
+int pipelined_commands(void)
+{
+    char replies[256];
+    /* the last command is split in two writes, one command ends in a
+     * backslash and one spans two lines
+     */
+    static const char commands[] =
+        "nop\0this is no action\0nop\\\0nop\nnop\0n";
+    int file_descriptor;
+    int result = 0;
+
+    file_descriptor = connect_to_server();
+    if (file_descriptor < 0) {
+        LOG_ERROR("could not connect to the server\n");
+        return 1;
+    }
+
+    /* send a batch at once */
+    if (write(file_descriptor, commands, sizeof(commands) - 1) < 0 ||
+            wait_for_replies(file_descriptor, replies, sizeof(replies),
+                4) != OK ||
+            write(file_descriptor, "op", 3) < 0 ||
+            wait_for_replies(file_descriptor, replies + strlen(replies),
+                sizeof(replies) - strlen(replies), 1) != OK) {
+        LOG_ERROR("not all replies came\n");
+        result = 1;
+    } else if (strcmp(replies, "ok\nerror\nok\nok\nok\n") != 0) {
+        LOG_ERROR("the replies are wrong: %s\n",
+                replies);
+        result = 1;
+    }
+
+    close(file_descriptor);
+    return result;
+}
+
+int main(void)
+{
+    char template[] = "/tmp/fensterchef-test-XXXXXX";
+    char *directory;
+    int result;
+
+    directory = mkdtemp(template);
+    if (directory == NULL || setenv("XDG_RUNTIME_DIR", directory, 1) != 0 ||
+            setenv("DISPLAY", ":test", 1) != 0 ||
+            start_ipc_server() != OK) {
+        return 1;
+    }
+
+    add_test(pipelined_commands);
+    result = run_tests("Command socket");
+
+    stop_ipc_server();
+    remove(directory);
+    return result;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "core/log.h"
+#include "test.h"
+
+/* Read all of @file into @buffer of @size bytes and null-terminate it. */
+static void read_file(FILE *file, char *buffer, size_t size)
+{
+    size_t length;
+
+    rewind(file);
+    length = fread(buffer, 1, size - 1, file);
+    buffer[length] = '\0';
+}
+
+/* Remove all ANSI escape sequences for colors from @string. */
+static void remove_colors(char *string)
+{
+    char *end = string;
+
+    for (; string[0] != '\0'; string++) {
+        if (string[0] == '\x1b') {
+            string = strchr(string, 'm');
+        } else {
+            *end = string[0];
+            end++;
+        }
+    }
+    *end = '\0';
+}
+
+/* Log some lines with many kinds of format specifiers. */
+static void log_test_lines(void)
+{
+    const char string[] = "fensterchef";
+    int value = 42;
+
+    log_formatted("%d %i %u %x %#o %c %%\n",
+            -12, 7, 3000000000u, 255, 8, 'f');
+    log_formatted("%s|%10s|%-5.3s|%.*s|%*d\n",
+            string, "right", string, 6, string, -6, value);
+    log_formatted("%ld %lu %lld %zu %hhd %hu\n",
+            -1234567890l, 1234567890ul, -12345678901ll, (size_t) 99,
+            300, 70000);
+    log_formatted("%.2f %e %g %p %s\n",
+            3.14159, 1e10, 0.5, (void*) &value, (char*) NULL);
+    log_formatted("%P %S %R %b %b\n",
+            -4, 5, 640u, 480u, 1, 2, 3u, 4u, 1, 0);
+}
+
+int ring_formats_like_log(void)
+{
+    char expected[1024], result[1024];
+    FILE *file, *ring_file;
+
+    file = tmpfile();
+    ring_file = tmpfile();
+    if (file == NULL || ring_file == NULL) {
+        return 1;
+    }
+
+    log_file = file;
+    log_test_lines();
+    read_file(file, expected, sizeof(expected));
+
+    start_log_ring(64 * 1024);
+    rewind(file);
+    log_test_lines();
+    log_file = stderr;
+    if (ftell(file) != 0) {
+        LOG_ERROR("lines were written to the log file\n");
+        fclose(ring_file);
+        fclose(file);
+        return 1;
+    }
+
+    write_log_ring(ring_file);
+    read_file(ring_file, result, sizeof(result));
+    fclose(ring_file);
+    fclose(file);
+
+    if (strcmp(expected, result) != 0) {
+        LOG_ERROR("expected:\n%s\nbut got:\n%s\n",
+                expected, result);
+        return 1;
+    }
+    return 0;
+}
+
+int ring_overwrites_oldest(void)
+{
+    static char result[64 * 1024];
+    char long_string[1000];
+    FILE *file;
+    const char *line;
+    int first, next;
+
+    file = tmpfile();
+    if (file == NULL) {
+        return 1;
+    }
+
+    /* the smallest ring possible */
+    start_log_ring(1);
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+    for (int i = 0; i < 10000; i++) {
+        log_formatted("line %d %s\n",
+                i, i % 100 == 0 ? long_string : "");
+    }
+    write_log_ring(file);
+    read_file(file, result, sizeof(result));
+    fclose(file);
+    remove_colors(result);
+
+    /* the lines must be the last ones and follow each other */
+    if (sscanf(result, "line %d", &first) != 1) {
+        LOG_ERROR("the log ring does not start with a line\n");
+        return 1;
+    }
+    next = first;
+    for (line = result; line[0] != '\0'; line = strchr(line, '\n') + 1) {
+        int number;
+
+        if (sscanf(line, "line %d", &number) != 1 || number != next) {
+            LOG_ERROR("expected line %d in the log ring\n",
+                    next);
+            return 1;
+        }
+        /* long strings are cut */
+        if (number % 100 == 0 && strchr(line, '\n') - line !=
+                snprintf(NULL, 0, "line %d ", number) + 255) {
+            LOG_ERROR("the string in line %d was not cut\n",
+                    number);
+            return 1;
+        }
+        next++;
+    }
+
+    if (first == 0 || next != 10000) {
+        LOG_ERROR("expected the last lines but got %d to %d\n",
+                first, next - 1);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    log_file = stderr;
+    add_test(ring_formats_like_log);
+    add_test(ring_overwrites_oldest);
+    return run_tests("Log ring");
+}
@@ -0,0 +1,162 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/log_writer.h"
+#include "test.h"
+#include "utility/xalloc.h"
+
+/* the temporary directory the log files are put into */
+static char *directory;
+
+/* Remove all files in the temporary directory. */
+static void clear_directory(void)
+{
+    DIR *handle;
+    struct dirent *entry;
+    char *path;
+
+    handle = opendir(directory);
+    while (entry = readdir(handle), entry != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        path = xasprintf("%s/%s", directory, entry->d_name);
+        remove(path);
+        xfree(path);
+    }
+    closedir(handle);
+}
+
+int rotate_and_remove(void)
+{
+    static char content[4097];
+    FILE *stream, *file;
+    DIR *handle;
+    struct dirent *entry;
+    char *path;
+    size_t length;
+    unsigned count = 0;
+    bool has_last_line = false;
+    int result = 0;
+
+    /* files of an earlier start that should be removed */
+    for (unsigned i = 0; i < 5; i++) {
+        path = xasprintf("%s/2000-01-01_00:00:0%u.log", directory, i);
+        file = fopen(path, "w");
+        xfree(path);
+        if (file == NULL) {
+            return 1;
+        }
+        fclose(file);
+    }
+
+    stream = open_log_writer(directory, 4096, 3, &path);
+    if (stream == NULL) {
+        return 1;
+    }
+    xfree(path);
+    for (unsigned i = 0; i < 200; i++) {
+        fprintf(stream, "line %u of the log written in the background\n", i);
+    }
+    fclose(stream);
+
+    handle = opendir(directory);
+    while (entry = readdir(handle), entry != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        count++;
+        if (strncmp(entry->d_name, "2000", 4) == 0) {
+            LOG_ERROR("old log file %s was not removed\n",
+                    entry->d_name);
+            result = 1;
+        }
+
+        path = xasprintf("%s/%s", directory, entry->d_name);
+        file = fopen(path, "r");
+        xfree(path);
+        length = fread(content, 1, sizeof(content), file);
+        fclose(file);
+        if (length > 4096 || length == 0 || content[length - 1] != '\n') {
+            LOG_ERROR("log file %s was not cut after a line: %zu bytes\n",
+                    entry->d_name, length);
+            result = 1;
+        }
+        content[length] = '\0';
+        if (strstr(content, "line 199 ") != NULL) {
+            has_last_line = true;
+        }
+    }
+    closedir(handle);
+
+    if (count != 3) {
+        LOG_ERROR("expected 3 log files but got %u\n",
+                count);
+        result = 1;
+    }
+    if (!has_last_line) {
+        LOG_ERROR("the last line was not written out\n");
+        result = 1;
+    }
+    return result;
+}
+
+int flush_waits_for_writer(void)
+{
+    static char content[4097];
+    FILE *stream, *file;
+    char *path;
+    size_t length;
+    int result = 0;
+
+    clear_directory();
+
+    stream = open_log_writer(directory, LOG_FILE_MAXIMUM_SIZE, 3, &path);
+    if (stream == NULL) {
+        return 1;
+    }
+    fputs("the last line before a crash\n", stream);
+    flush_log_writer();
+
+    /* read the file while the stream is still open */
+    file = fopen(path, "r");
+    xfree(path);
+    if (file == NULL) {
+        fclose(stream);
+        return 1;
+    }
+    length = fread(content, 1, sizeof(content) - 1, file);
+    fclose(file);
+    content[length] = '\0';
+    if (strstr(content, "the last line before a crash") == NULL) {
+        LOG_ERROR("the queue was not written out: %s\n",
+                content);
+        result = 1;
+    }
+
+    fclose(stream);
+    return result;
+}
+
+int main(void)
+{
+    char template[] = "/tmp/fensterchef-test-XXXXXX";
+    int result;
+
+    directory = mkdtemp(template);
+    if (directory == NULL) {
+        return 1;
+    }
+
+    add_test(rotate_and_remove);
+    add_test(flush_waits_for_writer);
+    result = run_tests("Log writer");
+
+    clear_directory();
+    remove(directory);
+    return result;
+}
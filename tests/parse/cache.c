@@ -0,0 +1,307 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/action.h"
+#include "parse/alias.h"
+#include "parse/cache.h"
+#include "parse/group.h"
+#include "parse/parse.h"
+#include "test.h"
+#include "utility/utility.h"
+#include "utility/xalloc.h"
+
+/* the temporary directory the cache and configuration are put into */
+static char *directory;
+
+/* Check if two strings that may be `NULL` are equal. */
+static bool are_strings_equal(const char *string1, const char *string2)
+{
+    if (string1 == NULL || string2 == NULL) {
+        return string1 == string2;
+    }
+    return strcmp(string1, string2) == 0;
+}
+
+/* Check if two action blocks are deeply equal. */
+static bool are_blocks_equal(const ActionBlock *block1,
+        const ActionBlock *block2)
+{
+    size_t data_count = 0;
+
+    if (block1 == NULL || block2 == NULL) {
+        return block1 == block2;
+    }
+
+    if (block1->number_of_items != block2->number_of_items) {
+        return false;
+    }
+    for (size_t i = 0; i < block1->number_of_items; i++) {
+        if (block1->items[i].type != block2->items[i].type ||
+                block1->items[i].data_count != block2->items[i].data_count) {
+            return false;
+        }
+        data_count += block1->items[i].data_count;
+    }
+
+    for (size_t i = 0; i < data_count; i++) {
+        const struct action_data *const data1 = &block1->data[i];
+        const struct action_data *const data2 = &block2->data[i];
+
+        if (data1->flags != data2->flags || data1->type != data2->type) {
+            return false;
+        }
+
+        switch (data1->type) {
+        case ACTION_DATA_TYPE_INTEGER:
+            if (data1->u.integer != data2->u.integer) {
+                return false;
+            }
+            break;
+
+        case ACTION_DATA_TYPE_STRING:
+            if (!are_strings_equal(data1->u.string, data2->u.string)) {
+                return false;
+            }
+            break;
+
+        case ACTION_DATA_TYPE_RELATION:
+            if (!are_strings_equal(data1->u.relation.instance_pattern,
+                        data2->u.relation.instance_pattern) ||
+                    !are_strings_equal(data1->u.relation.class_pattern,
+                        data2->u.relation.class_pattern) ||
+                    !are_blocks_equal(data1->u.relation.actions,
+                        data2->u.relation.actions)) {
+                return false;
+            }
+            break;
+
+        case ACTION_DATA_TYPE_BUTTON:
+            if (data1->u.button.is_release != data2->u.button.is_release ||
+                    data1->u.button.is_transparent !=
+                        data2->u.button.is_transparent ||
+                    data1->u.button.modifiers != data2->u.button.modifiers ||
+                    data1->u.button.button != data2->u.button.button ||
+                    !are_blocks_equal(data1->u.button.actions,
+                        data2->u.button.actions)) {
+                return false;
+            }
+            break;
+
+        case ACTION_DATA_TYPE_KEY:
+            if (data1->u.key.is_release != data2->u.key.is_release ||
+                    data1->u.key.modifiers != data2->u.key.modifiers ||
+                    data1->u.key.key_symbol != data2->u.key.key_symbol ||
+                    data1->u.key.key_code != data2->u.key.key_code ||
+                    !are_blocks_equal(data1->u.key.actions,
+                        data2->u.key.actions)) {
+                return false;
+            }
+            break;
+
+        case ACTION_DATA_TYPE_MAX:
+            break;
+        }
+    }
+    return true;
+}
+
+/* Write @content into the file at @path. */
+static int write_file(const char *path, const char *content)
+{
+    FILE *file;
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        return ERROR;
+    }
+    fputs(content, file);
+    return fclose(file) == 0 ? OK : ERROR;
+}
+
+int cache_round_trip(void)
+{
+    Parser *parser;
+    ActionBlock *parsed_actions, *cached_actions;
+    struct parse_file *files;
+    size_t number_of_files;
+    char *path;
+    int result = 0;
+
+    path = xasprintf("%s/fensterchef.config", directory);
+    if (write_file(path,
+                "alias mod = Mod4\n"
+                "group test (\n"
+                "    mod+Return run \"xterm\"\n"
+                "    release transparent mod+LeftButton close window\n"
+                ")\n"
+                "relate Navigator, firefox (\n"
+                "    resize window by -1% 10\n"
+                ")\n"
+                "call test\n"
+                "border size 3\n") != OK) {
+        xfree(path);
+        return 1;
+    }
+
+    clear_all_aliases();
+    clear_all_groups();
+    parser = create_file_parser(path);
+    parsed_actions = parse_actions(parser);
+    if (parsed_actions == NULL) {
+        LOG_ERROR("the test configuration does not parse\n");
+        destroy_parser(parser);
+        xfree(path);
+        return 1;
+    }
+    save_configuration_cache(parser, parsed_actions);
+    destroy_parser(parser);
+
+    clear_all_aliases();
+    clear_all_groups();
+    cached_actions = load_configuration_cache(path, &files, &number_of_files);
+    if (cached_actions == NULL) {
+        LOG_ERROR("the cache was not loaded\n");
+        result = 1;
+    } else if (number_of_files != 1 || strcmp(files[0].path, path) != 0) {
+        LOG_ERROR("the cache does not list the configuration file\n");
+        result = 1;
+    } else if (!are_blocks_equal(parsed_actions, cached_actions)) {
+        LOG_ERROR("the cached actions differ from the parsed actions\n");
+        result = 1;
+    } else if (find_group("test") == NULL ||
+            !are_strings_equal(resolve_alias("mod", 3), "Mod4")) {
+        LOG_ERROR("the cached aliases and groups were not set\n");
+        result = 1;
+    }
+    free_parse_files(files, number_of_files);
+    dereference_action_block(cached_actions);
+    dereference_action_block(parsed_actions);
+
+    /* a change that keeps the size must still be noticed */
+    if (result == 0 && write_file(path, "border size 4\n") == OK) {
+        parser = create_file_parser(path);
+        parsed_actions = parse_actions(parser);
+        save_configuration_cache(parser, parsed_actions);
+        destroy_parser(parser);
+        dereference_action_block(parsed_actions);
+
+        if (write_file(path, "border size 5\n") != OK) {
+            result = 1;
+        } else {
+            cached_actions = load_configuration_cache(path, &files,
+                    &number_of_files);
+            free_parse_files(files, number_of_files);
+            if (cached_actions != NULL) {
+                LOG_ERROR("a changed file was loaded from the cache\n");
+                dereference_action_block(cached_actions);
+                result = 1;
+            }
+        }
+    }
+
+    clear_all_aliases();
+    clear_all_groups();
+    remove(path);
+    xfree(path);
+    return result;
+}
+
+/* Parse the file at @path.
+ *
+ * @return NULL if parsing failed.
+ */
+static ActionBlock *parse_file(const char *path)
+{
+    Parser *parser;
+    ActionBlock *actions;
+
+    clear_all_aliases();
+    clear_all_groups();
+    parser = create_file_parser(path);
+    if (parser == NULL) {
+        return NULL;
+    }
+    actions = parse_actions(parser);
+    destroy_parser(parser);
+    return actions;
+}
+
+int source_cache(void)
+{
+    char *path, *bindings_path, *content;
+    ActionBlock *first_actions, *second_actions, *changed_actions;
+    int result = 0;
+
+    path = xasprintf("%s/main.config", directory);
+    bindings_path = xasprintf("%s/bindings.config", directory);
+    content = xasprintf("alias mod = Mod4\nsource %s\nborder size 2\n",
+            bindings_path);
+    if (write_file(path, content) != OK ||
+            write_file(bindings_path,
+                "mod+Return run xterm\nmod+q close window\n") != OK) {
+        xfree(content);
+        xfree(bindings_path);
+        xfree(path);
+        return 1;
+    }
+    xfree(content);
+
+    first_actions = parse_file(path);
+    /* this time the sourced file comes from the source cache */
+    second_actions = parse_file(path);
+    if (first_actions == NULL ||
+            !are_blocks_equal(first_actions, second_actions)) {
+        LOG_ERROR("parsing with the source cache gives different actions\n");
+        result = 1;
+    }
+
+    /* keep the size the same so only the content tells the difference */
+    if (result == 0 && write_file(bindings_path,
+                "mod+Return run xterm\nmod+w close window\n") == OK) {
+        changed_actions = parse_file(path);
+        if (changed_actions == NULL ||
+                are_blocks_equal(first_actions, changed_actions)) {
+            LOG_ERROR("a changed sourced file was not parsed again\n");
+            result = 1;
+        }
+        dereference_action_block(changed_actions);
+    }
+
+    dereference_action_block(second_actions);
+    dereference_action_block(first_actions);
+    clear_all_aliases();
+    clear_all_groups();
+    remove(bindings_path);
+    remove(path);
+    xfree(bindings_path);
+    xfree(path);
+    return result;
+}
+
+int main(void)
+{
+    char template[] = "/tmp/fensterchef-test-XXXXXX";
+    char *cache_path;
+    int result;
+
+    directory = mkdtemp(template);
+    if (directory == NULL || setenv("XDG_CACHE_HOME", directory, 1) != 0) {
+        return 1;
+    }
+
+    add_test(cache_round_trip);
+    add_test(source_cache);
+    result = run_tests("Configuration cache");
+
+    cache_path = xasprintf("%s/fensterchef/configuration", directory);
+    remove(cache_path);
+    xfree(cache_path);
+    cache_path = xasprintf("%s/fensterchef", directory);
+    remove(cache_path);
+    xfree(cache_path);
+    remove(directory);
+    return result;
+}
@@ -41,6 +41,9 @@ static struct test {
     { "relate 'mewindow' set floating, minimize window", true },
     { "gaps inner", false },
     { "center window", true },
+    { "bar true", true },
+    { "bar command 'date +%H:%M'", true },
+    { "bar command", false },
     { "center window to hey", true },
     { "move window by -80 0", true },
     { "unbind a", true },
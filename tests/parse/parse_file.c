@@ -35,9 +35,31 @@ int random_file_parser(void)
     return 0;
 }
 
+int file_without_size(void)
+{
+    Parser *parser;
+    int result = 0;
+
+    /* files within `/proc` report a size of 0 but still have content */
+    parser = create_file_parser("/proc/self/stat");
+    if (parser == NULL) {
+        return 1;
+    }
+
+    if (parser->length == 0 || parser->files[0].size != parser->length) {
+        LOG_ERROR("the file was not read: %zu\n",
+                parser->length);
+        result = 1;
+    }
+
+    destroy_parser(parser);
+    return result;
+}
+
 int main(void)
 {
     add_test(config_file_parser);
     add_test(random_file_parser);
+    add_test(file_without_size);
     return run_tests("Parsing test files");
 }
@@ -0,0 +1,56 @@
+#include <string.h>
+
+#include "parse/input.h"
+#include "parse/parse.h"
+#include "test.h"
+
+static const struct test {
+    const char *input;
+    size_t index;
+    unsigned line;
+    unsigned column;
+    /* the line the index is in */
+    const char *string_line;
+} test_cases[] = {
+    { "focus left", 6, 0, 6, "focus left" },
+    { "focus left\nfocus right", 11, 1, 0, "focus right" },
+    { "a\r\nb\r\nfocus up", 8, 2, 2, "focus up" },
+    { "a\n\n\nfocus up", 100, 3, 8, "focus up" },
+    { "\tfocus up", 2, 0, 9, "\tfocus up" },
+    { "x\n\ta\x01\tb", 6, 1, 16, "\ta\x01\tb" },
+    { "one\ntwo\nthree\n", 14, 3, 0, "" },
+};
+
+int stream_positions(void)
+{
+    Parser *parser;
+    unsigned line, column, length;
+    const char *string_line;
+
+    for (unsigned i = 0; i < SIZE(test_cases); i++) {
+        const struct test *const test = &test_cases[i];
+
+        parser = create_string_parser(test->input);
+        get_stream_position(parser, test->index, &line, &column);
+        string_line = get_stream_line(parser, line, &length);
+        if (line != test->line || column != test->column ||
+                length != strlen(test->string_line) ||
+                memcmp(string_line, test->string_line, length) != 0) {
+            PRINT_TEST_FAILURE(i + 1, SIZE(test_cases));
+            LOG_ERROR("expected %u:%u \"%s\" but got %u:%u \"%.*s\"\n",
+                    test->line, test->column, test->string_line,
+                    line, column, (int) length, string_line);
+            destroy_parser(parser);
+            return 1;
+        }
+        PRINT_TEST_SUCCESS(i + 1, SIZE(test_cases));
+        destroy_parser(parser);
+    }
+    return 0;
+}
+
+int main(void)
+{
+    add_test(stream_positions);
+    return run_tests("Stream positions");
+}
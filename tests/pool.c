@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "utility/pool.h"
+
+/* an object that does not fill the alignment exactly */
+struct test_object {
+    char name[13];
+    int value;
+};
+
+/* the number of objects to allocate, enough for a few slabs */
+#define NUMBER_OF_OBJECTS 50
+
+int pool_reuses_objects(void)
+{
+    ObjectPool pool = OBJECT_POOL(struct test_object, 8);
+    struct test_object *objects[NUMBER_OF_OBJECTS];
+    struct test_object *object;
+
+    for (int i = 0; i < NUMBER_OF_OBJECTS; i++) {
+        objects[i] = allocate_pool_object(&pool);
+        if (objects[i]->value != 0 || objects[i]->name[0] != '\0') {
+            LOG_ERROR("object %d is not zeroed\n",
+                    i);
+            clear_object_pool(&pool);
+            return 1;
+        }
+        objects[i]->value = i;
+        snprintf(objects[i]->name, sizeof(objects[i]->name), "object%d", i);
+    }
+
+    for (int i = 0; i < NUMBER_OF_OBJECTS; i++) {
+        if (objects[i]->value != i) {
+            LOG_ERROR("object %d was overwritten\n",
+                    i);
+            clear_object_pool(&pool);
+            return 1;
+        }
+    }
+
+    if (pool.number_of_slabs != (NUMBER_OF_OBJECTS + 7) / 8 ||
+            pool.used_count != NUMBER_OF_OBJECTS) {
+        LOG_ERROR("expected %d objects in %d slabs but got %zu in %zu\n",
+                NUMBER_OF_OBJECTS, (NUMBER_OF_OBJECTS + 7) / 8,
+                pool.used_count, pool.number_of_slabs);
+        clear_object_pool(&pool);
+        return 1;
+    }
+
+    /* the freed object is handed out next */
+    free_pool_object(&pool, objects[10]);
+    object = allocate_pool_object(&pool);
+    if (object != objects[10] || object->value != 0) {
+        LOG_ERROR("the freed object was not reused\n");
+        clear_object_pool(&pool);
+        return 1;
+    }
+
+    for (int i = 0; i < NUMBER_OF_OBJECTS; i++) {
+        free_pool_object(&pool, objects[i]);
+    }
+    if (pool.used_count != 0 ||
+            pool.peak_used_count != NUMBER_OF_OBJECTS ||
+            pool.allocation_count != NUMBER_OF_OBJECTS + 1) {
+        LOG_ERROR("the statistics are wrong\n");
+        clear_object_pool(&pool);
+        return 1;
+    }
+
+    clear_object_pool(&pool);
+    return 0;
+}
+
+int main(void)
+{
+    add_test(pool_reuses_objects);
+    return run_tests("Object pool");
+}
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "core/action.h"
+#include "core/configuration.h"
+#include "core/relation.h"
+#include "core/window.h"
+#include "test.h"
+#include "utility/intern.h"
+
+/* patterns of relations in the order they are set */
+static const char *const patterns[][2] = {
+    { "*", "firefox" },
+    { "Navigator", "*" },
+    { "*", "fire*" },
+    { "st", "st-256color" },
+    { "*", "*" },
+    { "*", "?t*" },
+    { "vim", "st*" },
+    { "*", "st-256color" },
+    { "Nav*", "[Ff]irefox" },
+    { "*", "fire\\*" },
+    { "*", "" },
+};
+
+/* instance and class names of windows */
+static const char *const windows[][2] = {
+    { "Navigator", "firefox" },
+    { "Navigator", "Firefox" },
+    { "st", "st-256color" },
+    { "vim", "st-256color" },
+    { "x", "fire*" },
+    { "x", "fi" },
+    { "x", NULL },
+    { NULL, NULL },
+};
+
+/* Set the interned @instance and @class of @window, both may be NULL. */
+static void set_window_class(FcWindow *window, const char *instance,
+        const char *class)
+{
+    release_string(window->properties.instance);
+    release_string(window->properties.class);
+    window->properties.instance = instance == NULL ? NULL :
+        intern_string(instance, strlen(instance));
+    window->properties.class = class == NULL ? NULL :
+        intern_string(class, strlen(class));
+}
+
+int relations_match_in_order(void)
+{
+    struct window_relation relation;
+    ActionBlock *actions[SIZE(patterns)];
+    FcWindow window;
+    unsigned expected;
+    bool has_match;
+
+    for (unsigned i = 0; i < SIZE(patterns); i++) {
+        /* the text padding tells which relation ran last */
+        actions[i] = create_empty_action_block(1, 1);
+        actions[i]->items[0].type = ACTION_TEXT_PADDING;
+        actions[i]->items[0].data_count = 1;
+        actions[i]->data[0].type = ACTION_DATA_TYPE_INTEGER;
+        actions[i]->data[0].u.integer = i;
+
+        relation.instance_pattern = (char*) patterns[i][0];
+        relation.class_pattern = (char*) patterns[i][1];
+        relation.actions = actions[i];
+        set_window_relation(&relation);
+        dereference_action_block(actions[i]);
+    }
+
+    ZERO(&window, 1);
+    for (unsigned i = 0; i < SIZE(windows); i++) {
+        set_window_class(&window, windows[i][0], windows[i][1]);
+
+        expected = SIZE(patterns);
+        for (unsigned j = 0; j < SIZE(patterns); j++) {
+            if (matches_pattern(patterns[j][0], windows[i][0]) &&
+                    matches_pattern(patterns[j][1], windows[i][1])) {
+                expected = j;
+            }
+        }
+
+        configuration.text_padding = SIZE(patterns);
+        has_match = run_window_relations(&window);
+        if (has_match != (expected != SIZE(patterns)) ||
+                configuration.text_padding != expected) {
+            PRINT_TEST_FAILURE(i + 1, SIZE(windows));
+            LOG_ERROR("expected relation %u to run last but got %u\n",
+                    expected, (unsigned) configuration.text_padding);
+            set_window_class(&window, NULL, NULL);
+            unset_window_relations();
+            return 1;
+        }
+        PRINT_TEST_SUCCESS(i + 1, SIZE(windows));
+    }
+
+    /* removing a relation must keep the others */
+    relation.instance_pattern = (char*) patterns[SIZE(patterns) - 1][0];
+    relation.class_pattern = (char*) patterns[SIZE(patterns) - 1][1];
+    relation.actions = NULL;
+    set_window_relation(&relation);
+    relation.instance_pattern = (char*) patterns[7][0];
+    relation.class_pattern = (char*) patterns[7][1];
+    set_window_relation(&relation);
+
+    set_window_class(&window, "st", "st-256color");
+    configuration.text_padding = SIZE(patterns);
+    if (!run_window_relations(&window) || configuration.text_padding != 5) {
+        LOG_ERROR("relations are wrong after removing\n");
+        set_window_class(&window, NULL, NULL);
+        unset_window_relations();
+        return 1;
+    }
+
+    set_window_class(&window, NULL, NULL);
+    unset_window_relations();
+    return 0;
+}
+
+/* Set the relation @instance,@class to set the text padding to @padding. */
+static void set_padding_relation(const char *instance, const char *class,
+        int padding)
+{
+    struct window_relation relation;
+
+    relation.instance_pattern = (char*) instance;
+    relation.class_pattern = (char*) class;
+    if (padding < 0) {
+        relation.actions = NULL;
+    } else {
+        relation.actions = create_empty_action_block(1, 1);
+        relation.actions->items[0].type = ACTION_TEXT_PADDING;
+        relation.actions->items[0].data_count = 1;
+        relation.actions->data[0].type = ACTION_DATA_TYPE_INTEGER;
+        relation.actions->data[0].u.integer = padding;
+    }
+    set_window_relation(&relation);
+    dereference_action_block(relation.actions);
+}
+
+int relations_are_remembered(void)
+{
+    FcWindow window;
+    const struct {
+        /* the relation to set before running */
+        const char *instance, *class;
+        int padding;
+        /* the expected padding after running, 0 if nothing should run */
+        unsigned expected;
+    } steps[] = {
+        { "st", "st*", 1, 1 },
+        /* the same window again, now from the memo */
+        { NULL, NULL, -1, 1 },
+        /* adding a relation must be noticed */
+        { "*", "st-256color", 2, 2 },
+        /* replacing the actions must be noticed */
+        { "*", "st-256color", 3, 3 },
+        /* removing a relation must be noticed */
+        { "*", "st-256color", -1, 1 },
+        { "st", "st*", -1, 0 },
+    };
+
+    ZERO(&window, 1);
+    set_window_class(&window, "st", "st-256color");
+    for (unsigned i = 0; i < SIZE(steps); i++) {
+        if (steps[i].instance != NULL) {
+            set_padding_relation(steps[i].instance, steps[i].class,
+                    steps[i].padding);
+        }
+
+        configuration.text_padding = 0;
+        (void) run_window_relations(&window);
+        if (configuration.text_padding != steps[i].expected) {
+            PRINT_TEST_FAILURE(i + 1, SIZE(steps));
+            LOG_ERROR("expected padding %u but got %u\n",
+                    steps[i].expected, configuration.text_padding);
+            set_window_class(&window, NULL, NULL);
+            unset_window_relations();
+            return 1;
+        }
+        PRINT_TEST_SUCCESS(i + 1, SIZE(steps));
+    }
+
+    set_window_class(&window, NULL, NULL);
+    unset_window_relations();
+    return 0;
+}
+
+int main(void)
+{
+    add_test(relations_match_in_order);
+    add_test(relations_are_remembered);
+    return run_tests("Window relations");
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "utility/search.h"
+
+int search_matches(void)
+{
+    const struct {
+        const char *strings[3];
+        const char *search;
+        bool is_matching;
+    } test_cases[] = {
+        { { "Mozilla Firefox", "Navigator", "firefox" }, "fire", true },
+        { { "Mozilla Firefox", "Navigator", "firefox" }, "FIRE", true },
+        { { "Mozilla Firefox", "Navigator", "firefox" }, "nav moz", true },
+        { { "Mozilla Firefox", "Navigator", "firefox" }, "nav chrome", false },
+        { { "Mozilla Firefox", "Navigator", "firefox" }, "x n", true },
+        { { "Mozilla Firefox", "Navigator", "firefox" }, "foxnav", false },
+        { { "vim", NULL, "st-256color" }, "st-2", true },
+        { { "vim", NULL, "st-256color" }, "vim ", true },
+        { { NULL, NULL, NULL }, "a", false },
+        { { NULL, NULL, NULL }, "", true },
+    };
+
+    for (unsigned i = 0; i < SIZE(test_cases); i++) {
+        SearchKey key = { NULL, 0 };
+        utf8_t search[64];
+        size_t length;
+        bool is_matching;
+
+        /* searches are stored in their compared form */
+        for (length = 0; test_cases[i].search[length] != '\0'; length++) {
+            search[length] = get_search_character(test_cases[i].search[length]);
+        }
+
+        set_search_key(&key, test_cases[i].strings,
+                SIZE(test_cases[i].strings));
+        is_matching = does_search_match(&key, search, length,
+                get_search_trigrams(search, length));
+        clear_search_key(&key);
+
+        if (is_matching != test_cases[i].is_matching) {
+            PRINT_TEST_FAILURE(i + 1, SIZE(test_cases));
+            LOG_ERROR("search \"%s\" should %smatch\n",
+                    test_cases[i].search,
+                    test_cases[i].is_matching ? "" : "not ");
+            return 1;
+        }
+        PRINT_TEST_SUCCESS(i + 1, SIZE(test_cases));
+    }
+    return 0;
+}
+
+int search_is_monotone(void)
+{
+    const char *const strings[] = { "Terminal - htop", "st", "St" };
+    const char search[] = "term htop st";
+    SearchKey key = { NULL, 0 };
+
+    /* every prefix of a matching search must match as well */
+    set_search_key(&key, strings, SIZE(strings));
+    for (size_t length = 0; length <= strlen(search); length++) {
+        if (!does_search_match(&key, search, length,
+                    get_search_trigrams(search, length))) {
+            LOG_ERROR("prefix of length %zu does not match\n",
+                    length);
+            clear_search_key(&key);
+            return 1;
+        }
+    }
+    clear_search_key(&key);
+    return 0;
+}
+
+int main(void)
+{
+    add_test(search_matches);
+    add_test(search_is_monotone);
+    return run_tests("Search");
+}
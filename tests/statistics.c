@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "core/statistics.h"
+#include "test.h"
+
+/* Write the statistics into @content. */
+static int read_statistics(char *content, size_t size)
+{
+    FILE *file;
+    size_t length;
+
+    file = tmpfile();
+    if (file == NULL) {
+        return ERROR;
+    }
+    write_statistics(file);
+    rewind(file);
+    length = fread(content, 1, size - 1, file);
+    content[length] = '\0';
+    fclose(file);
+    return OK;
+}
+
+int histograms_and_round_trips(void)
+{
+    static char content[16 * 1024];
+    uint64_t now;
+
+    now = get_statistics_time();
+    /* one fast event and one that took 3 milliseconds */
+    count_event(MapRequest, now);
+    count_event(MapRequest, now - 3000000);
+    count_event(1000, now);
+    count_action(ACTION_CLOSE_WINDOW, now);
+
+    count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
+    count_round_trip(ROUND_TRIP_GET_WINDOW_PROPERTY);
+    count_round_trip(ROUND_TRIP_SYNC);
+    end_statistics_cycle();
+    end_statistics_cycle();
+    count_round_trip(ROUND_TRIP_GET_GEOMETRY);
+    end_statistics_cycle();
+
+    if (read_statistics(content, sizeof(content)) != OK) {
+        return 1;
+    }
+
+    if (strstr(content, "MapRequest: 2 calls") == NULL ||
+            strstr(content, "<4096us:1") == NULL ||
+            strstr(content, "extension: 1 calls") == NULL ||
+            strstr(content, "close window: 1 calls") == NULL ||
+            strstr(content, "KeyPress") != NULL ||
+            strstr(content, "XGetWindowProperty: 2\n") == NULL ||
+            strstr(content, "XSync: 1\n") == NULL ||
+            strstr(content, "3 cycles, 3 max") == NULL ||
+            strstr(content, " 0:1 1:1 2-3:1\n") == NULL) {
+        LOG_ERROR("the statistics are wrong:\n%s\n",
+                content);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    add_test(histograms_and_round_trips);
+    return run_tests("Statistics");
+}
@@ -0,0 +1,123 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "core/trace.h"
+#include "test.h"
+
+/* the path the traces are written to */
+static char path[] = "/tmp/fensterchef-trace-XXXXXX";
+
+/* Read the written trace into @content. */
+static size_t read_trace(char *content, size_t size)
+{
+    FILE *file;
+    size_t length;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    length = fread(content, 1, size - 1, file);
+    content[length] = '\0';
+    fclose(file);
+    return length;
+}
+
+/* Count the occurences of @needle in @string. */
+static unsigned count_occurences(const char *string, const char *needle)
+{
+    unsigned count = 0;
+
+    while (string = strstr(string, needle), string != NULL) {
+        count++;
+        string++;
+    }
+    return count;
+}
+
+int nested_spans(void)
+{
+    static char content[4096];
+    const char *outer, *inner;
+
+    /* this span is not recorded and ending it must do nothing */
+    begin_trace_span("event", "KeyPress");
+
+    start_trace();
+    end_trace_span();
+    begin_trace_span("event", "MapRequest");
+    begin_trace_span("action", "focus window");
+    end_trace_span();
+    end_trace_span();
+    begin_trace_span("synchronize", "synchronize with server");
+    if (stop_trace(path) != OK || read_trace(content, sizeof(content)) == 0) {
+        return 1;
+    }
+
+    if (strncmp(content, "{\"traceEvents\":[", 16) != 0 ||
+            count_occurences(content, "\"ph\":\"X\"") != 3 ||
+            strstr(content, "KeyPress") != NULL) {
+        LOG_ERROR("the trace is wrong:\n%s\n",
+                content);
+        return 1;
+    }
+
+    outer = strstr(content, "\"name\":\"MapRequest\"");
+    inner = strstr(content, "\"name\":\"focus window\"");
+    if (outer == NULL || inner == NULL || outer > inner ||
+            strstr(content, "\"cat\":\"synchronize\"") == NULL) {
+        LOG_ERROR("the spans are not in order:\n%s\n",
+                content);
+        return 1;
+    }
+    return 0;
+}
+
+int deep_spans(void)
+{
+    static char content[64 * 1024];
+
+    start_trace();
+    for (unsigned i = 0; i < TRACE_MAXIMUM_DEPTH + 8; i++) {
+        begin_trace_span("action", "call");
+    }
+    for (unsigned i = 0; i < TRACE_MAXIMUM_DEPTH + 8; i++) {
+        end_trace_span();
+    }
+    begin_trace_span("action", "last");
+    end_trace_span();
+    if (stop_trace(path) != OK || read_trace(content, sizeof(content)) == 0) {
+        return 1;
+    }
+
+    if (count_occurences(content, "\"ph\":\"X\"") != TRACE_MAXIMUM_DEPTH + 1 ||
+            strstr(content, "\"args\":{\"count\":8}") == NULL) {
+        LOG_ERROR("the deep spans are wrong:\n%s\n",
+                content);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int descriptor;
+    int result;
+
+    descriptor = mkstemp(path);
+    if (descriptor == -1) {
+        return 1;
+    }
+    close(descriptor);
+
+    add_test(nested_spans);
+    add_test(deep_spans);
+    result = run_tests("Tracing");
+
+    remove(path);
+    return result;
+}
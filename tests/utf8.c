@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "utility/utf8.h"
+#include "utility/utility.h"
+
+int utf8_decodes(void)
+{
+    const struct {
+        const char *utf8;
+        uint32_t codepoints[8];
+        size_t count;
+    } test_cases[] = {
+        { "", { 0 }, 0 },
+        { "abc", { 'a', 'b', 'c' }, 3 },
+        { "\xc3\xa4x", { 0xe4, 'x' }, 2 },
+        { "\xe2\x82\xac", { 0x20ac }, 1 },
+        { "\xf0\x9f\x98\x80!", { 0x1f600, '!' }, 2 },
+        /* overlong encoding of '/' */
+        { "\xc0\xaf", { 0xfffd, 0xfffd }, 2 },
+        /* overlong three byte encoding */
+        { "\xe0\x80\xaf", { 0xfffd }, 1 },
+        /* surrogate */
+        { "\xed\xa0\x80", { 0xfffd }, 1 },
+        /* above U+10FFFF */
+        { "\xf4\x90\x80\x80", { 0xfffd }, 1 },
+        /* stray continuation byte */
+        { "a\x80" "b", { 'a', 0xfffd, 'b' }, 3 },
+        /* truncated sequences */
+        { "\xe2\x82" "a", { 0xfffd, 'a' }, 2 },
+        { "\xf0\x9f\x98", { 0xfffd }, 1 },
+    };
+
+    for (unsigned i = 0; i < SIZE(test_cases); i++) {
+        uint32_t codepoints[8];
+        size_t count;
+
+        count = decode_utf8(test_cases[i].utf8, strlen(test_cases[i].utf8),
+                codepoints);
+        if (count != test_cases[i].count ||
+                memcmp(codepoints, test_cases[i].codepoints,
+                    sizeof(*codepoints) * count) != 0) {
+            PRINT_TEST_FAILURE(i + 1, SIZE(test_cases));
+            LOG_ERROR("decoding case %u gave %zu codepoints\n",
+                    i + 1, count);
+            return 1;
+        }
+        PRINT_TEST_SUCCESS(i + 1, SIZE(test_cases));
+    }
+    return 0;
+}
+
+int utf8_decodes_long_strings(void)
+{
+    char utf8[4099];
+    uint32_t codepoints[sizeof(utf8)];
+    size_t length = 0, count;
+
+    /* long ascii runs with multi byte characters at every possible offset */
+    for (size_t i = 0; length + 3 < sizeof(utf8); i++) {
+        if (i % 37 == 36) {
+            memcpy(&utf8[length], "\xe2\x82\xac", 3);
+            length += 3;
+        } else {
+            utf8[length++] = 'a' + i % 26;
+        }
+    }
+
+    count = decode_utf8(utf8, length, codepoints);
+
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t expected = i % 37 == 36 ? 0x20ac : 'a' + i % 26;
+        if (codepoints[i] != expected) {
+            LOG_ERROR("codepoint %zu is %#x instead of %#x\n",
+                    i, codepoints[i], expected);
+            return 1;
+        }
+    }
+
+    if (count != length - (length / 39) * 2) {
+        LOG_ERROR("got %zu codepoints from %zu bytes\n",
+                count, length);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    add_test(utf8_decodes);
+    add_test(utf8_decodes_long_strings);
+    return run_tests("UTF-8");
+}
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "utility/xalloc.h"
+
+/* Find the allocations made within @file. */
+static const struct allocation_site *find_allocation_site(const char *file)
+{
+    const struct allocation_site *sites;
+    size_t number_of_sites;
+
+    sites = get_allocation_sites(&number_of_sites);
+    for (size_t i = 0; i < number_of_sites; i++) {
+        if (sites[i].file != NULL && strcmp(sites[i].file, file) == 0) {
+            return &sites[i];
+        }
+    }
+    return NULL;
+}
+
+int allocations_are_counted(void)
+{
+    const struct allocation_site *site;
+    size_t allocation_count, live_bytes = 0;
+    char *string, *other_string;
+    void *memory;
+    int result = 0;
+
+    site = find_allocation_site(__FILE__);
+    if (site != NULL) {
+        live_bytes = site->live_bytes;
+    }
+    allocation_count = get_allocation_count();
+
+    string = xstrdup("fensterchef");
+    other_string = xasprintf("%d", 1234);
+    memory = xcalloc(3, 4);
+    memory = xrealloc(memory, 20);
+
+    /* the reallocation replaces the 12 bytes */
+    site = find_allocation_site(__FILE__);
+    if (site == NULL || site->live_bytes != live_bytes + 12 + 5 + 20 ||
+            site->peak_bytes < site->live_bytes) {
+        LOG_ERROR("the live bytes were not counted for this file\n");
+        result = 1;
+    }
+
+    if (get_allocation_count() != allocation_count + 4) {
+        LOG_ERROR("expected 4 more allocations but got %zu\n",
+                get_allocation_count() - allocation_count);
+        result = 1;
+    }
+
+    xfree(memory);
+    xfree(other_string);
+    xfree(string);
+
+    if (site != NULL && (site->live_bytes != live_bytes ||
+                site->peak_bytes < live_bytes + 12 + 5 + 20)) {
+        LOG_ERROR("the freed bytes were not taken off\n");
+        result = 1;
+    }
+    return result;
+}
+
+int main(void)
+{
+    add_test(allocations_are_counted);
+    return run_tests("Allocation accounting");
+}